@@ -0,0 +1,249 @@
+#include <ultracore/log.h>
+#include <ultracore/thread.h>
+#include <ultracore/timeo.h>
+#include <audio/renderer.h>
+#include <audio/mplayer.h>
+
+#include <pthread.h>
+#include <semaphore.h>
+
+#include "clock.h"
+#include "audio_pm.h"
+
+/****************************************************************************
+ *  @def
+ ****************************************************************************/
+#if AUDIO_PM_BREAK_EVEN_MS <= AUDIO_PM_SETTLE_MS + AUDIO_PM_PREPOWER_MS
+    #pragma GCC error "AUDIO_PM_BREAK_EVEN_MS must cover AUDIO_PM_SETTLE_MS + AUDIO_PM_PREPOWER_MS"
+#endif
+
+enum AUDIO_PM_state_t
+{
+    AUDIO_PM_POWERED,
+    AUDIO_PM_KEPT,              // idle, next playback below break-even
+    AUDIO_PM_DOWN_PENDING,
+    AUDIO_PM_DOWN,
+    AUDIO_PM_PREPOWER_PENDING,
+};
+
+struct AUDIO_PM_runtime_t
+{
+    struct timeout_t timeo;
+    enum AUDIO_PM_state_t state;
+
+    // storage is powered by AUDIO_PM thread on timeout / resume, and by callers of idle / busy / sleep
+    pthread_mutex_t lock;
+    sem_t sem;
+    bool volatile resume;
+
+    uint32_t prepower_ms;       // from power down to pre-power, 0 when next playback is unknown
+    struct AUDIO_PM_stat_t stat;
+};
+
+/****************************************************************************
+ *  @internal
+ ****************************************************************************/
+static void AUDIO_PM_timeout_callback(void *arg);
+static __attribute__((noreturn)) void *AUDIO_PM_thread(void *arg);
+static void AUDIO_PM_transition(void);
+
+// var
+__THREAD_STACK static uint32_t audio_pm_stack[AUDIO_PM_STACK_SIZE / sizeof(uint32_t)];
+static struct AUDIO_PM_runtime_t audio_pm;
+
+/****************************************************************************
+ *  @implements
+ ****************************************************************************/
+void AUDIO_PM_init(void)
+{
+    audio_pm.state = AUDIO_PM_POWERED;
+    timeout_init(&audio_pm.timeo, AUDIO_PM_SETTLE_MS, AUDIO_PM_timeout_callback, 0);
+
+    pthread_mutex_init(&audio_pm.lock, NULL);
+    sem_init(&audio_pm.sem, 0, 0);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, audio_pm_stack, sizeof(audio_pm_stack));
+
+    pthread_t id;
+    pthread_create(&id, &attr, AUDIO_PM_thread, &audio_pm);
+    pthread_attr_destroy(&attr);
+}
+
+void AUDIO_PM_idle(void)
+{
+    pthread_mutex_lock(&audio_pm.lock);
+    AUDIO_PM_stream_ctrl(AUDIO_PM_STREAM_NONE);
+
+    if (AUDIO_PM_POWERED != audio_pm.state && AUDIO_PM_KEPT != audio_pm.state &&
+        AUDIO_PM_DOWN_PENDING != audio_pm.state)
+    {
+        goto idle_unlock;
+    }
+
+    int next = CLOCK_next_moment_seconds();
+    uint32_t settle_ms;
+
+    if (-1 == next)
+    {
+        settle_ms = AUDIO_PM_HOLD_MS;
+        audio_pm.prepower_ms = 0;
+    }
+    else if (AUDIO_PM_BREAK_EVEN_MS >= 1000U * (unsigned)next)
+    {
+        // cheaper to stay powered until next playback
+        timeout_stop(&audio_pm.timeo);
+        audio_pm.state = AUDIO_PM_KEPT;
+        audio_pm.stat.kept ++;
+        goto idle_unlock;
+    }
+    else
+    {
+        settle_ms = AUDIO_PM_SETTLE_MS;
+        audio_pm.prepower_ms = 1000U * (unsigned)next - AUDIO_PM_SETTLE_MS - AUDIO_PM_PREPOWER_MS;
+    }
+
+    timeout_stop(&audio_pm.timeo);
+    timeout_update(&audio_pm.timeo, settle_ms);
+
+    audio_pm.state = AUDIO_PM_DOWN_PENDING;
+    timeout_start(&audio_pm.timeo, &audio_pm);
+
+idle_unlock:
+    pthread_mutex_unlock(&audio_pm.lock);
+}
+
+void AUDIO_PM_busy(enum AUDIO_PM_stream_t stream)
+{
+    pthread_mutex_lock(&audio_pm.lock);
+    enum AUDIO_PM_state_t state = audio_pm.state;
+
+    timeout_stop(&audio_pm.timeo);
+    audio_pm.state = AUDIO_PM_POWERED;
+
+    if (AUDIO_PM_DOWN == state || AUDIO_PM_PREPOWER_PENDING == state)
+        audio_pm.stat.late ++;
+
+    // also revalidates storage retained across deep sleep
+    AUDIO_PM_power_ctrl(true);
+    AUDIO_PM_stream_ctrl(stream);
+
+    pthread_mutex_unlock(&audio_pm.lock);
+}
+
+bool AUDIO_PM_sleep(bool retain)
+{
+    // a playback thread is switching storage: leave it as is
+    if (0 != pthread_mutex_trylock(&audio_pm.lock))
+        return true;
+
+    bool powered = AUDIO_PM_DOWN != audio_pm.state && AUDIO_PM_PREPOWER_PENDING != audio_pm.state;
+
+    // retained only when playing, or idle with next playback expected / user interaction held
+    if (powered && retain && AUDIO_PM_POWERED == audio_pm.state)
+        retain = ! mplayer_is_idle() || ! AUDIO_renderer_is_idle();
+
+    if (powered && ! retain)
+    {
+        timeout_stop(&audio_pm.timeo);
+        AUDIO_PM_power_ctrl(false);
+
+        audio_pm.stat.power_down ++;
+        audio_pm.state = AUDIO_PM_DOWN;
+    }
+
+    pthread_mutex_unlock(&audio_pm.lock);
+    return powered && retain;
+}
+
+void AUDIO_PM_resume(void)
+{
+    audio_pm.resume = true;
+    sem_post(&audio_pm.sem);
+}
+
+struct AUDIO_PM_stat_t const *AUDIO_PM_stat(void)
+{
+    return &audio_pm.stat;
+}
+
+/****************************************************************************
+ *  @internal
+ ****************************************************************************/
+static void AUDIO_PM_timeout_callback(void *arg)
+{
+    (void)arg;
+    timeout_stop(&audio_pm.timeo);
+
+    // card init / removal blocks on SDIO: never in timeout context
+    sem_post(&audio_pm.sem);
+}
+
+static __attribute__((noreturn)) void *AUDIO_PM_thread(void *arg)
+{
+    (void)arg;
+
+    while (true)
+    {
+        sem_wait(&audio_pm.sem);
+
+        pthread_mutex_lock(&audio_pm.lock);
+        if (audio_pm.resume)
+        {
+            audio_pm.resume = false;
+
+            // revalidates storage retained across deep sleep, before shell / USB-MSC / playback reach it
+            if (AUDIO_PM_DOWN != audio_pm.state && AUDIO_PM_PREPOWER_PENDING != audio_pm.state)
+                AUDIO_PM_power_ctrl(true);
+        }
+        AUDIO_PM_transition();
+        pthread_mutex_unlock(&audio_pm.lock);
+    }
+}
+
+static void AUDIO_PM_transition(void)
+{
+    // busy() / idle() may have restarted or stopped the timeout since it was posted
+    if (timeout_is_running(&audio_pm.timeo))
+        return;
+
+    switch (audio_pm.state)
+    {
+    case AUDIO_PM_POWERED:
+    case AUDIO_PM_KEPT:
+    case AUDIO_PM_DOWN:
+        break;
+
+    case AUDIO_PM_DOWN_PENDING:
+        // playback was restarted while settling: re-evaluated by next AUDIO_PM_idle()
+        if (! mplayer_is_idle() || ! AUDIO_renderer_is_idle())
+        {
+            audio_pm.state = AUDIO_PM_POWERED;
+            break;
+        }
+
+        AUDIO_PM_power_ctrl(false);
+        audio_pm.stat.power_down ++;
+
+        if (0 == audio_pm.prepower_ms)
+        {
+            audio_pm.state = AUDIO_PM_DOWN;
+        }
+        else
+        {
+            LOG_verbose("audio pm: power down, pre-power in %u ms", (unsigned)audio_pm.prepower_ms);
+
+            audio_pm.state = AUDIO_PM_PREPOWER_PENDING;
+            timeout_update(&audio_pm.timeo, audio_pm.prepower_ms);
+            timeout_start(&audio_pm.timeo, &audio_pm);
+        }
+        break;
+
+    case AUDIO_PM_PREPOWER_PENDING:
+        AUDIO_PM_power_ctrl(true);
+        audio_pm.stat.prepower ++;
+        audio_pm.state = AUDIO_PM_POWERED;
+        break;
+    }
+}
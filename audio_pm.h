@@ -0,0 +1,102 @@
+#ifndef __AUDIO_PM_H
+#define __AUDIO_PM_H                    1
+
+#include <features.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// tune by tools/audio_pm_model.py
+#ifndef AUDIO_PM_BREAK_EVEN_MS
+    #define AUDIO_PM_BREAK_EVEN_MS      (8000)  // gap to next playback worth a power cycle
+#endif
+#ifndef AUDIO_PM_PREPOWER_MS
+    #define AUDIO_PM_PREPOWER_MS        (400)   // SD card init ahead of next playback
+#endif
+#ifndef AUDIO_PM_SETTLE_MS
+    #define AUDIO_PM_SETTLE_MS          (500)   // idle time before power down, covers queued utterances
+#endif
+#ifndef AUDIO_PM_STACK_SIZE
+    #define AUDIO_PM_STACK_SIZE         (1024)  // card init & FAT remount off timeout context
+#endif
+#ifndef AUDIO_PM_HOLD_MS
+    #define AUDIO_PM_HOLD_MS            (30000) // next playback unknown: keep for user interaction
+#endif
+
+    enum AUDIO_PM_stream_t
+    {
+        AUDIO_PM_STREAM_NONE,
+        AUDIO_PM_STREAM_VOICE,          // short prompts
+        AUDIO_PM_STREAM_NOISE,          // long MYNOISE loops
+    };
+
+    struct AUDIO_PM_stat_t
+    {
+        uint32_t power_down;
+        uint32_t prepower;
+        uint32_t late;          // playback found storage powered down
+        uint32_t kept;          // gap below break-even
+    };
+
+__BEGIN_DECLS
+    /**
+     *  AUDIO_PM_init()
+     */
+extern __attribute__((nothrow))
+    void AUDIO_PM_init(void);
+
+    /**
+     *  AUDIO_PM_idle()
+     *      call when playback goes idle: predicts next playback by CLOCK_next_moment_seconds(),
+     *      powers down storage when the gap exceeds AUDIO_PM_BREAK_EVEN_MS
+     *      and powers it up AUDIO_PM_PREPOWER_MS ahead of the next playback
+     *
+     *  AUDIO_PM_busy()
+     *      call before starting playback, cancels pending power down / powers up immediately
+     *      and switches storage profile to stream
+     *
+     *      both are serialized with power transitions of the timeout, which run on AUDIO_PM thread
+     */
+extern __attribute__((nothrow))
+    void AUDIO_PM_idle(void);
+extern __attribute__((nothrow))
+    void AUDIO_PM_busy(enum AUDIO_PM_stream_t stream);
+
+    /**
+     *  AUDIO_PM_sleep()
+     *      call by PMU entering deep sleep: powers down idle storage,
+     *      retain keeps it in standby when playing or inside hold / break-even
+     *  @returns
+     *      true when storage stays powered, must be followed by AUDIO_PM_resume() at wakeup
+     */
+extern __attribute__((nothrow))
+    bool AUDIO_PM_sleep(bool retain);
+
+    /**
+     *  AUDIO_PM_resume()
+     *      call by PMU at wakeup: storage retained by AUDIO_PM_sleep() is revalidated
+     *      on AUDIO_PM thread, ahead of any storage access
+     */
+extern __attribute__((nothrow))
+    void AUDIO_PM_resume(void);
+
+extern __attribute__((nothrow, pure))
+    struct AUDIO_PM_stat_t const *AUDIO_PM_stat(void);
+
+    /**
+     *  AUDIO_PM_power_ctrl()
+     *      implemented by main.cpp: power storage & codec path up / down
+     *      power up is requested by every AUDIO_PM_busy(), it must be cheap when already powered
+     *      called with AUDIO_PM lock held, from thread context only
+     */
+extern __attribute__((nothrow))
+    void AUDIO_PM_power_ctrl(bool en);
+
+    /**
+     *  AUDIO_PM_stream_ctrl()
+     *      implemented by main.cpp: storage read-ahead profile of stream, AUDIO_PM_STREAM_NONE when idle
+     */
+extern __attribute__((nothrow))
+    void AUDIO_PM_stream_ctrl(enum AUDIO_PM_stream_t stream);
+
+__END_DECLS
+#endif
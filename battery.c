@@ -0,0 +1,169 @@
+#include <string.h>
+
+#include "battery.h"
+
+/****************************************************************************
+ *  @implements
+ ****************************************************************************/
+void BATT_monitor_init(struct BATT_monitor_t *mon, uint16_t low_mv, uint32_t max_intv)
+{
+    memset(mon, 0, sizeof(*mon));
+
+    mon->low_mv = low_mv;
+    mon->max_intv = BATT_SAMPLE_MIN_SECONDS > max_intv ? BATT_SAMPLE_MIN_SECONDS : max_intv;
+    mon->sag_mv = BATT_PLAYBACK_SAG_MV;
+}
+
+bool BATT_monitor_schedule(struct BATT_monitor_t *mon, time_t ts)
+{
+    if ((0 != mon->count || mon->pending) && ts < mon->next_ts)
+        return false;
+
+    mon->pending = true;
+    mon->next_ts = ts + BATT_SAMPLE_MIN_SECONDS;
+    return true;
+}
+
+void BATT_monitor_sample(struct BATT_monitor_t *mon, int mv, bool playing, time_t ts)
+{
+    mon->pending = false;
+
+    // learn playback sag: playing sample against idle value extrapolated by discharge slope
+    if (playing && 0 != mon->count && BATT_SAG_LEARN_SECONDS >= ts - mon->idle_ts)
+    {
+        int expected = BATT_monitor_mv(mon) - (int)(mon->slope_mv_per_hour * (ts - mon->idle_ts) / 3600);
+        int sag = expected - mv;
+
+        if (0 < sag)
+        {
+            if (BATT_SAG_MAX_MV < sag)
+                sag = BATT_SAG_MAX_MV;
+            mon->sag_mv = (int16_t)(mon->sag_mv + (sag - mon->sag_mv) / 4);
+        }
+    }
+    if (! playing)
+        mon->idle_ts = ts;
+
+    int compensated = playing ? mv + mon->sag_mv : mv;
+
+    if (0 == mon->count)
+    {
+        mon->filtered_q4 = compensated << 4;
+
+        mon->slope_ref_mv = (int16_t)compensated;
+        mon->slope_ref_ts = ts;
+    }
+    else
+        mon->filtered_q4 += ((compensated << 4) - mon->filtered_q4) >> BATT_EWMA_SHIFT;
+
+    if (UINT16_MAX > mon->count)
+        mon->count ++;
+
+    int filtered = BATT_monitor_mv(mon);
+
+    if (BATT_SLOPE_WINDOW_SECONDS <= ts - mon->slope_ref_ts)
+    {
+        mon->slope_mv_per_hour = (int16_t)((mon->slope_ref_mv - filtered) * 3600 / (ts - mon->slope_ref_ts));
+        mon->slope_ref_mv = (int16_t)filtered;
+        mon->slope_ref_ts = ts;
+    }
+
+    // next sample when the expected drop reaches BATT_SAMPLE_STEP_MV
+    time_t intv;
+
+    if (mon->low_mv > filtered)
+        intv = BATT_SAMPLE_MIN_SECONDS;
+    else if (0 >= mon->slope_mv_per_hour)
+        intv = (time_t)mon->max_intv;
+    else
+    {
+        intv = BATT_SAMPLE_STEP_MV * 3600 / mon->slope_mv_per_hour;
+
+        if (BATT_SAMPLE_MIN_SECONDS > intv)
+            intv = BATT_SAMPLE_MIN_SECONDS;
+        if ((time_t)mon->max_intv < intv)
+            intv = (time_t)mon->max_intv;
+    }
+    mon->next_ts = ts + intv;
+}
+
+void BATT_estimator_init(struct BATT_estimator_t *est, uint32_t capacity_mah,
+    struct BATT_load_model_t const *model)
+{
+    memset(est, 0, sizeof(*est));
+
+    est->capacity_uah = (int32_t)(capacity_mah * 1000);
+    est->charge_uah = est->capacity_uah;
+    est->model = *model;
+    est->load_ua = model->idle_ua;
+    est->avg_ua = model->idle_ua;
+}
+
+bool BATT_estimator_load(struct BATT_estimator_t *est, unsigned loads, uint8_t led_percent, time_t ts)
+{
+    if (0 != est->ts && ts > est->ts)
+    {
+        int64_t dt = ts - est->ts;
+
+        est->charge_uah -= (int32_t)((int64_t)est->load_ua * dt / 3600);
+        if (0 > est->charge_uah)
+            est->charge_uah = 0;
+
+        // time weighted average: converges by BATT_EST_AVG_SECONDS regardless of call rate
+        est->avg_ua = (uint32_t)((int64_t)est->avg_ua +
+            ((int64_t)est->load_ua - est->avg_ua) * dt / (dt + BATT_EST_AVG_SECONDS));
+    }
+    est->ts = ts;
+
+    if (! (BATT_LOAD_LED & loads))
+        led_percent = 0;
+    if (est->loads == loads && est->led_percent == led_percent)
+        return false;
+
+    uint32_t ua = est->model.idle_ua;
+    if (BATT_LOAD_VOICE & loads)
+        ua += est->model.voice_ua;
+    if (BATT_LOAD_NOISE & loads)
+        ua += est->model.noise_ua;
+    if (BATT_LOAD_LED & loads)
+        ua += est->model.led_full_ua * led_percent / 100;
+    if (BATT_LOAD_BLE & loads)
+        ua += est->model.ble_ua;
+
+    est->loads = (uint8_t)loads;
+    est->led_percent = led_percent;
+    est->load_ua = ua;
+    return true;
+}
+
+void BATT_estimator_voltage(struct BATT_estimator_t *est, uint8_t level)
+{
+    if (100 < level)
+        level = 100;
+
+    int32_t charge = (int32_t)((int64_t)est->capacity_uah * level / 100);
+
+    if (! est->anchored)
+    {
+        est->charge_uah = charge;
+        est->anchored = true;
+    }
+    else
+        est->charge_uah += (charge - est->charge_uah) >> BATT_EST_VOLT_SHIFT;
+}
+
+uint8_t BATT_estimator_level(struct BATT_estimator_t const *est)
+{
+    if (0 >= est->capacity_uah)
+        return 0;
+    else
+        return (uint8_t)((int64_t)est->charge_uah * 100 / est->capacity_uah);
+}
+
+uint32_t BATT_estimator_minutes(struct BATT_estimator_t const *est)
+{
+    if (0 == est->avg_ua)
+        return 0;
+    else
+        return (uint32_t)((int64_t)est->charge_uah * 60 / est->avg_ua);
+}
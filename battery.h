@@ -0,0 +1,198 @@
+#ifndef __BATTERY_H
+#define __BATTERY_H                     1
+
+#include <features.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifndef BATT_EWMA_SHIFT
+    #define BATT_EWMA_SHIFT             (2)     // alpha = 1/4
+#endif
+
+#ifndef BATT_PLAYBACK_SAG_MV
+    #define BATT_PLAYBACK_SAG_MV        (60)    // initial sag estimate while audio is playing
+#endif
+#ifndef BATT_SAG_MAX_MV
+    #define BATT_SAG_MAX_MV             (400)
+#endif
+#ifndef BATT_SAG_LEARN_SECONDS
+    #define BATT_SAG_LEARN_SECONDS      (1800)  // max distance to the last idle sample
+#endif
+
+#ifndef BATT_SAMPLE_MIN_SECONDS
+    #define BATT_SAMPLE_MIN_SECONDS     (60)
+#endif
+#ifndef BATT_SAMPLE_STEP_MV
+    #define BATT_SAMPLE_STEP_MV         (10)    // resample when the expected drop reaches
+#endif
+#ifndef BATT_SLOPE_WINDOW_SECONDS
+    #define BATT_SLOPE_WINDOW_SECONDS   (1800)
+#endif
+
+/**
+ *  board values: PERIPHERAL_config.h is included before this by smartcuckoo.h,
+ *  battery.c gets them only by BATT_monitor_init() / BATT_estimator_init()
+ */
+#ifndef BATT_SAMPLE_MAX_SECONDS
+    #ifdef BATT_AD_INTV_SECONDS
+        #define BATT_SAMPLE_MAX_SECONDS BATT_AD_INTV_SECONDS
+    #else
+        #define BATT_SAMPLE_MAX_SECONDS (3600)
+    #endif
+#endif
+
+// runtime estimator: modeled load currents, calibrate by tools/batt_fit.py
+#ifndef BATT_CAPACITY_MAH
+    #define BATT_CAPACITY_MAH           (2000)
+#endif
+#ifndef BATT_IDLE_UA
+    #define BATT_IDLE_UA                (1500)
+#endif
+#ifndef BATT_VOICE_UA
+    #define BATT_VOICE_UA               (60000)
+#endif
+#ifndef BATT_NOISE_UA
+    #define BATT_NOISE_UA               (45000) // SD streaming + amplifier
+#endif
+#ifndef BATT_LED_FULL_UA
+    #define BATT_LED_FULL_UA            (120000)// LED at 100%, scaled by brightness
+#endif
+#ifndef BATT_BLE_UA
+    #define BATT_BLE_UA                 (3000)  // connected
+#endif
+#define BATT_LOAD_MODEL_INITIALIZER     \
+    {.idle_ua = BATT_IDLE_UA, .voice_ua = BATT_VOICE_UA, .noise_ua = BATT_NOISE_UA, \
+        .led_full_ua = BATT_LED_FULL_UA, .ble_ua = BATT_BLE_UA}
+
+#ifndef BATT_EST_AVG_SECONDS
+    #define BATT_EST_AVG_SECONDS        (24 * 3600) // covers a daily usage cycle
+#endif
+#ifndef BATT_EST_VOLT_SHIFT
+    #define BATT_EST_VOLT_SHIFT         (3)     // voltage correction weight = 1/8 per sample
+#endif
+
+    enum BATT_load_t
+    {
+        BATT_LOAD_VOICE         = 0x01,
+        BATT_LOAD_NOISE         = 0x02,
+        BATT_LOAD_LED           = 0x04,
+        BATT_LOAD_BLE           = 0x08,
+    };
+
+    struct BATT_load_model_t
+    {
+        uint32_t idle_ua;
+        uint32_t voice_ua;
+        uint32_t noise_ua;
+        uint32_t led_full_ua;       // LED at 100%, scaled by brightness
+        uint32_t ble_ua;
+    };
+
+    struct BATT_monitor_t
+    {
+        uint16_t low_mv;
+        uint16_t count;
+        bool pending;
+        uint32_t max_intv;          // seconds
+
+        int32_t filtered_q4;        // idle equivalent mV << 4
+        int16_t sag_mv;
+        time_t idle_ts;             // last sample without playback
+
+        int16_t slope_ref_mv;
+        int16_t slope_mv_per_hour;  // positive when discharging
+        time_t slope_ref_ts;
+
+        time_t next_ts;
+    };
+
+    struct BATT_estimator_t
+    {
+        int32_t capacity_uah;
+        int32_t charge_uah;         // remaining
+        bool anchored;              // charge was seeded by voltage
+        struct BATT_load_model_t model;
+
+        uint8_t loads;
+        uint8_t led_percent;
+        uint32_t load_ua;           // modeled current of loads
+        uint32_t avg_ua;            // long term average, the predictor
+        time_t ts;
+    };
+
+__BEGIN_DECLS
+    /**
+     *  BATT_monitor_init()
+     *      sampling is kept at BATT_SAMPLE_MIN_SECONDS below low_mv, and at most every max_intv seconds
+     */
+extern __attribute__((nothrow, nonnull))
+    void BATT_monitor_init(struct BATT_monitor_t *mon, uint16_t low_mv, uint32_t max_intv);
+
+    /**
+     *  BATT_monitor_schedule()
+     *      true when a conversion should be started now, conversion is marked pending until sampled,
+     *      a lost conversion is retried after BATT_SAMPLE_MIN_SECONDS
+     */
+extern __attribute__((nothrow, nonnull))
+    bool BATT_monitor_schedule(struct BATT_monitor_t *mon, time_t ts);
+
+    /**
+     *  BATT_monitor_sample()
+     *      feed averaged conversion mV, playing: audio was playing while converting
+     *      updates filter, playback sag estimation, discharge slope & next sampling time
+     */
+extern __attribute__((nothrow, nonnull))
+    void BATT_monitor_sample(struct BATT_monitor_t *mon, int mv, bool playing, time_t ts);
+
+    /**
+     *  BATT_monitor_mv()
+     *      filtered idle equivalent mV, 0 before any sample
+     */
+static inline
+    uint16_t BATT_monitor_mv(struct BATT_monitor_t const *mon)
+    {
+        return (uint16_t)(mon->filtered_q4 >> 4);
+    }
+
+    /**
+     *  BATT_estimator_init()
+     *      model: load currents of the board, BATT_LOAD_MODEL_INITIALIZER
+     */
+extern __attribute__((nothrow, nonnull))
+    void BATT_estimator_init(struct BATT_estimator_t *est, uint32_t capacity_mah,
+        struct BATT_load_model_t const *model);
+
+    /**
+     *  BATT_estimator_load()
+     *      integrate charge drawn by previous loads until ts, then switch to loads
+     *      led_percent: brightness 0~100 for BATT_LOAD_LED
+     *
+     *  @returns
+     *      true when loads or led_percent changed
+     */
+extern __attribute__((nothrow, nonnull))
+    bool BATT_estimator_load(struct BATT_estimator_t *est, unsigned loads, uint8_t led_percent, time_t ts);
+
+    /**
+     *  BATT_estimator_voltage()
+     *      correct integrated charge toward level (0~100) of the voltage curve,
+     *      first call seeds the charge, voltage should be sag compensated
+     */
+extern __attribute__((nothrow, nonnull))
+    void BATT_estimator_voltage(struct BATT_estimator_t *est, uint8_t level);
+
+    /**
+     *  BATT_estimator_level()
+     *      remaining 0~100%
+     *
+     *  BATT_estimator_minutes()
+     *      predicted runtime by the long term average load
+     */
+extern __attribute__((nothrow, nonnull, pure))
+    uint8_t BATT_estimator_level(struct BATT_estimator_t const *est);
+extern __attribute__((nothrow, nonnull, pure))
+    uint32_t BATT_estimator_minutes(struct BATT_estimator_t const *est);
+
+__END_DECLS
+#endif
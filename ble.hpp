@@ -2,11 +2,44 @@
 #define __BLE_HPP                       1
 
 #include "smartcuckoo.h"
+#include "power.h"
+
+#include <ctype.h>
+#include <pthread.h>
+#include <string.h>
+#include <ultracore/timeo.h>
 
 #include <bluetooth/gap.tlv.hpp>
 #include <bluetooth/gatt.service.serialp.hpp>
 #include "nations.bluetooth.hpp"
 
+#ifndef SHELL_ENV_POOL_SIZE
+    #define SHELL_ENV_POOL_SIZE         (2)
+#endif
+
+// as the UART shell running the same commands, "heap" reports the deepest use of it
+#ifndef SHELL_STACK_SIZE
+    #define SHELL_STACK_SIZE            (2048)
+#endif
+
+#define SHELL_STACK_FILL                (0xA5A5A5A5UL)
+
+#ifndef NOTIFICATION_INTV
+    #define NOTIFICATION_INTV           (100)
+#endif
+
+#ifndef NOTIFICATION_QUEUE_SIZE
+    #define NOTIFICATION_QUEUE_SIZE     (8)
+#endif
+
+#ifndef NOTIFICATION_ENTRY_SIZE
+    #define NOTIFICATION_ENTRY_SIZE     (48)
+#endif
+
+#ifndef NOTIFICATION_FRAME_SIZE
+    #define NOTIFICATION_FRAME_SIZE     (160)
+#endif
+
     class TUltraCorePeripheral :public Bluetooth::Nations::TPeripheral
     {
         typedef Bluetooth::Nations::TPeripheral inherited;
@@ -15,11 +48,26 @@
         TUltraCorePeripheral() :
             inherited(PROJECT_NAME),
             Shell(),
-            FNotificationEn(true)
+            FNotificationEn(true),
+            FShellPool(),
+            FShellPoolPeak(0),
+            FShellPoolRejected(0),
+            FNotificationCount(0),
+            FNotificationWriting(0)
         {
             #ifdef NDEBUG
                 Connections.SetInactiveTimeout(15000);
             #endif
+
+            // painted once: the high water mark is kept over all sessions
+            for (unsigned idx = 0; idx < SHELL_ENV_POOL_SIZE; idx ++)
+            {
+                for (unsigned i = 0; i < SHELL_STACK_SIZE / sizeof(uint32_t); i ++)
+                    FShellPool[idx].Stack[i] = SHELL_STACK_FILL;
+            }
+
+            pthread_mutex_init(&FNotificationLock, NULL);
+            timeout_init(&FNotificationTimeo, NOTIFICATION_INTV, NotificationTimeoCallback, 0);
         }
 
         virtual void GAP_OnReady(void) override
@@ -31,12 +79,17 @@
         virtual void CLI_OnConnected(uint16_t peer_id, void *arg) override
         {
             inherited::CLI_OnConnected(peer_id, arg);
+            PERIPHERAL_batt_load(BATT_LOAD_BLE, true);
+            POWER_track(POWER_CAUSE_BLE, true);
             PERIPHERAL_on_connected();
         }
 
         virtual void CLI_OnDisconnect(uint16_t peer_id, void *arg) override
         {
             inherited::CLI_OnDisconnect(peer_id, arg);
+            NotificationClear();
+            PERIPHERAL_batt_load(BATT_LOAD_BLE, false);
+            POWER_track(POWER_CAUSE_BLE, false);
             PERIPHERAL_on_disconnect();
             ADV_Start();
         }
@@ -45,11 +98,37 @@
         {
             if (Char == &Shell.Char)
             {
-                struct UCSH_env *env = (struct UCSH_env *)malloc(sizeof(struct UCSH_env) + 4096);
+                int fd = Shell.CreateVFd();
+                TShellSlot *slot = NULL;
+
+                for (unsigned idx = 0; idx < SHELL_ENV_POOL_SIZE; idx ++)
+                {
+                    if (! __atomic_test_and_set(&FShellPool[idx].Used, __ATOMIC_ACQUIRE))
+                    {
+                        slot = &FShellPool[idx];
+                        break;
+                    }
+                }
 
-                UCSH_init_instance(env, Shell.CreateVFd(), 4096, (uint32_t *)(env + 1));
-                UCSH_set_destructor(env, UCSH_destruct);
-                LOG_debug("BLE: creating shell 0x%08x", env);
+                if (slot)
+                {
+                    unsigned used = ShellPoolUsed();
+                    if (used > FShellPoolPeak)
+                        FShellPoolPeak = (uint8_t)used;
+
+                    UCSH_init_instance(&slot->Env, fd, SHELL_STACK_SIZE, slot->Stack);
+                    UCSH_set_destructor(&slot->Env, UCSH_destruct);
+                    LOG_debug("BLE: creating shell 0x%08x", &slot->Env);
+                }
+                else
+                {
+                    char buf[16];
+                    FShellPoolRejected ++;
+
+                    write(fd, buf, (size_t)sprintf(buf, "%d: busy\n", EBUSY));
+                    close(fd);
+                    LOG_info("BLE: shell pool exhausted");
+                }
             }
         }
 
@@ -71,7 +150,7 @@
         {
             ADV_WriteManufacturerData(scanrsp,
                 FBDAddr, PROJECT_ID, PROJECT_VERSION,
-                BATT_mv_level(PERIPHERAL_batt_volt()),
+                PERIPHERAL_batt_level(),
                 PERIPHERAL_sync_id()
             );
 
@@ -87,24 +166,262 @@
         void DisbleNotification(void)
         {
             FNotificationEn = false;
+            NotificationClear();
         }
 
+        /**
+         *  Notification()
+         *      a queued entry of the same field is replaced (last value wins): the same key before ':' and
+         *      the same text but the numbers, "volume: 30" / "noise: off_seconds=600".
+         *      events as "alarm: on" / "alarm: off" are kept in order
+         *
+         *      queue is flushed as one frame per NOTIFICATION_INTV, a frame not accepted by the serial port
+         *      stays queued and is retried. when full the oldest field entry not being written is dropped,
+         *      pieces of a long message are never dropped: the new message is dropped as a whole instead
+         */
         void Notification(char const *str, size_t strlen)
         {
-            if (FNotificationEn)
-                Shell.WriteBuf(str, strlen);
+            if (! FNotificationEn)
+                return;
+
+            pthread_mutex_lock(&FNotificationLock);
+
+            if (NOTIFICATION_ENTRY_SIZE < strlen)
+            {
+                // too long for an entry: queued in pieces, reassembled by frames in order
+                if (NotificationReserve((unsigned)((strlen + NOTIFICATION_ENTRY_SIZE - 1) / NOTIFICATION_ENTRY_SIZE)))
+                {
+                    while (0 != strlen)
+                    {
+                        size_t len = MIN(strlen, (size_t)NOTIFICATION_ENTRY_SIZE);
+
+                        NotificationQueue(str, len, false);
+                        str += len;
+                        strlen -= len;
+                    }
+                }
+            }
+            else
+                NotificationQueue(str, strlen, true);
+
+            if (! timeout_is_running(&FNotificationTimeo))
+                timeout_start(&FNotificationTimeo, this);
+
+            pthread_mutex_unlock(&FNotificationLock);
+        }
+        unsigned ShellPoolUsed(void)
+        {
+            unsigned used = 0;
+
+            for (unsigned idx = 0; idx < SHELL_ENV_POOL_SIZE; idx ++)
+            {
+                if (__atomic_load_n(&FShellPool[idx].Used, __ATOMIC_RELAXED))
+                    used ++;
+            }
+            return used;
+        }
+
+        unsigned ShellPoolPeak(void) { return FShellPoolPeak; }
+        unsigned ShellPoolRejected(void) { return FShellPoolRejected; }
+
+        // stacks grow down: the painted words left at the bottom were never used
+        unsigned ShellStackPeak(void)
+        {
+            unsigned peak = 0;
+
+            for (unsigned idx = 0; idx < SHELL_ENV_POOL_SIZE; idx ++)
+            {
+                unsigned i = 0;
+
+                while (i < SHELL_STACK_SIZE / sizeof(uint32_t) && SHELL_STACK_FILL == FShellPool[idx].Stack[i])
+                    i ++;
+
+                peak = MAX(peak, (unsigned)(SHELL_STACK_SIZE - i * sizeof(uint32_t)));
+            }
+            return peak;
         }
 
         Bluetooth::TSerialPortService Shell;
 
     private:
+        struct TShellSlot
+        {
+            struct UCSH_env Env;        // first member: destructor maps env back to slot
+            uint32_t Stack[SHELL_STACK_SIZE / sizeof(uint32_t)] __attribute__((aligned(8)));
+            bool Used;
+        };
+
+        struct TNotificationEntry
+        {
+            uint8_t Len;
+            bool Field;                 // replaced by the same field
+            char Buf[NOTIFICATION_ENTRY_SIZE];
+        };
+
+        // same key before ':', the value the same text but runs of digits
+        static bool NotificationSameField(TNotificationEntry const *entry, char const *str, size_t strlen)
+        {
+            char const *key = (char const *)memchr(str, ':', strlen);
+            size_t i, j;
+
+            if (! key)
+                return entry->Len == strlen && 0 == memcmp(entry->Buf, str, strlen);
+
+            i = j = (size_t)(key - str) + 1;
+            if (entry->Len < i || 0 != memcmp(entry->Buf, str, i))
+                return false;
+
+            while (i < entry->Len && j < strlen)
+            {
+                if (isdigit((unsigned char)entry->Buf[i]) && isdigit((unsigned char)str[j]))
+                {
+                    while (i < entry->Len && isdigit((unsigned char)entry->Buf[i]))
+                        i ++;
+                    while (j < strlen && isdigit((unsigned char)str[j]))
+                        j ++;
+                }
+                else if (entry->Buf[i ++] != str[j ++])
+                    return false;
+            }
+            return i == entry->Len && j == strlen;
+        }
+
+        // NOTE: FNotificationLock is locked
+        void NotificationQueue(char const *str, size_t strlen, bool field)
+        {
+            unsigned idx = FNotificationCount;
+
+            // entries being written are not touched
+            if (field)
+            {
+                for (idx = FNotificationWriting; idx < FNotificationCount; idx ++)
+                {
+                    if (FNotificationQueue[idx].Field && NotificationSameField(&FNotificationQueue[idx], str, strlen))
+                        break;
+                }
+            }
+
+            if (idx == FNotificationCount)
+            {
+                // pieces of long messages are reserved as a whole by Notification()
+                if (field && ! NotificationReserve(1))
+                    return;
+
+                FNotificationCount ++;
+            }
+
+            memcpy(FNotificationQueue[idx].Buf, str, strlen);
+            FNotificationQueue[idx].Len = (uint8_t)strlen;
+            FNotificationQueue[idx].Field = field;
+        }
+
+        // NOTE: FNotificationLock is locked
+        bool NotificationReserve(unsigned count)
+        {
+            unsigned droppable = 0;
+
+            // only field entries not being written are dropped, pieces of a long message are never
+            for (unsigned idx = FNotificationWriting; idx < FNotificationCount; idx ++)
+            {
+                if (FNotificationQueue[idx].Field)
+                    droppable ++;
+            }
+            if (NOTIFICATION_QUEUE_SIZE - FNotificationCount + droppable < count)
+            {
+                LOG_info("BLE: notification queue full, dropped");
+                return false;
+            }
+
+            // oldest first
+            for (unsigned idx = FNotificationWriting; NOTIFICATION_QUEUE_SIZE - FNotificationCount < count;)
+            {
+                if (FNotificationQueue[idx].Field)
+                {
+                    FNotificationCount --;
+                    memmove(&FNotificationQueue[idx], &FNotificationQueue[idx + 1],
+                        (size_t)(FNotificationCount - idx) * sizeof(TNotificationEntry));
+                }
+                else
+                    idx ++;
+            }
+            return true;
+        }
+
         static void UCSH_destruct(struct UCSH_env *env)
         {
-            free(env);
+            __atomic_clear(&((TShellSlot *)env)->Used, __ATOMIC_RELEASE);
             LOG_debug("BLE: shell destruct");
         }
 
+        static void NotificationTimeoCallback(void *arg)
+        {
+            TUltraCorePeripheral *self = (TUltraCorePeripheral *)arg;
+
+            self->NotificationFlush();
+
+            if (0 != self->FNotificationCount)
+                timeout_start(&self->FNotificationTimeo, self);
+        }
+
+        void NotificationFlush(void)
+        {
+            char frame[NOTIFICATION_FRAME_SIZE];
+            size_t len = 0;
+
+            pthread_mutex_lock(&FNotificationLock);
+            {
+                unsigned idx = 0;
+
+                while (idx < FNotificationCount && len + FNotificationQueue[idx].Len <= sizeof(frame))
+                {
+                    memcpy(&frame[len], FNotificationQueue[idx].Buf, FNotificationQueue[idx].Len);
+                    len += FNotificationQueue[idx].Len;
+                    idx ++;
+                }
+                // entries are removed only when the frame was accepted
+                FNotificationWriting = (uint8_t)idx;
+            }
+            pthread_mutex_unlock(&FNotificationLock);
+
+            if (0 == len || ! FNotificationEn)
+                return;
+
+            // serial port busy / congested: frame is retried by the next NOTIFICATION_INTV
+            bool accepted = (ssize_t)len == Shell.WriteBuf(frame, len);
+
+            pthread_mutex_lock(&FNotificationLock);
+            {
+                if (accepted && FNotificationWriting <= FNotificationCount)
+                {
+                    FNotificationCount = (uint8_t)(FNotificationCount - FNotificationWriting);
+                    memmove(&FNotificationQueue[0], &FNotificationQueue[FNotificationWriting],
+                        FNotificationCount * sizeof(TNotificationEntry));
+                }
+                FNotificationWriting = 0;
+            }
+            pthread_mutex_unlock(&FNotificationLock);
+        }
+
+        void NotificationClear(void)
+        {
+            pthread_mutex_lock(&FNotificationLock);
+            FNotificationCount = 0;
+            FNotificationWriting = 0;
+            timeout_stop(&FNotificationTimeo);
+            pthread_mutex_unlock(&FNotificationLock);
+        }
+
         bool FNotificationEn;
+
+        TShellSlot FShellPool[SHELL_ENV_POOL_SIZE];
+        uint8_t FShellPoolPeak;
+        uint16_t FShellPoolRejected;
+
+        pthread_mutex_t FNotificationLock;
+        timeout_t FNotificationTimeo;
+        uint8_t FNotificationCount;
+        uint8_t FNotificationWriting;
+        TNotificationEntry FNotificationQueue[NOTIFICATION_QUEUE_SIZE];
     };
 
     // cpp => c
@@ -0,0 +1,153 @@
+#include <string.h>
+#include <ultracore/mq.h>
+
+#include "button.h"
+
+/****************************************************************************
+ *  @private
+ ****************************************************************************/
+static void BUTTON_scan_callback(struct BUTTON_engine_t *engine);
+
+/****************************************************************************
+ *  @implements
+ ****************************************************************************/
+void BUTTON_engine_init(struct BUTTON_engine_t *engine, int mqd,
+    struct BUTTON_t const *buttons, uint8_t count, uint32_t scan_intv,
+    BUTTON_scan_t scan, BUTTON_idle_t idle, void *arg)
+{
+    memset(engine, 0, sizeof(*engine));
+
+    engine->mqd = mqd;
+    engine->buttons = buttons;
+    engine->count = BUTTON_MAX_COUNT > count ? count : BUTTON_MAX_COUNT;
+    engine->scan = scan;
+    engine->idle = idle;
+    engine->arg = arg;
+    engine->scan_intv = scan_intv;
+
+    timeout_init(&engine->scan_timeo, scan_intv, (void *)BUTTON_scan_callback, 0);
+}
+
+void BUTTON_trigger(struct BUTTON_engine_t *engine)
+{
+    if (engine->scan)
+    {
+        if (! engine->edge)
+        {
+            engine->edge_ts = clock();
+            engine->edge = true;
+        }
+
+        timeout_stop(&engine->scan_timeo);
+        timeout_update(&engine->scan_timeo, engine->scan_intv);
+        timeout_start(&engine->scan_timeo, engine);
+    }
+}
+
+bool BUTTON_scan_update(struct BUTTON_engine_t *engine, uint32_t mask)
+{
+    clock_t now = clock();
+    // press time is the first edge of debounce
+    clock_t pressed = engine->edge ? engine->edge_ts : now;
+    engine->edge = false;
+
+    for (unsigned idx = 0; idx < engine->count; idx ++)
+    {
+        struct BUTTON_t const *button = &engine->buttons[idx];
+        uint32_t bit = 1UL << idx;
+
+        if (bit & mask)
+        {
+            if (0 == (bit & engine->state))
+            {
+                engine->state |= bit;
+                engine->long_pressed &= ~bit;
+
+                if (0 != button->long_press)
+                {
+                    engine->timed |= bit;
+                    engine->deadline[idx] = pressed + button->long_press;
+                }
+
+                mqueue_postv(engine->mqd, BUTTON_MSGID(BUTTON_PRESS, button->id), 0, 0);
+            }
+            else if ((bit & engine->timed) && 0 <= (int)(now - engine->deadline[idx]))
+            {
+                if (0 == (bit & engine->long_pressed))
+                {
+                    engine->long_pressed |= bit;
+                    mqueue_postv(engine->mqd, BUTTON_MSGID(BUTTON_LONG_PRESS, button->id), 0, 0);
+                }
+                else if (0 != button->repeat_intv)
+                    mqueue_postv(engine->mqd, BUTTON_MSGID(BUTTON_REPEAT, button->id), 0, 0);
+
+                if (0 != button->repeat_intv)
+                    engine->deadline[idx] = now + button->repeat_intv;
+                else    // no more deadline until released
+                    engine->timed &= ~bit;
+            }
+        }
+        else if (bit & engine->state)
+        {
+            engine->state &= ~bit;
+            engine->timed &= ~bit;
+
+            if (bit & engine->long_pressed)
+                mqueue_postv(engine->mqd, BUTTON_MSGID(BUTTON_LONG_RELEASE, button->id), 0, 0);
+            else
+                mqueue_postv(engine->mqd, BUTTON_MSGID(BUTTON_RELEASE, button->id), 0, 0);
+        }
+    }
+
+    return 0 != engine->state;
+}
+
+int32_t BUTTON_next_deadline(struct BUTTON_engine_t const *engine)
+{
+    clock_t now = clock();
+    int32_t next = -1;
+
+    for (unsigned idx = 0; idx < engine->count; idx ++)
+    {
+        if ((1UL << idx) & engine->timed)
+        {
+            int32_t ms = (int32_t)(engine->deadline[idx] - now);
+
+            if (0 > ms)
+                ms = 0;
+            if (0 > next || ms < next)
+                next = ms;
+        }
+    }
+    return next;
+}
+
+bool BUTTON_is_down(struct BUTTON_engine_t const *engine, uint8_t id)
+{
+    for (unsigned idx = 0; idx < engine->count; idx ++)
+    {
+        if (id == engine->buttons[idx].id)
+            return 0 != ((1UL << idx) & engine->state);
+    }
+    return false;
+}
+
+/****************************************************************************
+ *  @private
+ ****************************************************************************/
+static void BUTTON_scan_callback(struct BUTTON_engine_t *engine)
+{
+    if (BUTTON_scan_update(engine, engine->scan(engine->arg)))
+    {
+        // release is an edge, only LONG_PRESS / REPEAT need the timer: one shot at the earliest of them
+        int32_t next = BUTTON_next_deadline(engine);
+
+        if (0 <= next)
+        {
+            timeout_update(&engine->scan_timeo, 0 == next ? 1 : (uint32_t)next);
+            timeout_start(&engine->scan_timeo, engine);
+        }
+    }
+    else if (engine->idle)
+        engine->idle(engine->arg);
+}
@@ -0,0 +1,119 @@
+#ifndef __BUTTON_H
+#define __BUTTON_H                      1
+
+#include <features.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <ultracore/timeo.h>
+
+#ifndef BUTTON_SCAN_INTV
+    #define BUTTON_SCAN_INTV            (20)
+#endif
+
+    #define BUTTON_MAX_COUNT            (32)
+
+    enum BUTTON_event_t
+    {
+        BUTTON_PRESS                = 1,
+        BUTTON_LONG_PRESS,
+        BUTTON_REPEAT,
+        BUTTON_RELEASE,             // released before long press
+        BUTTON_LONG_RELEASE,        // released after long press
+    };
+
+    /**
+     *  events are posted as message id: event << 8 | button id
+     */
+    #define BUTTON_MSGID(event, id)     ((unsigned)(event) << 8 | (uint8_t)(id))
+    #define BUTTON_MSG_EVENT(msgid)     ((enum BUTTON_event_t)((unsigned)(msgid) >> 8))
+    #define BUTTON_MSG_ID(msgid)        ((uint8_t)(msgid))
+
+    struct BUTTON_t
+    {
+        uint8_t id;
+        uint16_t long_press;        // ms, 0 for no LONG_PRESS
+        uint16_t repeat_intv;       // ms after LONG_PRESS, 0 for no REPEAT
+    };
+
+    /**
+     *  scan callback: returns bitmask of pressed buttons, bit n => buttons[n]
+     *  idle callback: all buttons released, no more scan until next BUTTON_trigger()
+     */
+    typedef uint32_t (* BUTTON_scan_t)(void *arg);
+    typedef void (* BUTTON_idle_t)(void *arg);
+
+    struct BUTTON_engine_t
+    {
+        int mqd;
+        struct BUTTON_t const *buttons;
+        uint8_t count;
+
+        BUTTON_scan_t scan;
+        BUTTON_idle_t idle;
+        void *arg;
+
+        timeout_t scan_timeo;
+        uint32_t scan_intv;
+
+        bool edge;
+        clock_t edge_ts;
+
+        uint32_t state;
+        uint32_t long_pressed;
+        uint32_t timed;             // buttons with a LONG_PRESS / REPEAT deadline pending
+        clock_t deadline[BUTTON_MAX_COUNT];
+    };
+
+__BEGIN_DECLS
+    /**
+     *  BUTTON_engine_init()
+     *      scan_intv is debounce time after an edge, buttons are sampled only by edges and by the earliest
+     *      LONG_PRESS / REPEAT deadline of held buttons: GPIO interrupts must be of both edges
+     *      the engine timer is stopped when all buttons are released
+     *      scan can be NULL when product runs its own scanner and feeds BUTTON_scan_update()
+     */
+extern __attribute__((nothrow, nonnull(1, 3)))
+    void BUTTON_engine_init(struct BUTTON_engine_t *engine, int mqd,
+        struct BUTTON_t const *buttons, uint8_t count, uint32_t scan_intv,
+        BUTTON_scan_t scan, BUTTON_idle_t idle, void *arg);
+
+    /**
+     *  BUTTON_trigger()
+     *      call from GPIO interrupt of any edge, (re)start debounce
+     *      the edge time is taken as time of press
+     */
+extern __attribute__((nothrow, nonnull))
+    void BUTTON_trigger(struct BUTTON_engine_t *engine);
+
+    /**
+     *  BUTTON_scan_update()
+     *      feed debounced button mask, post PRESS / LONG_PRESS / REPEAT / RELEASE events
+     *      this is called by engine timer, products scanning by their own can feed it directly
+     *
+     *  @returns
+     *      true if any button is held
+     */
+extern __attribute__((nothrow, nonnull))
+    bool BUTTON_scan_update(struct BUTTON_engine_t *engine, uint32_t mask);
+
+    /**
+     *  BUTTON_next_deadline()
+     *      ms until the earliest LONG_PRESS / REPEAT deadline of held buttons
+     *
+     *  @returns
+     *      -1 if no deadline is pending
+     */
+extern __attribute__((nothrow, nonnull))
+    int32_t BUTTON_next_deadline(struct BUTTON_engine_t const *engine);
+
+    /**
+     *  BUTTON_is_down()
+     *      debounced state by button id
+     */
+extern __attribute__((nothrow, nonnull, pure))
+    bool BUTTON_is_down(struct BUTTON_engine_t const *engine, uint8_t id);
+
+__END_DECLS
+#endif
@@ -0,0 +1,33 @@
+#ifndef __CHECKSUM_H
+#define __CHECKSUM_H                    1
+
+#include <features.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef CHECKSUM_BLOCK_SIZE
+    #define CHECKSUM_BLOCK_SIZE         (4096U)
+#endif
+
+    #define CRC32_INIT                  (0xFFFFFFFFUL)
+
+__BEGIN_DECLS
+    /**
+     *  CHECKSUM_crc16_xmodem()
+     *      table driven CRC16-XMODEM, same result as CRC16_hash(CRC16_XMODEM, ...)
+     *      feed crc = 0 for the first block, previous result for the following blocks
+     */
+extern __attribute__((nothrow, pure, nonnull))
+    uint16_t CHECKSUM_crc16_xmodem(uint16_t crc, void const *buf, size_t count);
+
+    /**
+     *  CHECKSUM_crc32()
+     *      slice-by-4 CRC32 (IEEE 802.3 / zlib / gzip)
+     *      feed crc = CRC32_INIT for the first block, previous result for the following blocks,
+     *      final value is ~crc
+     */
+extern __attribute__((nothrow, pure, nonnull))
+    uint32_t CHECKSUM_crc32(uint32_t crc, void const *buf, size_t count);
+
+__END_DECLS
+#endif
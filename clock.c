@@ -75,11 +75,16 @@ struct CLOCK_runtime_t
     time_t ts;
 
     struct timeout_t intv_next;
+    unsigned intv_next_ms;
+    time_t intv_next_ts;            // expected next intv_next_callback()
+
     time_t ts_alarm_snooze_end;
     time_t ts_reminder_slient_end;
 
     bytebool_t dst_active;
     int8_t alarming_idx;
+    int8_t wake_light_idx;
+    time_t wake_light_ts;           // alarm timestamp of the started wake light
 
     int16_t app_specify_cb_mtime;
     void (* app_specify_cb_moment)(void);
@@ -94,7 +99,11 @@ static struct CLOCK_moment_t alarms[ALARM_COUNT];
 static struct CLOCK_moment_t reminders[ALARM_COUNT];
 
 static int8_t CLOCK_peek_start_alarms(struct CLOCK_setting_t const *nvm_ptr);
+static void CLOCK_peek_wake_light(struct CLOCK_setting_t const *nvm_ptr);
+static void CLOCK_intv_next_start(unsigned ms, void *arg);
 static void CLOCK_intv_next_callback(void *arg);
+static int CLOCK_moment_seconds(struct CLOCK_moment_t const *moment, time_t ts);
+static int CLOCK_min_seconds(int next, int seconds);
 static unsigned CLOCK_reminders(struct tm const *dt, bool ignore_snooze, bool saying);
 
 // shell commands
@@ -246,6 +255,7 @@ void CLOCK_init(void)
     }
 
     clock_runtime.alarming_idx = -1;
+    clock_runtime.wake_light_idx = -1;
     timeout_init(&clock_runtime.intv_next, 1000 * nvm_ptr->reminder_intv_seconds, CLOCK_intv_next_callback, TIMEOUT_FLAG_REPEAT);
 
     if (0 != NVM_get(CLOCK_ALARM_NVM_ID, sizeof(alarms), &alarms))
@@ -264,6 +274,8 @@ void CLOCK_schedule(void)
     struct tm const *dt = CLOCK_update_timestamp(NULL);
     struct CLOCK_setting_t const *nvm_ptr = NVM_get_ptr(CLOCK_SETTING_NVM_ID, sizeof(*nvm_ptr));
 
+    CLOCK_peek_wake_light(nvm_ptr);
+
     if (-1 != CLOCK_peek_start_alarms(nvm_ptr))
     {
         timeout_stop(&clock_runtime.intv_next);
@@ -284,21 +296,48 @@ void CLOCK_schedule(void)
             }
 
             if (0 <= next_zsec_intv && 1000 * nvm_ptr->reminder_intv_seconds > next_zsec_intv)
-            {
-                timeout_update(&clock_runtime.intv_next, (unsigned)next_zsec_intv);
-                timeout_start(&clock_runtime.intv_next, NULL);
-            }
+                CLOCK_intv_next_start((unsigned)next_zsec_intv, NULL);
         }
     }
 
     if (! timeout_is_running(&clock_runtime.intv_next))
     {
         if(0 != CLOCK_say_reminders(dt, false))
-        {
-            timeout_update(&clock_runtime.intv_next, 1000 * nvm_ptr->reminder_intv_seconds);
-            timeout_start(&clock_runtime.intv_next, reminders);
-        }
+            CLOCK_intv_next_start(1000U * nvm_ptr->reminder_intv_seconds, reminders);
+    }
+}
+
+int CLOCK_next_moment_seconds(void)
+{
+    struct CLOCK_setting_t const *nvm_ptr = NVM_get_ptr(CLOCK_SETTING_NVM_ID, sizeof(*nvm_ptr));
+    time_t ts = CLOCK_get_timestamp();
+    int next = -1;
+
+    if (timeout_is_running(&clock_runtime.intv_next))
+        next = CLOCK_min_seconds(next, clock_runtime.intv_next_ts > ts ? (int)(clock_runtime.intv_next_ts - ts) : 0);
+
+    if (0 != nvm_ptr->say_zero_hour_mask)
+    {
+        unsigned next_zero_hour = (unsigned)((ts % 86400) / 3600 + 1) % 24;
+
+        // wdays of the next hour is not checked: predicting early only costs a pre-power
+        if ((1U << next_zero_hour) & nvm_ptr->say_zero_hour_mask)
+            next = CLOCK_min_seconds(next, (int)(3600 - ts % 3600));
+    }
+
+    bool alarm_switch_is_on = CLOCK_alarm_switch_is_on();
+    for (unsigned idx = 0; idx < lengthof(alarms); idx ++)
+    {
+        if (ALARM_FORCE_IDX_START > idx && ! alarm_switch_is_on)
+            continue;
+        next = CLOCK_min_seconds(next, CLOCK_moment_seconds(&alarms[idx], ts));
     }
+    for (unsigned idx = 0; idx < lengthof(reminders); idx ++)
+        next = CLOCK_min_seconds(next, CLOCK_moment_seconds(&reminders[idx], ts));
+
+    if (ts < clock_runtime.ts_alarm_snooze_end)
+        next = CLOCK_min_seconds(next, (int)(clock_runtime.ts_alarm_snooze_end - ts));
+    return next;
 }
 
 time_t CLOCK_get_timestamp(void)
@@ -519,6 +558,18 @@ void CLOCK_stop_app_ringtone_cb(uint8_t alarm_idx)
     ARG_UNUSED(alarm_idx);
 }
 
+__attribute__((weak))
+void CLOCK_start_wake_light_cb(uint8_t alarm_idx, uint32_t ms)
+{
+    ARG_UNUSED(alarm_idx, ms);
+}
+
+__attribute__((weak))
+void CLOCK_stop_wake_light_cb(uint8_t alarm_idx)
+{
+    ARG_UNUSED(alarm_idx);
+}
+
 /***************************************************************************
  * @implements: utils
  ***************************************************************************/
@@ -697,6 +748,71 @@ static int8_t CLOCK_peek_start_alarms(struct CLOCK_setting_t const *nvm_ptr)
         return -1;
 }
 
+static void CLOCK_peek_wake_light(struct CLOCK_setting_t const *nvm_ptr)
+{
+    time_t ts = clock_runtime.ts;
+    bool alarm_switch_is_on = CLOCK_alarm_switch_is_on();
+
+    int8_t wake_idx = -1;
+    int wake_seconds = -1;
+
+    for (int8_t idx = 0; idx < (int8_t)lengthof(alarms); idx ++)
+    {
+        struct CLOCK_moment_t const *alarm = &alarms[idx];
+
+        if (ALARM_FORCE_IDX_START > idx && ! alarm_switch_is_on)
+            continue;
+        if (0 == alarm->wake_light_minutes)
+            continue;
+
+        int seconds = CLOCK_moment_seconds(alarm, ts);
+        if (0 >= seconds || 60 * alarm->wake_light_minutes < seconds)
+            continue;
+
+        if (seconds != CLOCK_min_seconds(wake_seconds, seconds))
+            continue;
+
+        wake_idx = idx;
+        wake_seconds = seconds;
+    }
+
+    if (-1 != wake_idx)
+    {
+        struct CLOCK_moment_t const *alarm = &alarms[wake_idx];
+        time_t wake_ts = ts + wake_seconds;
+
+        // once per alarm, CLOCK_schedule() is called many times within the window
+        if (wake_idx != clock_runtime.wake_light_idx || wake_ts != clock_runtime.wake_light_ts)
+        {
+            clock_runtime.wake_light_idx = wake_idx;
+            clock_runtime.wake_light_ts = wake_ts;
+
+            // lamp reaches full brightness together with the ringtone fade-in
+            if (ALARM_RINGTONE_ID_APP_SPECIFY != alarm->ringtone_id)
+                wake_seconds += nvm_ptr->ring_fade_seconds;
+
+            CLOCK_start_wake_light_cb((uint8_t)wake_idx, 1000U * (unsigned)wake_seconds);
+        }
+    }
+    else if (-1 != clock_runtime.wake_light_idx)
+    {
+        // alarm was disabled or moved before ringing, otherwise the light stays until dismissed by user
+        if (ts < clock_runtime.wake_light_ts)
+            CLOCK_stop_wake_light_cb((uint8_t)clock_runtime.wake_light_idx);
+
+        clock_runtime.wake_light_idx = -1;
+    }
+}
+
+static void CLOCK_intv_next_start(unsigned ms, void *arg)
+{
+    clock_runtime.intv_next_ms = ms;
+    clock_runtime.intv_next_ts = clock_runtime.ts + (time_t)(ms / 1000);
+
+    timeout_update(&clock_runtime.intv_next, ms);
+    timeout_start(&clock_runtime.intv_next, arg);
+}
+
 static void CLOCK_intv_next_callback(void *arg)
 {
     timeout_stop(&clock_runtime.intv_next);
@@ -706,7 +822,47 @@ static void CLOCK_intv_next_callback(void *arg)
         VOICE_say_time(dt);
 
     if (0 != CLOCK_say_reminders(dt, true))
+    {
+        clock_runtime.intv_next_ts = clock_runtime.ts + (time_t)(clock_runtime.intv_next_ms / 1000);
         timeout_start(&clock_runtime.intv_next, arg);
+    }
+}
+
+static int CLOCK_min_seconds(int next, int seconds)
+{
+    if (0 <= seconds && (-1 == next || seconds < next))
+        return seconds;
+    else
+        return next;
+}
+
+static int CLOCK_moment_seconds(struct CLOCK_moment_t const *moment, time_t ts)
+{
+    if (! moment->enabled)
+        return -1;
+
+    // today & tomorrow are enough for any schedule within the gap of an utterance
+    for (int day = 0; day < 2; day ++)
+    {
+        time_t day_ts = ts + day * 86400;
+        int seconds = day * 86400 + (int)(mtime2time(moment->mtime) - ts % 86400);
+
+        if (0 > seconds)
+            continue;
+
+        struct tm dt;
+        localtime_r(&day_ts, &dt);
+
+        if (0 == ((1 << dt.tm_wday) & moment->wdays))
+        {
+            int32_t mdate = (((dt.tm_year + 1900) * 100 + dt.tm_mon + 1) * 100 + dt.tm_mday);
+
+            if (mdate != moment->mdate)
+                continue;
+        }
+        return seconds;
+    }
+    return -1;
 }
 
  /****************************************************************************
@@ -1076,6 +1232,7 @@ static int SHELL_alarm(struct UCSH_env *env)
                     pos += sprintf(env->buf + pos, "\"ringtone_id\":%d, ", alarm->ringtone_id);
             }
             pos += sprintf(env->buf + pos, "\"mdate\":%lu, ",  alarm->mdate);
+            pos += sprintf(env->buf + pos, "\"wake_light\":%d, ",  alarm->wake_light_minutes);
             pos += sprintf(env->buf + pos, "\"wdays\":%d}", alarm->wdays);
 
             if (flush_bytes < pos)
@@ -1136,6 +1293,25 @@ static int SHELL_alarm(struct UCSH_env *env)
             if (0 == idx || (unsigned)idx > lengthof(alarms))
                 return EINVAL;
 
+            // alarm <1~COUNT> wake=<minutes>
+            char *wake_str = CMD_paramvalue_byname("wake", env->argc, env->argv);
+            if (wake_str)
+            {
+                int wake_light = strtol(wake_str, NULL, 10);
+                if (0 > wake_light || CLOCK_WAKE_LIGHT_MAX_MINUTES < wake_light)
+                    return EINVAL;
+
+                struct CLOCK_moment_t *alarm = &alarms[idx - 1];
+                if (wake_light != alarm->wake_light_minutes)
+                {
+                    alarm->wake_light_minutes = (uint8_t)wake_light;
+                    NVM_set(CLOCK_ALARM_NVM_ID, sizeof(alarms), &alarms);
+                }
+
+                VOICE_say_setting(VOICE_SETTING_DONE);
+                return 0;
+            }
+
             bool enabled = true;
             bool deleted = false;
 
@@ -1182,7 +1358,7 @@ static int SHELL_alarm(struct UCSH_env *env)
             return 0;
         }
     }
-    else if (5 < env->argc)     // alarm <1~COUNT> <enable/disable> 1700 <ringtone_id/"string"> wdays=0x7f
+    else if (5 < env->argc)     // alarm <1~COUNT> <enable/disable> 1700 <ringtone_id/"string"> wdays=0x7f [wake=15]
     {
         int idx = strtol(env->argv[1], NULL, 10);
         if (0 == idx || (unsigned)idx > lengthof(alarms))
@@ -1247,15 +1423,30 @@ static int SHELL_alarm(struct UCSH_env *env)
             return EINVAL;
 
         struct CLOCK_moment_t *alarm = &alarms[idx - 1];
+
+        int wake_light = alarm->wake_light_minutes;     // unchanged while omitted
+        if (true)
+        {
+            char *wake_str = CMD_paramvalue_byname("wake", env->argc, env->argv);
+            if (wake_str)
+            {
+                wake_light = strtol(wake_str, NULL, 10);
+                if (0 > wake_light || CLOCK_WAKE_LIGHT_MAX_MINUTES < wake_light)
+                    return EINVAL;
+            }
+        }
+
         if (enabled != alarm->enabled || mtime != alarm->mtime ||
             ringtone != alarm->ringtone_id ||
-            mdate != alarm->mdate || wdays != alarm->wdays)
+            mdate != alarm->mdate || wdays != alarm->wdays ||
+            wake_light != alarm->wake_light_minutes)
         {
             alarm->enabled = enabled;
             alarm->mtime = (int16_t)mtime;
             alarm->ringtone_id = (uint8_t)ringtone;
             alarm->mdate = mdate;
             alarm->wdays = (int8_t)wdays;
+            alarm->wake_light_minutes = (uint8_t)wake_light;
 
             NVM_set(CLOCK_ALARM_NVM_ID, sizeof(alarms), &alarms);
         }
@@ -28,6 +28,10 @@
     #define CLOCK_DEF_RMD_INTV_SECONDS  (60)
 #endif
 
+#ifndef CLOCK_WAKE_LIGHT_MAX_MINUTES
+    #define CLOCK_WAKE_LIGHT_MAX_MINUTES (60)
+#endif
+
     #define time2mtime(ts)              ((int16_t)(((ts % 86400) / 3600) * 100 + ((ts) % 3600) / 60))
     #define mtime2time(mt)              (time_t)((((mt) / 100) * 3600 + ((mt) % 100) * 60))
 
@@ -41,6 +45,7 @@
             uint8_t ringtone_id;
             uint8_t reminder_id;
         };
+        uint8_t wake_light_minutes;     // alarms only: sunrise lamp ramp before mtime, 0 disabled
 
         int16_t mtime;  // 1700
         int32_t mdate;  // yyyy/mm/dd
@@ -59,6 +64,16 @@ extern __attribute__((nothrow))
 extern __attribute__((nothrow))
     void CLOCK_schedule(void);
 
+    /**
+     *  CLOCK_next_moment_seconds()
+     *      seconds to the next scheduled playback: reminder interval, zero hour, alarm, reminder or snooze
+     *
+     *  @returns
+     *      -1 when nothing is scheduled within tomorrow
+    */
+extern __attribute__((nothrow))
+    int CLOCK_next_moment_seconds(void);
+
     /**
      *  CLOCK_get_timestamp()
     */
@@ -216,6 +231,19 @@ extern __attribute__((nothrow))
 extern __attribute__((nothrow))
     void CLOCK_stop_app_ringtone_cb(uint8_t alarm_idx);
 
+    /**
+     *  CLOCK_start_wake_light_cb() / CLOCK_stop_wake_light_cb()
+     *
+     *  NOTE: override to drive a wake light
+     *      start is called once by CLOCK_schedule() when the alarm enters its wake_light_minutes window,
+     *      ms is the remaining time until the ringtone fade-in is completed
+     *      stop is called when the alarm is disabled or moved before ringing
+    */
+extern __attribute__((nothrow))
+    void CLOCK_start_wake_light_cb(uint8_t alarm_idx, uint32_t ms);
+extern __attribute__((nothrow))
+    void CLOCK_stop_wake_light_cb(uint8_t alarm_idx);
+
 /***************************************************************************
  * utils
  ***************************************************************************/
@@ -0,0 +1,203 @@
+#include <errno.h>
+#include <string.h>
+
+#include <hash/md5.h>
+#include <wdt.h>
+
+#include "checksum.h"
+#include "delta.h"
+
+/****************************************************************************
+ *  @internal
+ ****************************************************************************/
+static uint32_t DELTA_le32(uint8_t const *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static int DELTA_flush(struct DELTA_t *ctx)
+{
+    int err = 0;
+
+    if (0 != ctx->out_len)
+    {
+        err = ctx->write(ctx->arg, ctx->out, ctx->out_len);
+        ctx->out_len = 0;
+    }
+    return err;
+}
+
+static int DELTA_put(struct DELTA_t *ctx, uint8_t val)
+{
+    if (ctx->written == ctx->new_size)
+        return EINVAL;
+
+    ctx->out[ctx->out_len ++] = val;
+    ctx->written ++;
+
+    if (sizeof(ctx->out) == ctx->out_len)
+        return DELTA_flush(ctx);
+    else
+        return 0;
+}
+
+static int DELTA_header(struct DELTA_t *ctx)
+{
+    if (DELTA_MAGIC != DELTA_le32(&ctx->hdr[0]))
+        return EINVAL;
+
+    ctx->old_size = DELTA_le32(&ctx->hdr[4]);
+    ctx->new_size = DELTA_le32(&ctx->hdr[8]);
+
+    if (ctx->old_size > ctx->source_limit)
+        return EINTEGRITY;
+
+    MD5_context_t md5_ctx;
+    MD5_init(&md5_ctx);
+
+    // up to OTA_DELTA_SOURCE_LIMIT of flash: watchdog is fed by every block
+    for (uint32_t pos = 0; pos < ctx->old_size; pos += CHECKSUM_BLOCK_SIZE)
+    {
+        WDOG_feed();
+        MD5_update(&md5_ctx, ctx->source + pos, MIN(CHECKSUM_BLOCK_SIZE, ctx->old_size - pos));
+    }
+    MD5_t md5 = MD5_final(&md5_ctx);
+
+    if (0 != memcmp(&md5, &ctx->hdr[12], sizeof(md5)))
+        return EINTEGRITY;
+    else
+        return 0;
+}
+
+static int DELTA_ctrl(struct DELTA_t *ctx)
+{
+    ctx->diff_remain = DELTA_le32(&ctx->hdr[0]);
+    ctx->extra_remain = DELTA_le32(&ctx->hdr[4]);
+    ctx->seek = (int32_t)DELTA_le32(&ctx->hdr[8]);
+
+    if (ctx->diff_remain > ctx->old_size - ctx->old_pos)
+        return EINVAL;
+    // NOTE: diff_remain + extra_remain may wrap
+    if (ctx->diff_remain > ctx->new_size - ctx->written ||
+        ctx->extra_remain > ctx->new_size - ctx->written - ctx->diff_remain)
+    {
+        return EINVAL;
+    }
+
+    return 0;
+}
+
+static void DELTA_next_state(struct DELTA_t *ctx)
+{
+    if (0 != ctx->diff_remain)
+        ctx->state = DELTA_STATE_DIFF;
+    else if (0 != ctx->extra_remain)
+        ctx->state = DELTA_STATE_EXTRA;
+    else
+        ctx->state = DELTA_STATE_CTRL;
+}
+
+static int DELTA_seek(struct DELTA_t *ctx)
+{
+    int64_t pos = (int64_t)ctx->old_pos + ctx->seek;
+
+    if (0 > pos || ctx->old_size < pos)
+        return EINVAL;
+
+    ctx->old_pos = (uint32_t)pos;
+    return 0;
+}
+
+/****************************************************************************
+ *  @implements
+ ****************************************************************************/
+void DELTA_init(struct DELTA_t *ctx, DELTA_write_t write, void *arg,
+    uint8_t const *source, uint32_t source_limit)
+{
+    memset(ctx, 0, sizeof(*ctx));
+
+    ctx->write = write;
+    ctx->arg = arg;
+    ctx->source = source;
+    ctx->source_limit = source_limit;
+    ctx->state = DELTA_STATE_HEADER;
+}
+
+int DELTA_feed(struct DELTA_t *ctx, uint8_t const *buf, size_t count)
+{
+    int err = 0;
+
+    while (0 == err && 0 != count)
+    {
+        switch (ctx->state)
+        {
+        case DELTA_STATE_HEADER:
+            ctx->hdr[ctx->hdr_len ++] = *buf ++;
+            count --;
+
+            if (DELTA_HEADER_SIZE == ctx->hdr_len)
+            {
+                ctx->hdr_len = 0;
+                ctx->state = DELTA_STATE_CTRL;
+                err = DELTA_header(ctx);
+            }
+            break;
+
+        case DELTA_STATE_CTRL:
+            ctx->hdr[ctx->hdr_len ++] = *buf ++;
+            count --;
+
+            if (DELTA_CTRL_SIZE == ctx->hdr_len)
+            {
+                ctx->hdr_len = 0;
+                err = DELTA_ctrl(ctx);
+
+                if (0 == err)
+                {
+                    DELTA_next_state(ctx);
+
+                    if (DELTA_STATE_CTRL == ctx->state)
+                        err = DELTA_seek(ctx);
+                }
+            }
+            break;
+
+        case DELTA_STATE_DIFF:
+            err = DELTA_put(ctx, (uint8_t)(ctx->source[ctx->old_pos ++] + *buf ++));
+            count --;
+
+            if (0 == -- ctx->diff_remain)
+            {
+                DELTA_next_state(ctx);
+
+                if (DELTA_STATE_CTRL == ctx->state && 0 == err)
+                    err = DELTA_seek(ctx);
+            }
+            break;
+
+        case DELTA_STATE_EXTRA:
+            err = DELTA_put(ctx, *buf ++);
+            count --;
+
+            if (0 == -- ctx->extra_remain)
+            {
+                ctx->state = DELTA_STATE_CTRL;
+
+                if (0 == err)
+                    err = DELTA_seek(ctx);
+            }
+            break;
+        }
+    }
+    return err;
+}
+
+int DELTA_finish(struct DELTA_t *ctx)
+{
+    if (DELTA_STATE_CTRL != ctx->state || 0 != ctx->hdr_len)
+        return EINVAL;
+    if (ctx->written != ctx->new_size)
+        return EINVAL;
+
+    return DELTA_flush(ctx);
+}
@@ -0,0 +1,94 @@
+#ifndef __DELTA_H
+#define __DELTA_H                       1
+
+#include <features.h>
+#include <sys/types.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef DELTA_CHUNK_SIZE
+    #define DELTA_CHUNK_SIZE            (256U)
+#endif
+
+    #define DELTA_MAGIC                 (0x31444353UL)  // "SCD1"
+
+    /**
+     *  patch layout, all values are little endian
+     *
+     *      header:     magic, old_size, new_size, md5 of old image[16]
+     *      repeat:     diff_len, extra_len, seek (int32_t)
+     *                  diff_len bytes: add to old image byte by byte
+     *                  extra_len bytes: copy literally
+     *                  old image position += seek
+     */
+    #define DELTA_HEADER_SIZE           (28U)
+    #define DELTA_CTRL_SIZE             (12U)
+
+    typedef int (* DELTA_write_t)(void *arg, uint8_t const *buf, size_t count);
+
+    enum DELTA_state_t
+    {
+        DELTA_STATE_HEADER,
+        DELTA_STATE_CTRL,
+        DELTA_STATE_DIFF,
+        DELTA_STATE_EXTRA,
+    };
+
+    struct DELTA_t
+    {
+        DELTA_write_t write;
+        void *arg;
+
+        uint8_t const *source;
+        uint32_t source_limit;
+
+        enum DELTA_state_t state;
+        uint8_t hdr_len;
+        uint8_t hdr[DELTA_HEADER_SIZE];
+
+        uint32_t old_size;
+        uint32_t new_size;
+        uint32_t old_pos;
+        uint32_t written;
+
+        uint32_t diff_remain;
+        uint32_t extra_remain;
+        int32_t seek;
+
+        uint16_t out_len;
+        uint8_t out[DELTA_CHUNK_SIZE];
+    };
+
+__BEGIN_DECLS
+    /**
+     *  DELTA_init()
+     *      source is the memory mapped image to patch against,
+     *      source_limit bounds the old_size declared by patch header
+     */
+extern __attribute__((nothrow, nonnull(1, 2, 4)))
+    void DELTA_init(struct DELTA_t *ctx, DELTA_write_t write, void *arg,
+        uint8_t const *source, uint32_t source_limit);
+
+    /**
+     *  DELTA_feed()
+     *      push patch bytes in any chunking, patched image is emitted through write()
+     *      the source image MD5 is verified as soon as the header is complete,
+     *      before anything was written
+     *
+     *  @returns
+     *      0 or errno
+     *      EINTEGRITY source image mismatch
+     */
+extern __attribute__((nothrow, nonnull))
+    int DELTA_feed(struct DELTA_t *ctx, uint8_t const *buf, size_t count);
+
+    /**
+     *  DELTA_finish()
+     *      flush and check the patch is complete
+     */
+extern __attribute__((nothrow, nonnull))
+    int DELTA_finish(struct DELTA_t *ctx);
+
+__END_DECLS
+#endif
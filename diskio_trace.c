@@ -0,0 +1,95 @@
+#include <string.h>
+
+#include "diskio_trace.h"
+
+/****************************************************************************
+ *  @def
+ ****************************************************************************/
+struct DTRACE_runtime_t
+{
+    bool enabled;
+    unsigned head;              // next write
+    unsigned count;
+    uint32_t dropped;
+
+    struct DTRACE_entry_t ring[DTRACE_SIZE];
+};
+
+/****************************************************************************
+ *  @internal
+ ****************************************************************************/
+static struct DTRACE_runtime_t dtrace;
+
+/****************************************************************************
+ *  @implements
+ ****************************************************************************/
+void DTRACE_enable(bool en)
+{
+    dtrace.enabled = en;
+}
+
+bool DTRACE_is_enabled(void)
+{
+    return dtrace.enabled;
+}
+
+void DTRACE_clear(void)
+{
+    dtrace.head = 0;
+    dtrace.count = 0;
+    dtrace.dropped = 0;
+}
+
+void DTRACE_record(uint32_t lba, uint16_t count, bool hit, uint32_t us, enum DTRACE_tag_t tag)
+{
+    if (! dtrace.enabled)
+        return;
+
+    struct DTRACE_entry_t *entry = &dtrace.ring[dtrace.head];
+    entry->lba = lba;
+    entry->us = us;
+    entry->count = count;
+    entry->tag = (uint8_t)tag;
+    entry->hit = hit;
+
+    dtrace.head = (dtrace.head + 1) % DTRACE_SIZE;
+
+    if (DTRACE_SIZE > dtrace.count)
+        dtrace.count ++;
+    else
+        dtrace.dropped ++;
+}
+
+struct DTRACE_entry_t const *DTRACE_get(unsigned idx)
+{
+    if (dtrace.count <= idx)
+        return NULL;
+    else
+        return &dtrace.ring[(dtrace.head + DTRACE_SIZE - dtrace.count + idx) % DTRACE_SIZE];
+}
+
+unsigned DTRACE_count(void)
+{
+    return dtrace.count;
+}
+
+uint32_t DTRACE_dropped(void)
+{
+    return dtrace.dropped;
+}
+
+char const *DTRACE_tag_name(enum DTRACE_tag_t tag)
+{
+    switch (tag)
+    {
+    case DTRACE_TAG_OTHER:
+        return "other";
+    case DTRACE_TAG_VOICE:
+        return "voice";
+    case DTRACE_TAG_NOISE:
+        return "noise";
+    case DTRACE_TAG_USB:
+        return "usb";
+    }
+    return "?";
+}
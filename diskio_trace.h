@@ -0,0 +1,72 @@
+#ifndef __DISKIO_TRACE_H
+#define __DISKIO_TRACE_H                1
+
+#include <features.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef DTRACE_SIZE
+    #define DTRACE_SIZE                 (256)   // entries, 12 bytes each
+#endif
+
+    enum DTRACE_tag_t
+    {
+        DTRACE_TAG_OTHER,
+        DTRACE_TAG_VOICE,
+        DTRACE_TAG_NOISE,
+        DTRACE_TAG_USB,
+    };
+
+    struct DTRACE_entry_t
+    {
+        uint32_t lba;
+        uint32_t us;            // latency
+        uint16_t count;         // sectors
+        uint8_t tag;            // DTRACE_tag_t
+        uint8_t hit;
+    };
+
+__BEGIN_DECLS
+    /**
+     *  DTRACE_enable()
+     *      start / stop recording, the ring keeps the latest DTRACE_SIZE reads
+     */
+extern __attribute__((nothrow))
+    void DTRACE_enable(bool en);
+extern __attribute__((nothrow, pure))
+    bool DTRACE_is_enabled(void);
+
+extern __attribute__((nothrow))
+    void DTRACE_clear(void);
+
+    /**
+     *  DTRACE_record()
+     *      record a sector read, no-op when disabled
+     */
+extern __attribute__((nothrow))
+    void DTRACE_record(uint32_t lba, uint16_t count, bool hit, uint32_t us, enum DTRACE_tag_t tag);
+
+    /**
+     *  DTRACE_get()
+     *      idx 0 is the oldest entry
+     *
+     *  @returns
+     *      NULL when idx is out of recorded range
+     */
+extern __attribute__((nothrow, pure))
+    struct DTRACE_entry_t const *DTRACE_get(unsigned idx);
+
+    /**
+     *  DTRACE_count() / DTRACE_dropped()
+     *      entries in ring / overwritten since DTRACE_clear()
+     */
+extern __attribute__((nothrow, pure))
+    unsigned DTRACE_count(void);
+extern __attribute__((nothrow, pure))
+    uint32_t DTRACE_dropped(void);
+
+extern __attribute__((nothrow, const))
+    char const *DTRACE_tag_name(enum DTRACE_tag_t tag);
+
+__END_DECLS
+#endif
@@ -0,0 +1,345 @@
+#include <ultracore.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "checksum.h"
+#include "env_history.h"
+
+/****************************************************************************
+ *  @def
+ ****************************************************************************/
+#define ENVH_MAGIC                      (0x48564E45UL)  // "ENVH"
+#define ENVH_FILE_TMP                   ENVH_FILE ".tmp"
+
+// tmpr sum of int32 saturates by this count of readings at +-200°C, beyond 12 days at 1 reading per second
+#define ENVH_ACC_MAX                    ((uint32_t)INT32_MAX / 2000U)
+
+// DST moves local midnight by up to an hour: not a new day
+#define ENVH_DAY_SHIFT_MAX              (3600)
+
+struct ENVH_acc_t
+{
+    uint32_t ts;                        // slot start, 0 when empty
+    int32_t tmpr_sum;
+    uint32_t humidity_sum;
+    uint32_t count;
+
+    int16_t tmpr_min;
+    int16_t tmpr_max;
+    uint8_t humidity_min;
+    uint8_t humidity_max;
+};
+
+// saved to ENVH_FILE as is
+struct ENVH_store_t
+{
+    uint16_t block_head;                // next write
+    uint16_t block_count;
+    uint16_t hour_head;
+    uint16_t hour_count;
+    uint16_t day_head;
+    uint16_t day_count;
+
+    int16_t last_tmpr;                  // decoded value of the last sample, deltas are taken from it
+    uint8_t last_humidity;
+
+    struct ENVH_acc_t sample_acc;
+    struct ENVH_acc_t hour_acc;
+    struct ENVH_acc_t day_acc;
+
+    struct ENVH_block_t blocks[ENVH_BLOCKS];
+    struct ENVH_rollup_t hours[ENVH_HOURS];
+    struct ENVH_rollup_t days[ENVH_DAYS];
+};
+
+struct ENVH_file_header_t
+{
+    uint32_t magic;
+    uint32_t size;                      // sizeof(struct ENVH_store_t), changed by config
+};
+
+/****************************************************************************
+ *  @internal
+ ****************************************************************************/
+static bool ENVH_load(char const *path);
+static bool ENVH_is_new_day(struct ENVH_acc_t const *acc, uint32_t slot);
+static void ENVH_acc_add(struct ENVH_acc_t *acc, uint32_t slot, int16_t tmpr, uint8_t humidity);
+static int16_t ENVH_acc_tmpr_avg(struct ENVH_acc_t const *acc);
+static uint8_t ENVH_acc_humidity_avg(struct ENVH_acc_t const *acc);
+static void ENVH_push_sample(uint32_t ts, int16_t tmpr, uint8_t humidity);
+static void ENVH_push_rollup(enum ENVH_series_t series, struct ENVH_acc_t const *acc);
+static unsigned ENVH_ring_push(uint16_t *head, uint16_t *count, unsigned size);
+
+// var
+static struct ENVH_store_t envh;
+static uint32_t envh_save_ts;
+
+/****************************************************************************
+ *  @implements
+ ****************************************************************************/
+void ENVH_init(void)
+{
+    // power lost between unlink() and rename() of ENVH_save(): only the new file is left
+    if (! ENVH_load(ENVH_FILE) && ! ENVH_load(ENVH_FILE_TMP))
+        ENVH_clear();
+
+    envh_save_ts = (uint32_t)time(NULL);
+}
+
+void ENVH_record(time_t ts, int16_t tmpr, uint8_t humidity)
+{
+    uint32_t t = (uint32_t)ts;
+
+    // rollups are by local time: timezone & DST of localtime_r()
+    struct tm dt;
+    localtime_r(&ts, &dt);
+    uint32_t local_seconds = (uint32_t)(dt.tm_min * 60 + dt.tm_sec);
+
+    // a finished slot is pushed when the first reading of a new slot arrives
+    uint32_t slot = t - t % ENVH_SAMPLE_INTV;
+    if (0 != envh.sample_acc.count && slot != envh.sample_acc.ts)
+    {
+        struct ENVH_acc_t const *acc = &envh.sample_acc;
+
+        ENVH_push_sample(acc->ts, ENVH_acc_tmpr_avg(acc), ENVH_acc_humidity_avg(acc));
+        envh.sample_acc.count = 0;
+    }
+    ENVH_acc_add(&envh.sample_acc, slot, tmpr, humidity);
+
+    slot = t - local_seconds;
+    if (0 != envh.hour_acc.count && slot != envh.hour_acc.ts)
+    {
+        ENVH_push_rollup(ENVH_SERIES_HOURS, &envh.hour_acc);
+        envh.hour_acc.count = 0;
+    }
+    ENVH_acc_add(&envh.hour_acc, slot, tmpr, humidity);
+
+    slot = t - local_seconds - (uint32_t)dt.tm_hour * 3600U;
+    if (0 != envh.day_acc.count && ENVH_is_new_day(&envh.day_acc, slot))
+    {
+        ENVH_push_rollup(ENVH_SERIES_DAYS, &envh.day_acc);
+        envh.day_acc.count = 0;
+    }
+    ENVH_acc_add(&envh.day_acc, slot, tmpr, humidity);
+
+    // RTC may be set backward
+    if (ENVH_SAVE_INTV <= t - envh_save_ts || t < envh_save_ts)
+        ENVH_save();
+}
+
+int ENVH_save(void)
+{
+    envh_save_ts = (uint32_t)time(NULL);
+
+    // never truncate the saved history: a power loss while writing would lose all of it
+    int fd = open(ENVH_FILE_TMP, O_WRONLY | O_CREAT | O_TRUNC);
+    if (-1 == fd)
+        return errno;
+
+    struct ENVH_file_header_t hdr = {.magic = ENVH_MAGIC, .size = sizeof(envh)};
+    uint32_t crc = ~CHECKSUM_crc32(CRC32_INIT, &envh, sizeof(envh));
+    int retval = 0;
+
+    if (sizeof(hdr) != writebuf(fd, &hdr, sizeof(hdr)) ||
+        sizeof(envh) != writebuf(fd, &envh, sizeof(envh)) ||
+        sizeof(crc) != writebuf(fd, &crc, sizeof(crc)))
+        retval = errno;
+    close(fd);
+
+    if (0 == retval && 0 != rename(ENVH_FILE_TMP, ENVH_FILE))
+    {
+        // FAT does not rename over an existing file
+        unlink(ENVH_FILE);
+
+        if (0 != rename(ENVH_FILE_TMP, ENVH_FILE))
+            retval = errno;
+    }
+
+    if (0 != retval)
+        LOG_warning("ENVH: save error %d", retval);
+    return retval;
+}
+
+void ENVH_clear(void)
+{
+    memset(&envh, 0, sizeof(envh));
+}
+
+unsigned ENVH_block_count(void)
+{
+    return envh.block_count;
+}
+
+struct ENVH_block_t const *ENVH_block_get(unsigned idx)
+{
+    if (envh.block_count <= idx)
+        return NULL;
+    else
+        return &envh.blocks[(envh.block_head + ENVH_BLOCKS - envh.block_count + idx) % ENVH_BLOCKS];
+}
+
+unsigned ENVH_rollup_count(enum ENVH_series_t series)
+{
+    return ENVH_SERIES_HOURS == series ? envh.hour_count : envh.day_count;
+}
+
+struct ENVH_rollup_t const *ENVH_rollup_get(enum ENVH_series_t series, unsigned idx)
+{
+    if (ENVH_SERIES_HOURS == series)
+    {
+        if (envh.hour_count <= idx)
+            return NULL;
+        else
+            return &envh.hours[(envh.hour_head + ENVH_HOURS - envh.hour_count + idx) % ENVH_HOURS];
+    }
+    else
+    {
+        if (envh.day_count <= idx)
+            return NULL;
+        else
+            return &envh.days[(envh.day_head + ENVH_DAYS - envh.day_count + idx) % ENVH_DAYS];
+    }
+}
+
+/****************************************************************************
+ *  @internal
+ ****************************************************************************/
+static bool ENVH_load(char const *path)
+{
+    struct ENVH_file_header_t hdr;
+    uint32_t crc;
+    bool valid = false;
+
+    int fd = open(path, O_RDONLY);
+    if (-1 != fd)
+    {
+        if (sizeof(hdr) == read(fd, &hdr, sizeof(hdr)) &&
+            ENVH_MAGIC == hdr.magic && sizeof(envh) == hdr.size &&
+            sizeof(envh) == read(fd, &envh, sizeof(envh)) &&
+            sizeof(crc) == read(fd, &crc, sizeof(crc)))
+        {
+            valid = crc == ~CHECKSUM_crc32(CRC32_INIT, &envh, sizeof(envh));
+        }
+        close(fd);
+    }
+    return valid;
+}
+
+static bool ENVH_is_new_day(struct ENVH_acc_t const *acc, uint32_t slot)
+{
+    uint32_t shift = slot > acc->ts ? slot - acc->ts : acc->ts - slot;
+    return ENVH_DAY_SHIFT_MAX < shift;
+}
+
+static void ENVH_acc_add(struct ENVH_acc_t *acc, uint32_t slot, int16_t tmpr, uint8_t humidity)
+{
+    if (0 == acc->count)
+    {
+        acc->ts = slot;
+        acc->tmpr_sum = 0;
+        acc->humidity_sum = 0;
+        acc->tmpr_min = acc->tmpr_max = tmpr;
+        acc->humidity_min = acc->humidity_max = humidity;
+    }
+    else
+    {
+        acc->tmpr_min = MIN(acc->tmpr_min, tmpr);
+        acc->tmpr_max = MAX(acc->tmpr_max, tmpr);
+        acc->humidity_min = MIN(acc->humidity_min, humidity);
+        acc->humidity_max = MAX(acc->humidity_max, humidity);
+    }
+
+    // saturated: the average keeps the readings before
+    if (ENVH_ACC_MAX > acc->count)
+    {
+        acc->tmpr_sum += tmpr;
+        acc->humidity_sum += humidity;
+        acc->count ++;
+    }
+}
+
+// both rounded half away from zero: a truncated negative average is biased toward 0
+static int16_t ENVH_acc_tmpr_avg(struct ENVH_acc_t const *acc)
+{
+    int32_t half = (int32_t)(acc->count / 2);
+    return (int16_t)((acc->tmpr_sum + (0 > acc->tmpr_sum ? -half : half)) / (int32_t)acc->count);
+}
+
+static uint8_t ENVH_acc_humidity_avg(struct ENVH_acc_t const *acc)
+{
+    return (uint8_t)((acc->humidity_sum + acc->count / 2) / acc->count);
+}
+
+static void ENVH_push_sample(uint32_t ts, int16_t tmpr, uint8_t humidity)
+{
+    struct ENVH_block_t *blk = NULL;
+
+    if (0 != envh.block_count)
+    {
+        blk = &envh.blocks[(envh.block_head + ENVH_BLOCKS - 1) % ENVH_BLOCKS];
+
+        // full, or a gap / RTC adjusted
+        if (ENVH_BLOCK_SAMPLES <= blk->count || ts != blk->ts + blk->count * (uint32_t)ENVH_SAMPLE_INTV)
+            blk = NULL;
+    }
+
+    if (NULL == blk)
+    {
+        blk = &envh.blocks[ENVH_ring_push(&envh.block_head, &envh.block_count, ENVH_BLOCKS)];
+
+        blk->ts = ts;
+        blk->tmpr = tmpr;
+        blk->humidity = humidity;
+        blk->count = 1;
+        memset(blk->delta, 0, sizeof(blk->delta));
+
+        envh.last_tmpr = tmpr;
+        envh.last_humidity = humidity;
+    }
+    else
+    {
+        // a clamped delta is caught up by the following samples
+        int dt = MAX(INT8_MIN, MIN(INT8_MAX, tmpr - envh.last_tmpr));
+        int dh = MAX(INT8_MIN, MIN(INT8_MAX, humidity - envh.last_humidity));
+
+        blk->delta[blk->count - 1][0] = (int8_t)dt;
+        blk->delta[blk->count - 1][1] = (int8_t)dh;
+        blk->count ++;
+
+        envh.last_tmpr = (int16_t)(envh.last_tmpr + dt);
+        envh.last_humidity = (uint8_t)(envh.last_humidity + dh);
+    }
+}
+
+static void ENVH_push_rollup(enum ENVH_series_t series, struct ENVH_acc_t const *acc)
+{
+    struct ENVH_rollup_t *rollup;
+
+    if (ENVH_SERIES_HOURS == series)
+        rollup = &envh.hours[ENVH_ring_push(&envh.hour_head, &envh.hour_count, ENVH_HOURS)];
+    else
+        rollup = &envh.days[ENVH_ring_push(&envh.day_head, &envh.day_count, ENVH_DAYS)];
+
+    memset(rollup, 0, sizeof(*rollup));
+    rollup->ts = acc->ts;
+    rollup->tmpr_min = acc->tmpr_min;
+    rollup->tmpr_max = acc->tmpr_max;
+    rollup->tmpr_avg = ENVH_acc_tmpr_avg(acc);
+    rollup->humidity_min = acc->humidity_min;
+    rollup->humidity_max = acc->humidity_max;
+    rollup->humidity_avg = ENVH_acc_humidity_avg(acc);
+}
+
+static unsigned ENVH_ring_push(uint16_t *head, uint16_t *count, unsigned size)
+{
+    unsigned idx = *head;
+
+    *head = (uint16_t)((idx + 1) % size);
+    if (size > *count)
+        (*count) ++;
+
+    return idx;
+}
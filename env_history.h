@@ -0,0 +1,115 @@
+#ifndef __ENV_HISTORY_H
+#define __ENV_HISTORY_H                 1
+
+#include <features.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/***************************************************************************
+ *  environment history
+ *
+ *      readings fed by ENVH_record() are averaged into one sample by every ENVH_SAMPLE_INTV,
+ *      samples are delta encoded into blocks of ENVH_BLOCK_SAMPLES: the first sample in full,
+ *      the following as int8 deltas of tmpr (0.1°C) and humidity (%), a gap starts a new block
+ *
+ *      hourly & daily rollups keep min / max / avg of all readings, by local time
+ *      everything is saved to ENVH_FILE by every ENVH_SAVE_INTV, and loaded by ENVH_init()
+ *      saving writes ENVH_FILE ".tmp" and renames it over: a power loss keeps either file whole
+***************************************************************************/
+#ifndef ENVH_SAMPLE_INTV
+    #define ENVH_SAMPLE_INTV            (300)   // seconds
+#endif
+#ifndef ENVH_BLOCK_SAMPLES
+    #define ENVH_BLOCK_SAMPLES          (48)    // 4 hours
+#endif
+#ifndef ENVH_BLOCKS
+    #define ENVH_BLOCKS                 (42)    // 7 days
+#endif
+#ifndef ENVH_HOURS
+    #define ENVH_HOURS                  (24 * 7)
+#endif
+#ifndef ENVH_DAYS
+    #define ENVH_DAYS                   (92)
+#endif
+#ifndef ENVH_SAVE_INTV
+    #define ENVH_SAVE_INTV              (3600)  // seconds
+#endif
+#ifndef ENVH_FILE
+    #define ENVH_FILE                   "envh.bin"
+#endif
+
+    // NOTE: records are streamed as is by "envh", layout is the protocol
+    struct ENVH_block_t
+    {
+        uint32_t ts;                    // first sample
+        int16_t tmpr;
+        uint8_t humidity;
+        uint8_t count;                  // samples, first included
+        int8_t delta[ENVH_BLOCK_SAMPLES - 1][2];
+    };
+
+    struct ENVH_rollup_t
+    {
+        uint32_t ts;                    // start of hour / day
+        int16_t tmpr_min;
+        int16_t tmpr_max;
+        int16_t tmpr_avg;
+        uint8_t humidity_min;
+        uint8_t humidity_max;
+        uint8_t humidity_avg;
+        uint8_t reserved[3];
+    };
+
+    enum ENVH_series_t
+    {
+        ENVH_SERIES_HOURS,
+        ENVH_SERIES_DAYS,
+    };
+
+__BEGIN_DECLS
+    /**
+     *  ENVH_init()
+     *      load ENVH_FILE, or ENVH_FILE ".tmp" of an interrupted save, neither valid starts an empty history
+     */
+extern __attribute__((nothrow))
+    void ENVH_init(void);
+
+    /**
+     *  ENVH_record()
+     *      feed a reading, saves ENVH_FILE by ENVH_SAVE_INTV: call from a thread, not timeout callbacks
+     *      fed by ENV_sensor_read() with every new sample of the panel sensor
+     */
+extern __attribute__((nothrow))
+    void ENVH_record(time_t ts, int16_t tmpr, uint8_t humidity);
+
+    /**
+     *  ENVH_save()
+     *  @returns
+     *      errno
+     */
+extern __attribute__((nothrow))
+    int ENVH_save(void);
+
+extern __attribute__((nothrow))
+    void ENVH_clear(void);
+
+    /**
+     *  ENVH_block_get() / ENVH_rollup_get()
+     *      idx 0 is the oldest, current block is included, current hour / day is not
+     *
+     *  @returns
+     *      NULL when idx is out of range
+     */
+extern __attribute__((nothrow, pure))
+    unsigned ENVH_block_count(void);
+extern __attribute__((nothrow, pure))
+    struct ENVH_block_t const *ENVH_block_get(unsigned idx);
+
+extern __attribute__((nothrow, pure))
+    unsigned ENVH_rollup_count(enum ENVH_series_t series);
+extern __attribute__((nothrow, pure))
+    struct ENVH_rollup_t const *ENVH_rollup_get(enum ENVH_series_t series, unsigned idx);
+
+__END_DECLS
+#endif
@@ -0,0 +1,452 @@
+#include <errno.h>
+#include <string.h>
+
+#include "checksum.h"
+#include "inflate.h"
+
+/****************************************************************************
+ *  @def
+ ****************************************************************************/
+#define MAXBITS                         (15)
+#define MAXLCODES                       (286)
+#define MAXDCODES                       (30)
+#define FIXLCODES                       (288)
+
+#define GZIP_FHCRC                      (0x02)
+#define GZIP_FEXTRA                     (0x04)
+#define GZIP_FNAME                      (0x08)
+#define GZIP_FCOMMENT                   (0x10)
+
+static uint16_t const length_base[29] =
+{
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static uint8_t const length_extra[29] =
+{
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static uint16_t const dist_base[30] =
+{
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577
+};
+static uint8_t const dist_extra[30] =
+{
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+static uint8_t const codelen_order[19] =
+{
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/****************************************************************************
+ *  @internal: input
+ ****************************************************************************/
+static unsigned INFLATE_byte(struct INFLATE_t *ctx)
+{
+    if (ctx->in_pos == ctx->in_avail)
+    {
+        if (0 != ctx->err)
+            return 0;
+
+        ssize_t len = ctx->read(ctx->arg, ctx->in_buf, sizeof(ctx->in_buf));
+        if (0 >= len)
+        {
+            ctx->err = 0 == len ? EIO : (int)-len;
+            return 0;
+        }
+
+        ctx->in_avail = (uint8_t)len;
+        ctx->in_pos = 0;
+    }
+    return ctx->in_buf[ctx->in_pos ++];
+}
+
+static unsigned INFLATE_bits(struct INFLATE_t *ctx, unsigned need)
+{
+    uint32_t val = ctx->bitbuf;
+
+    while (ctx->bitcnt < need)
+    {
+        val |= (uint32_t)INFLATE_byte(ctx) << ctx->bitcnt;
+        ctx->bitcnt = (uint8_t)(ctx->bitcnt + 8);
+    }
+
+    ctx->bitbuf = val >> need;
+    ctx->bitcnt = (uint8_t)(ctx->bitcnt - need);
+
+    return val & ((1UL << need) - 1);
+}
+
+/****************************************************************************
+ *  @internal: output through window
+ ****************************************************************************/
+static void INFLATE_flush(struct INFLATE_t *ctx)
+{
+    if (ctx->flushed != ctx->wpos && 0 == ctx->err)
+    {
+        ctx->crc32 = CHECKSUM_crc32(ctx->crc32, &ctx->window[ctx->flushed], ctx->wpos - ctx->flushed);
+        ctx->err = ctx->write(ctx->arg, &ctx->window[ctx->flushed], ctx->wpos - ctx->flushed);
+        ctx->flushed = ctx->wpos;
+    }
+}
+
+static void INFLATE_put(struct INFLATE_t *ctx, uint8_t val)
+{
+    ctx->window[ctx->wpos ++] = val;
+    ctx->total_out ++;
+
+    if (INFLATE_WINDOW_SIZE == ctx->wpos)
+    {
+        INFLATE_flush(ctx);
+        ctx->wpos = ctx->flushed = 0;
+    }
+    else if (INFLATE_FLUSH_SIZE <= ctx->wpos - ctx->flushed)
+        INFLATE_flush(ctx);
+}
+
+/****************************************************************************
+ *  @internal: huffman
+ ****************************************************************************/
+static int INFLATE_construct(struct INFLATE_huffman_t *h, uint8_t const *length, unsigned n)
+{
+    uint16_t offs[MAXBITS + 1];
+
+    memset(h->counts, 0, sizeof(h->counts));
+    for (unsigned symbol = 0; symbol < n; symbol ++)
+        h->counts[length[symbol]] ++;
+
+    if (n == h->counts[0])      // no codes: complete, but decoding will fail
+        return 0;
+
+    int left = 1;
+    for (unsigned len = 1; len <= MAXBITS; len ++)
+    {
+        left <<= 1;
+        left -= h->counts[len];
+
+        if (0 > left)           // over-subscribed
+            return left;
+    }
+
+    offs[1] = 0;
+    for (unsigned len = 1; len < MAXBITS; len ++)
+        offs[len + 1] = (uint16_t)(offs[len] + h->counts[len]);
+
+    for (unsigned symbol = 0; symbol < n; symbol ++)
+    {
+        if (0 != length[symbol])
+            h->symbols[offs[length[symbol]] ++] = (uint16_t)symbol;
+    }
+    return left;
+}
+
+static int INFLATE_decode(struct INFLATE_t *ctx, struct INFLATE_huffman_t const *h)
+{
+    int code = 0;
+    int first = 0;
+    int index = 0;
+
+    for (unsigned len = 1; len <= MAXBITS; len ++)
+    {
+        code |= (int)INFLATE_bits(ctx, 1);
+        int count = h->counts[len];
+
+        if (code - count < first)
+            return h->symbols[index + (code - first)];
+
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+
+    if (0 == ctx->err)
+        ctx->err = EINVAL;
+    return -1;
+}
+
+/****************************************************************************
+ *  @internal: blocks
+ ****************************************************************************/
+static int INFLATE_stored(struct INFLATE_t *ctx)
+{
+    ctx->bitbuf = 0;
+    ctx->bitcnt = 0;
+
+    unsigned len = INFLATE_byte(ctx);
+    len |= INFLATE_byte(ctx) << 8;
+    unsigned nlen = INFLATE_byte(ctx);
+    nlen |= INFLATE_byte(ctx) << 8;
+
+    if (0 != ctx->err)
+        return ctx->err;
+    if (len != (~nlen & 0xFFFF))
+        return EINVAL;
+
+    while (len --)
+    {
+        INFLATE_put(ctx, (uint8_t)INFLATE_byte(ctx));
+
+        if (0 != ctx->err)
+            return ctx->err;
+    }
+    return 0;
+}
+
+static int INFLATE_codes(struct INFLATE_t *ctx)
+{
+    while (true)
+    {
+        int symbol = INFLATE_decode(ctx, &ctx->lencode);
+
+        if (0 != ctx->err)
+            return ctx->err;
+
+        if (256 > symbol)
+            INFLATE_put(ctx, (uint8_t)symbol);
+        else if (256 == symbol)
+            return 0;
+        else
+        {
+            symbol -= 257;
+            if (29 <= symbol)
+                return EINVAL;
+
+            unsigned len = length_base[symbol] + INFLATE_bits(ctx, length_extra[symbol]);
+
+            symbol = INFLATE_decode(ctx, &ctx->distcode);
+            if (0 > symbol || 30 <= symbol)
+                return 0 != ctx->err ? ctx->err : EINVAL;
+
+            unsigned dist = dist_base[symbol] + INFLATE_bits(ctx, dist_extra[symbol]);
+            if (dist > ctx->total_out || dist > INFLATE_WINDOW_SIZE)
+                return EINVAL;
+
+            uint32_t from = (ctx->wpos + INFLATE_WINDOW_SIZE - dist) % INFLATE_WINDOW_SIZE;
+            while (len --)
+            {
+                INFLATE_put(ctx, ctx->window[from]);
+                from = (from + 1) % INFLATE_WINDOW_SIZE;
+            }
+        }
+
+        if (0 != ctx->err)
+            return ctx->err;
+    }
+}
+
+static int INFLATE_fixed(struct INFLATE_t *ctx)
+{
+    uint8_t lengths[FIXLCODES];
+    unsigned symbol;
+
+    for (symbol = 0; symbol < 144; symbol ++)
+        lengths[symbol] = 8;
+    for (; symbol < 256; symbol ++)
+        lengths[symbol] = 9;
+    for (; symbol < 280; symbol ++)
+        lengths[symbol] = 7;
+    for (; symbol < FIXLCODES; symbol ++)
+        lengths[symbol] = 8;
+    INFLATE_construct(&ctx->lencode, lengths, FIXLCODES);
+
+    for (symbol = 0; symbol < MAXDCODES; symbol ++)
+        lengths[symbol] = 5;
+    INFLATE_construct(&ctx->distcode, lengths, MAXDCODES);
+
+    return INFLATE_codes(ctx);
+}
+
+static int INFLATE_dynamic(struct INFLATE_t *ctx)
+{
+    uint8_t lengths[MAXLCODES + MAXDCODES];
+
+    unsigned nlen = INFLATE_bits(ctx, 5) + 257;
+    unsigned ndist = INFLATE_bits(ctx, 5) + 1;
+    unsigned ncode = INFLATE_bits(ctx, 4) + 4;
+
+    if (0 != ctx->err)
+        return ctx->err;
+    if (MAXLCODES < nlen || MAXDCODES < ndist)
+        return EINVAL;
+
+    unsigned index;
+    for (index = 0; index < ncode; index ++)
+        lengths[codelen_order[index]] = (uint8_t)INFLATE_bits(ctx, 3);
+    for (; index < 19; index ++)
+        lengths[codelen_order[index]] = 0;
+
+    // code length codes are borrowed the lencode table
+    if (0 != INFLATE_construct(&ctx->lencode, lengths, 19))
+        return EINVAL;
+
+    index = 0;
+    while (index < nlen + ndist)
+    {
+        int symbol = INFLATE_decode(ctx, &ctx->lencode);
+
+        if (0 != ctx->err)
+            return ctx->err;
+
+        if (16 > symbol)
+            lengths[index ++] = (uint8_t)symbol;
+        else
+        {
+            uint8_t len = 0;
+            unsigned repeat;
+
+            if (16 == symbol)
+            {
+                if (0 == index)
+                    return EINVAL;
+
+                len = lengths[index - 1];
+                repeat = 3 + INFLATE_bits(ctx, 2);
+            }
+            else if (17 == symbol)
+                repeat = 3 + INFLATE_bits(ctx, 3);
+            else
+                repeat = 11 + INFLATE_bits(ctx, 7);
+
+            if (index + repeat > nlen + ndist)
+                return EINVAL;
+
+            while (repeat --)
+                lengths[index ++] = len;
+        }
+    }
+
+    if (0 == lengths[256])
+        return EINVAL;
+
+    // incomplete code ok only for single length 1 code
+    int err = INFLATE_construct(&ctx->lencode, lengths, nlen);
+    if (0 > err || (0 < err && nlen - ctx->lencode.counts[0] != 1))
+        return EINVAL;
+
+    err = INFLATE_construct(&ctx->distcode, lengths + nlen, ndist);
+    if (0 > err || (0 < err && ndist - ctx->distcode.counts[0] != 1))
+        return EINVAL;
+
+    return INFLATE_codes(ctx);
+}
+
+/****************************************************************************
+ *  @implements
+ ****************************************************************************/
+void INFLATE_init(struct INFLATE_t *ctx, INFLATE_read_t read, INFLATE_write_t write, void *arg,
+    uint8_t *window)
+{
+    memset(ctx, 0, sizeof(*ctx));
+
+    ctx->read = read;
+    ctx->write = write;
+    ctx->arg = arg;
+    ctx->window = window;
+    ctx->crc32 = CRC32_INIT;
+}
+
+int INFLATE_raw(struct INFLATE_t *ctx)
+{
+    int err;
+    unsigned last;
+
+    do
+    {
+        last = INFLATE_bits(ctx, 1);
+
+        switch (INFLATE_bits(ctx, 2))
+        {
+        case 0:
+            err = INFLATE_stored(ctx);
+            break;
+        case 1:
+            err = INFLATE_fixed(ctx);
+            break;
+        case 2:
+            err = INFLATE_dynamic(ctx);
+            break;
+        default:
+            err = EINVAL;
+            break;
+        }
+
+        if (0 != ctx->err)
+            err = ctx->err;
+    }
+    while (0 == err && ! last);
+
+    if (0 == err)
+    {
+        INFLATE_flush(ctx);
+        err = ctx->err;
+    }
+    return err;
+}
+
+int INFLATE_gzip(struct INFLATE_t *ctx)
+{
+    uint8_t hdr[10];
+
+    for (unsigned i = 0; i < sizeof(hdr); i ++)
+        hdr[i] = (uint8_t)INFLATE_byte(ctx);
+
+    if (0 != ctx->err)
+        return ctx->err;
+    if (0x1F != hdr[0] || 0x8B != hdr[1] || 8 != hdr[2])
+        return EINVAL;
+
+    if (GZIP_FEXTRA & hdr[3])
+    {
+        unsigned xlen = INFLATE_byte(ctx);
+        xlen |= INFLATE_byte(ctx) << 8;
+
+        while (xlen -- && 0 == ctx->err)
+            INFLATE_byte(ctx);
+    }
+    if (GZIP_FNAME & hdr[3])
+    {
+        while (0 != INFLATE_byte(ctx) && 0 == ctx->err);
+    }
+    if (GZIP_FCOMMENT & hdr[3])
+    {
+        while (0 != INFLATE_byte(ctx) && 0 == ctx->err);
+    }
+    if (GZIP_FHCRC & hdr[3])
+    {
+        INFLATE_byte(ctx);
+        INFLATE_byte(ctx);
+    }
+    if (0 != ctx->err)
+        return ctx->err;
+
+    int err = INFLATE_raw(ctx);
+    if (0 != err)
+        return err;
+
+    // trailer is byte aligned: CRC32 + ISIZE
+    ctx->bitbuf = 0;
+    ctx->bitcnt = 0;
+
+    uint8_t trailer[8];
+    for (unsigned i = 0; i < sizeof(trailer); i ++)
+        trailer[i] = (uint8_t)INFLATE_byte(ctx);
+
+    if (0 != ctx->err)
+        return ctx->err;
+
+    uint32_t crc = (uint32_t)trailer[0] | (uint32_t)trailer[1] << 8 |
+        (uint32_t)trailer[2] << 16 | (uint32_t)trailer[3] << 24;
+    uint32_t isize = (uint32_t)trailer[4] | (uint32_t)trailer[5] << 8 |
+        (uint32_t)trailer[6] << 16 | (uint32_t)trailer[7] << 24;
+
+    if (crc != ~ctx->crc32 || isize != ctx->total_out)
+        return EINTEGRITY;
+    else
+        return 0;
+}
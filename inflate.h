@@ -0,0 +1,90 @@
+#ifndef __INFLATE_H
+#define __INFLATE_H                     1
+
+#include <features.h>
+#include <sys/types.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef INFLATE_WINDOW_SIZE
+    #define INFLATE_WINDOW_SIZE         (32768U)
+#endif
+
+#ifndef INFLATE_FLUSH_SIZE
+    #define INFLATE_FLUSH_SIZE          (1024U)
+#endif
+
+    #define INFLATE_INPUT_SIZE          (32U)
+
+    /**
+     *  read callback: fill buf with at most count bytes
+     *  @returns
+     *      bytes filled, 0 or negative errno when the stream is broken
+     */
+    typedef ssize_t (* INFLATE_read_t)(void *arg, uint8_t *buf, size_t count);
+
+    /**
+     *  write callback: consume count decompressed bytes
+     *  @returns
+     *      0 or errno
+     */
+    typedef int (* INFLATE_write_t)(void *arg, uint8_t const *buf, size_t count);
+
+    struct INFLATE_huffman_t
+    {
+        uint16_t counts[16];
+        uint16_t symbols[288];
+    };
+
+    struct INFLATE_t
+    {
+        INFLATE_read_t read;
+        INFLATE_write_t write;
+        void *arg;
+
+        int err;
+        uint32_t bitbuf;
+        uint8_t bitcnt;
+
+        uint8_t in_avail;
+        uint8_t in_pos;
+        uint8_t in_buf[INFLATE_INPUT_SIZE];
+
+        uint8_t *window;
+        uint32_t wpos;
+        uint32_t flushed;
+        uint32_t total_out;
+        uint32_t crc32;
+
+        struct INFLATE_huffman_t lencode;
+        struct INFLATE_huffman_t distcode;
+    };
+
+__BEGIN_DECLS
+    /**
+     *  INFLATE_init()
+     *      window must be INFLATE_WINDOW_SIZE bytes, it is the only history kept:
+     *      decompressed data is flushed to write() as soon as INFLATE_FLUSH_SIZE accumulated
+     */
+extern __attribute__((nothrow, nonnull(1, 2, 3, 5)))
+    void INFLATE_init(struct INFLATE_t *ctx, INFLATE_read_t read, INFLATE_write_t write, void *arg,
+        uint8_t *window);
+
+    /**
+     *  INFLATE_raw()
+     *      decompress a raw deflate stream (RFC1951) until final block
+     *
+     *  INFLATE_gzip()
+     *      decompress a gzip member (RFC1952), verify CRC32 & ISIZE of trailer
+     *
+     *  @returns
+     *      0 or errno
+     */
+extern __attribute__((nothrow, nonnull))
+    int INFLATE_raw(struct INFLATE_t *ctx);
+extern __attribute__((nothrow, nonnull))
+    int INFLATE_gzip(struct INFLATE_t *ctx);
+
+__END_DECLS
+#endif
@@ -2,6 +2,7 @@
 #define __SMARTCUCKOO_LOCALE_H          1
 
 #include <stdint.h>
+#include "sensors/env_conv.h"
 
     enum __attribute__((packed)) LOCALE_dfmt_t
     {
@@ -44,7 +45,7 @@ extern __attribute__((nothrow, const))
 static inline
     int16_t TMPR_fahrenheit(int16_t celsius_tmpr)
     {
-        return (int16_t)((celsius_tmpr * 9 / 5) + 320);
+        return ENV_CONV_fahrenheit(celsius_tmpr);
     }
 
 __END_DECLS
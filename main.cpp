@@ -8,6 +8,9 @@
 #include <sdmmc.h>
 
 #include "smartcuckoo.h"
+#include "power.h"
+#include "audio_pm.h"
+#include "diskio_trace.h"
 
 #ifdef I2S_PINS
     #include <i2s.h>
@@ -31,6 +34,28 @@
 #define MPLAYER_QUEUE_SIZE              (32)
 #define MPLAYER_STACK_SIZE              (8192)
 
+// sectors cache & read-ahead per stream, tune by tools/diskio_sim.py
+#ifndef DISKIO_CACHE_COUNT
+    #define DISKIO_CACHE_COUNT          (48)
+#endif
+#ifndef DISKIO_READAHEAD_DEFAULT
+    #define DISKIO_READAHEAD_DEFAULT    (4)     // idle: USB mass storage & shell file I/O
+#endif
+#ifndef DISKIO_READAHEAD_VOICE
+    #define DISKIO_READAHEAD_VOICE      (1)
+#endif
+#ifndef DISKIO_READAHEAD_NOISE
+    #define DISKIO_READAHEAD_NOISE      (1)     // loop payload by noise_stream.c, cache holds FAT metadata only
+#endif
+
+#ifndef BATT_AD_SYNC_TIMEOUT
+    #define BATT_AD_SYNC_TIMEOUT        (100)   // ms, shell calibration waits a fresh conversion
+#endif
+
+#ifndef SDMMC_WARM_RESUME
+    #define SDMMC_WARM_RESUME           (1)     // keep SD card in standby across deep sleep
+#endif
+
 /****************************************************************************
  *  @public
  ****************************************************************************/
@@ -64,6 +89,9 @@ enum LOCALE_hfmt_t LOCALE_hfmt(void)
 static struct DISKIO_attr_t sdmmc_diskio;
 static struct SDMMC_attr_t sdmmc;
 static struct FAT_attr_t fat;
+static bool sdmmc_inserted;
+static bool sdmmc_revalidate;           // woken up with card, FAT volume & cache retained
+static enum AUDIO_PM_stream_t sdmmc_stream;
 
 static struct USBD_SCSI_attr_t usbd_scsi;
 static struct PMU_attr_t pmu_attr;
@@ -78,21 +106,29 @@ static struct PMU_attr_t pmu_attr;
 struct batt_ad_t
 {
     struct ADC_attr_t attr;
-    int value;
+    bool playing;
 
     struct
     {
         int cumul;
         int cumul_count;
     };
+    int volatile sample_mv;     // last unfiltered conversion, before shift
 };
 
 static struct batt_ad_t batt_ad;
+static struct BATT_monitor_t batt_mon;
+static struct BATT_estimator_t batt_est;
+static struct BATT_load_model_t const batt_load_model = BATT_LOAD_MODEL_INITIALIZER;
+static uint16_t batt_est_count;
 #endif
+static unsigned batt_ext_loads;
 
 void SDIO_power_ctrl(struct SDMMC_implement_t const *sdio_impl, bool en)
 {
     (void)sdio_impl, (void)en;
+    POWER_track(POWER_CAUSE_SDIO, en);
+
     if (en)
     {
         GPIO_setdir_output(SDIO_POWER_PULL, SDIO_POWER_PIN);
@@ -164,7 +200,9 @@ int main(void)
 
             if (5 == ++ ad->cumul_count)
             {
-                ad->value = ad->cumul / ad->cumul_count + ADC_get_batt_shift();
+                // filter is shift free, shift is applied by PERIPHERAL_batt_volt()
+                ad->sample_mv = ad->cumul / ad->cumul_count;
+                BATT_monitor_sample(&batt_mon, ad->sample_mv, ad->playing, CLOCK_get_timestamp());
                 ad->cumul = 0;
                 ad->cumul_count = 0;
                 ADC_stop_convert(&ad->attr);
@@ -174,7 +212,9 @@ int main(void)
         ADC_attr_positive_input(&batt_ad.attr, PIN_BATT_ADC);
         ADC_attr_scale(&batt_ad.attr, BATT_AD_NUMERATOR, BATT_AD_DENOMINATOR);
 
-        PERIPHERAL_batt_ad_start();
+        BATT_monitor_init(&batt_mon, BATT_HINT_MV, BATT_SAMPLE_MAX_SECONDS);
+        BATT_estimator_init(&batt_est, BATT_CAPACITY_MAH, &batt_load_model);
+        PERIPHERAL_batt_schedule();
     #endif
 
     PMU_power_lock();
@@ -182,14 +222,20 @@ int main(void)
         {
             if (PMU_EVENT_SLEEP == event)
             {
-                SDMMC_card_remove(&sdmmc);
-                DISKIO_release(&sdmmc_diskio);
+                // idle card is powered down, retained card stays in standby
+                if (AUDIO_PM_sleep(SDMMC_WARM_RESUME) && sdmmc_inserted)
+                    sdmmc_revalidate = true;
+            }
+            else if (sdmmc_revalidate)
+            {
+                // card status (CMD13) at wakeup, not by the first playback only
+                AUDIO_PM_resume();
             }
         },
     NULL);
 
-    DISKIO_init(&sdmmc_diskio, 48);
-    DISKIO_set_readahead(&sdmmc_diskio, 4);     // REVIEW: 2k readhead is optimized for 48 caches
+    DISKIO_init(&sdmmc_diskio, DISKIO_CACHE_COUNT);
+    DISKIO_set_readahead(&sdmmc_diskio, DISKIO_READAHEAD_DEFAULT);
 
     FAT_attr_init(&fat, &sdmmc_diskio);
     SDMMC_attr_init(&sdmmc, 3300, 0, &sdmmc_diskio);
@@ -202,6 +248,7 @@ int main(void)
             goto sdmmc_print_err;
         if (0 != (err = SDMMC_card_insert(&sdmmc)))
             goto sdmmc_print_err;
+        sdmmc_inserted = true;
         if (0 != (err = FAT_mount_rw_root(&fat)))
             goto sdmmc_print_err;
 
@@ -232,6 +279,7 @@ int main(void)
     {
         LC3_register_codec();
         mplayer_init(MPLAYER_QUEUE_SIZE);
+        AUDIO_PM_init();
     }
 
     PERIPHERAL_init();
@@ -241,6 +289,93 @@ int main(void)
     SHELL_bootstrap();
 }
 
+/***************************************************************************/
+/** audio power
+****************************************************************************/
+void AUDIO_PM_power_ctrl(bool en)
+{
+    if (en)
+    {
+        bool remount = false;
+
+        if (sdmmc_revalidate)
+        {
+            sdmmc_revalidate = false;
+
+            // warm resume: card status (CMD13) only, FAT volume & DISKIO cache are kept
+            if (sdmmc_inserted && 0 == SDMMC_card_status(&sdmmc))
+                return;
+
+            LOG_warning("SDMMC: warm resume failed, re-initializing");
+            SDMMC_card_remove(&sdmmc);
+            DISKIO_release(&sdmmc_diskio);
+
+            sdmmc_inserted = false;
+            remount = true;
+        }
+
+        if (! sdmmc_inserted)
+        {
+            int err = SDMMC_card_insert(&sdmmc);
+
+            // card may have been swapped while failing status
+            if (0 == err && remount)
+                err = FAT_mount_rw_root(&fat);
+
+            if (0 == err)
+                sdmmc_inserted = true;
+            else
+                LOG_error("SDMMC error: %s", SDMMC_strerror(err));
+        }
+    }
+    else
+    {
+        // amplifier is gated by the renderer with its own warm up
+        SDMMC_card_remove(&sdmmc);
+        DISKIO_release(&sdmmc_diskio);
+
+        sdmmc_inserted = false;
+        sdmmc_revalidate = false;
+    }
+}
+
+void AUDIO_PM_stream_ctrl(enum AUDIO_PM_stream_t stream)
+{
+    static uint8_t const readahead[] =
+    {
+        [AUDIO_PM_STREAM_NONE]  = DISKIO_READAHEAD_DEFAULT,
+        [AUDIO_PM_STREAM_VOICE] = DISKIO_READAHEAD_VOICE,
+        [AUDIO_PM_STREAM_NOISE] = DISKIO_READAHEAD_NOISE,
+    };
+
+    if (sdmmc_stream != stream)
+    {
+        sdmmc_stream = stream;
+        DISKIO_set_readahead(&sdmmc_diskio, readahead[stream]);
+    }
+}
+
+// DISKIO read hook: every sector read with cache hit / miss and latency
+extern "C" void DISKIO_trace_callback(struct DISKIO_attr_t *diskio, uint32_t lba, uint16_t count, bool hit, uint32_t us)
+{
+    (void)diskio;
+    enum DTRACE_tag_t tag;
+
+    switch (sdmmc_stream)
+    {
+    case AUDIO_PM_STREAM_VOICE:
+        tag = DTRACE_TAG_VOICE;
+        break;
+    case AUDIO_PM_STREAM_NOISE:
+        tag = DTRACE_TAG_NOISE;
+        break;
+    default:
+        tag = PERIPHERAL_is_enable_usb() ? DTRACE_TAG_USB : DTRACE_TAG_OTHER;
+        break;
+    }
+    DTRACE_record(lba, count, hit, us, tag);
+}
+
 /***************************************************************************/
 /** @weak
 ****************************************************************************/
@@ -292,12 +427,19 @@ void PERIPHERAL_on_wakeup(void)
 {
 }
 
+__attribute__((weak))
+uint8_t PERIPHERAL_batt_led_percent(void)
+{
+    return 0;
+}
+
 /***************************************************************************/
 /** battery
 ****************************************************************************/
 void PERIPHERAL_batt_ad_start(void)
 {
 #ifdef PIN_BATT_ADC
+    batt_ad.playing = ! AUDIO_renderer_is_idle();
     ADC_start_convert(&batt_ad.attr, &batt_ad);
 #endif
 }
@@ -305,27 +447,110 @@ void PERIPHERAL_batt_ad_start(void)
 uint16_t PERIPHERAL_batt_ad_sync(void)
 {
 #ifdef PIN_BATT_ADC
-    batt_ad.value = 0;
+    batt_ad.sample_mv = 0;
     PERIPHERAL_batt_ad_start();
 
-    while (0 == batt_ad.value) pthread_yield();
+    clock_t ts = clock();
+    while (0 == batt_ad.sample_mv && BATT_AD_SYNC_TIMEOUT > clock() - ts)
+        msleep(1);
+
+    if (0 == batt_ad.sample_mv)
+        return 0;
 
-    LOG_info("batt: %d mV", batt_ad.value);
-    return (uint16_t)batt_ad.value;
+    LOG_info("batt: %d mV", batt_ad.sample_mv);
+    return (uint16_t)(batt_ad.sample_mv + ADC_get_batt_shift());
 #else
     return 0;
 #endif
 }
 
+void PERIPHERAL_batt_schedule(void)
+{
+    // decoding is sampled per alive tick, running intervals are flushed into hourly history
+    POWER_track(POWER_CAUSE_DECODE, ! AUDIO_renderer_is_idle());
+    POWER_flush();
+
+#ifdef PIN_BATT_ADC
+    time_t ts = CLOCK_get_timestamp();
+    unsigned loads = batt_ext_loads;
+
+    if (! AUDIO_renderer_is_idle())
+        loads |= MYNOISE_is_running() ? BATT_LOAD_NOISE : BATT_LOAD_VOICE;
+
+    uint8_t led_percent = PERIPHERAL_batt_led_percent();
+    if (0 != led_percent)
+        loads |= BATT_LOAD_LED;
+
+    bool changed = BATT_estimator_load(&batt_est, loads, led_percent, ts);
+
+    // new conversion was sampled
+    if (batt_est_count != batt_mon.count)
+    {
+        batt_est_count = batt_mon.count;
+        BATT_estimator_voltage(&batt_est, BATT_mv_level(PERIPHERAL_batt_volt()));
+        changed = true;
+    }
+
+    // discharge trace: replay by tools/batt_fit.py
+    if (changed)
+    {
+        LOG_info("batt: ts=%lu mv=%u loads=0x%02x led=%u level=%u",
+            (unsigned long)ts, PERIPHERAL_batt_volt(), loads, led_percent, BATT_estimator_level(&batt_est));
+    }
+
+    if (BATT_monitor_schedule(&batt_mon, ts))
+        PERIPHERAL_batt_ad_start();
+#endif
+}
+
+void PERIPHERAL_batt_load(unsigned loads, bool en)
+{
+    if (en)
+        batt_ext_loads |= loads;
+    else
+        batt_ext_loads &= ~loads;
+}
+
 uint16_t PERIPHERAL_batt_volt(void)
 {
 #ifdef PIN_BATT_ADC
-    return (uint16_t)batt_ad.value;
+    uint16_t mv = BATT_monitor_mv(&batt_mon);
+    return 0 == mv ? 0 : (uint16_t)(mv + ADC_get_batt_shift());
+#else
+    return 0;
+#endif
+}
+
+uint8_t PERIPHERAL_batt_level(void)
+{
+#ifdef PIN_BATT_ADC
+    if (0 == batt_est_count)
+        return BATT_mv_level(PERIPHERAL_batt_volt());
+    else
+        return BATT_estimator_level(&batt_est);
+#else
+    return 0;
+#endif
+}
+
+uint32_t PERIPHERAL_batt_minutes(void)
+{
+#ifdef PIN_BATT_ADC
+    return 0 == batt_est_count ? 0 : BATT_estimator_minutes(&batt_est);
 #else
     return 0;
 #endif
 }
 
+struct BATT_estimator_t const *PERIPHERAL_batt_estimator(void)
+{
+#ifdef PIN_BATT_ADC
+    return &batt_est;
+#else
+    return NULL;
+#endif
+}
+
 uint8_t BATT_mv_level(uint32_t mV)
 {
 #if ! defined(BATT_LOW_MV) || ! defined(BATT_EMPTY_MV)
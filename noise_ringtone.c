@@ -1,4 +1,5 @@
 #include "smartcuckoo.h"
+#include "audio_pm.h"
 
 /******************************************************************************
  *  @def
@@ -27,6 +28,8 @@ int CLOCK_start_app_ringtone_cb(uint8_t alarm_idx)
     if (! AUDIO_renderer_is_idle() && ! MYNOISE_is_running())
         return EAGAIN;
 
+    AUDIO_PM_busy(AUDIO_PM_STREAM_NOISE);
+
     unsigned nvm_id = NOISE_RINGTONE_NVM_ID + (alarm_idx - 10) / lengthof(nvm_ptr->item);
     unsigned idx = (alarm_idx - 10) % lengthof(nvm_ptr->item);
 
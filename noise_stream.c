@@ -0,0 +1,343 @@
+#include <ultracore/log.h>
+#include <ultracore/thread.h>
+#include <audio/mynoise.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "noise_stream.h"
+
+/****************************************************************************
+ *  @def
+ ****************************************************************************/
+#if 0 != NOISE_STREAM_CHUNK_SIZE % 512 || 0 != NOISE_STREAM_HEAD_SIZE % 512
+    #pragma GCC error "NOISE_STREAM_CHUNK_SIZE / NOISE_STREAM_HEAD_SIZE must be multiple of sector"
+#endif
+
+struct NOISE_STREAM_chunk_t
+{
+    off_t offset;
+    size_t len;
+    uint8_t *data;
+};
+
+struct NOISE_STREAM_runtime_t
+{
+    int fd;                     // -1 when closed
+    off_t size;
+    off_t pos;                  // decoder position
+
+    struct NOISE_STREAM_chunk_t head;
+    struct NOISE_STREAM_chunk_t chunk[2];
+    unsigned front;
+
+    bool pending;               // reader thread is filling chunk[front ^ 1]
+    sem_t fill_sem;
+    sem_t ready_sem;
+
+    struct NOISE_STREAM_stat_t stat;
+};
+
+/****************************************************************************
+ *  @internal
+ ****************************************************************************/
+static __attribute__((noreturn)) void *NOISE_STREAM_thread(void *arg);
+static int NOISE_STREAM_fill(struct NOISE_STREAM_chunk_t *chunk, off_t offset);
+static void NOISE_STREAM_prefetch(off_t offset);
+static void NOISE_STREAM_waitfor(void);
+
+// var
+__THREAD_STACK static uint32_t noise_stream_stack[NOISE_STREAM_STACK_SIZE / sizeof(uint32_t)];
+static struct NOISE_STREAM_runtime_t noise_stream = {.fd = -1};
+static bool noise_stream_thread_created;
+
+/****************************************************************************
+ *  @implements
+ ****************************************************************************/
+int NOISE_STREAM_open(char const *path)
+{
+    if (-1 != noise_stream.fd)
+        return __set_errno_neg(EBUSY);
+
+    if (! noise_stream_thread_created)
+    {
+        sem_init(&noise_stream.fill_sem, 0, 0);
+        sem_init(&noise_stream.ready_sem, 0, 0);
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstack(&attr, noise_stream_stack, sizeof(noise_stream_stack));
+
+        pthread_t id;
+        pthread_create(&id, &attr, NOISE_STREAM_thread, &noise_stream);
+        pthread_attr_destroy(&attr);
+
+        noise_stream_thread_created = true;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (-1 == fd)
+        return fd;
+
+    uint8_t *data = malloc(NOISE_STREAM_HEAD_SIZE + 2 * NOISE_STREAM_CHUNK_SIZE);
+    if (NULL == data)
+    {
+        close(fd);
+        return __set_errno_neg(ENOMEM);
+    }
+
+    noise_stream.fd = fd;
+    noise_stream.size = lseek(fd, 0, SEEK_END);
+    noise_stream.pos = 0;
+    noise_stream.front = 0;
+    noise_stream.pending = false;
+
+    noise_stream.head.data = data;
+    noise_stream.chunk[0].data = data + NOISE_STREAM_HEAD_SIZE;
+    noise_stream.chunk[1].data = data + NOISE_STREAM_HEAD_SIZE + NOISE_STREAM_CHUNK_SIZE;
+    noise_stream.chunk[0].len = noise_stream.chunk[1].len = 0;
+
+    int err = 0 > noise_stream.size ? errno : 0;
+    if (0 == err)
+        err = NOISE_STREAM_fill(&noise_stream.head, 0);
+
+    if (0 != err)
+    {
+        NOISE_STREAM_close(fd);
+        return __set_errno_neg(err);
+    }
+
+    NOISE_STREAM_prefetch((off_t)noise_stream.head.len);
+    return fd;
+}
+
+bool NOISE_STREAM_is_stream(int fd)
+{
+    return -1 != fd && fd == noise_stream.fd;
+}
+
+ssize_t NOISE_STREAM_read(int fd, void *buf, size_t count)
+{
+    if (! NOISE_STREAM_is_stream(fd))
+        return __set_errno_neg(EBADF);
+
+    uint8_t *ptr = buf;
+
+    while (0 < count && noise_stream.size > noise_stream.pos)
+    {
+        struct NOISE_STREAM_chunk_t *chunk;
+
+        if ((off_t)noise_stream.head.len > noise_stream.pos)
+        {
+            chunk = &noise_stream.head;
+        }
+        else
+        {
+            chunk = &noise_stream.chunk[noise_stream.front];
+
+            if (chunk->offset > noise_stream.pos || chunk->offset + (off_t)chunk->len <= noise_stream.pos)
+            {
+                struct NOISE_STREAM_chunk_t *back = &noise_stream.chunk[noise_stream.front ^ 1];
+
+                if (noise_stream.pending)
+                {
+                    // decoder caught up with reader thread
+                    if (0 != sem_trywait(&noise_stream.ready_sem))
+                    {
+                        noise_stream.stat.stalls ++;
+                        sem_wait(&noise_stream.ready_sem);
+                    }
+                    noise_stream.pending = false;
+                }
+
+                if (back->offset <= noise_stream.pos && back->offset + (off_t)back->len > noise_stream.pos)
+                {
+                    noise_stream.front ^= 1;
+                    chunk = back;
+                }
+                else
+                {
+                    noise_stream.stat.seeks ++;
+
+                    int err = NOISE_STREAM_fill(chunk, noise_stream.pos & ~(off_t)511);
+                    if (0 != err)
+                        return ptr == buf ? __set_errno_neg(err) : ptr - (uint8_t *)buf;
+                }
+
+                // next chunk, or the one after head when reaching EOF: the loop restarts from head
+                off_t next = chunk->offset + (off_t)chunk->len;
+                NOISE_STREAM_prefetch(noise_stream.size > next ? next : (off_t)noise_stream.head.len);
+            }
+        }
+
+        size_t len = MIN(count, (size_t)(chunk->offset + (off_t)chunk->len - noise_stream.pos));
+        memcpy(ptr, chunk->data + (noise_stream.pos - chunk->offset), len);
+
+        ptr += len;
+        count -= len;
+        noise_stream.pos += len;
+    }
+    return ptr - (uint8_t *)buf;
+}
+
+off_t NOISE_STREAM_seek(int fd, off_t offset, int whence)
+{
+    if (! NOISE_STREAM_is_stream(fd))
+        return __set_errno_neg(EBADF);
+
+    switch (whence)
+    {
+    case SEEK_SET:
+        break;
+    case SEEK_CUR:
+        offset += noise_stream.pos;
+        break;
+    case SEEK_END:
+        offset += noise_stream.size;
+        break;
+    default:
+        return __set_errno_neg(EINVAL);
+    }
+
+    if (0 > offset)
+        return __set_errno_neg(EINVAL);
+
+    if ((off_t)noise_stream.head.len > offset && (off_t)noise_stream.head.len <= noise_stream.pos)
+        noise_stream.stat.loops ++;
+
+    // actual reading is deferred to NOISE_STREAM_read()
+    noise_stream.pos = offset;
+    return offset;
+}
+
+int NOISE_STREAM_close(int fd)
+{
+    if (! NOISE_STREAM_is_stream(fd))
+        return __set_errno_neg(EBADF);
+
+    NOISE_STREAM_waitfor();
+    noise_stream.fd = -1;
+
+    free(noise_stream.head.data);
+    noise_stream.head.data = NULL;
+    noise_stream.head.len = 0;
+
+    return close(fd);
+}
+
+struct NOISE_STREAM_stat_t const *NOISE_STREAM_stat(void)
+{
+    return &noise_stream.stat;
+}
+
+/****************************************************************************
+ *  @implements: ultracore mynoise.c file hooks, weak defaults are open() / read() / lseek() / close()
+ ****************************************************************************/
+int MYNOISE_file_open(char const *path)
+{
+    int fd = NOISE_STREAM_open(path);
+
+    // stream is busy with another loop, out of memory, or rejected the file:
+    //  plain read through shared DISKIO cache
+    if (-1 == fd)
+        fd = open(path, O_RDONLY);
+    return fd;
+}
+
+ssize_t MYNOISE_file_read(int fd, void *buf, size_t count)
+{
+    if (NOISE_STREAM_is_stream(fd))
+        return NOISE_STREAM_read(fd, buf, count);
+    else
+        return read(fd, buf, count);
+}
+
+off_t MYNOISE_file_seek(int fd, off_t offset, int whence)
+{
+    if (NOISE_STREAM_is_stream(fd))
+        return NOISE_STREAM_seek(fd, offset, whence);
+    else
+        return lseek(fd, offset, whence);
+}
+
+int MYNOISE_file_close(int fd)
+{
+    if (NOISE_STREAM_is_stream(fd))
+        return NOISE_STREAM_close(fd);
+    else
+        return close(fd);
+}
+
+/****************************************************************************
+ *  @internal
+ ****************************************************************************/
+static int NOISE_STREAM_fill(struct NOISE_STREAM_chunk_t *chunk, off_t offset)
+{
+    size_t size = &noise_stream.head == chunk ? NOISE_STREAM_HEAD_SIZE : NOISE_STREAM_CHUNK_SIZE;
+
+    chunk->offset = offset;
+    chunk->len = 0;
+
+    if (offset != lseek(noise_stream.fd, offset, SEEK_SET))
+        return errno;
+
+    // sector aligned offset & size: FAT transfers whole sectors to chunk, bypassing DISKIO cache
+    ssize_t len = read(noise_stream.fd, chunk->data, size);
+    if (0 > len)
+        return errno;
+
+    chunk->len = (size_t)len;
+    return 0;
+}
+
+static void NOISE_STREAM_prefetch(off_t offset)
+{
+    struct NOISE_STREAM_chunk_t *back = &noise_stream.chunk[noise_stream.front ^ 1];
+
+    NOISE_STREAM_waitfor();
+
+    if (noise_stream.size <= offset)
+        return;
+    if (back->offset == offset && 0 != back->len)
+        return;
+
+    back->offset = offset;
+    back->len = 0;
+
+    noise_stream.pending = true;
+    sem_post(&noise_stream.fill_sem);
+}
+
+static void NOISE_STREAM_waitfor(void)
+{
+    if (noise_stream.pending)
+    {
+        sem_wait(&noise_stream.ready_sem);
+        noise_stream.pending = false;
+    }
+}
+
+static void *NOISE_STREAM_thread(void *arg)
+{
+    struct NOISE_STREAM_runtime_t *runtime = arg;
+
+    while (1)
+    {
+        sem_wait(&runtime->fill_sem);
+
+        struct NOISE_STREAM_chunk_t *back = &runtime->chunk[runtime->front ^ 1];
+        int err = NOISE_STREAM_fill(back, back->offset);
+
+        if (0 != err)
+            LOG_error("noise stream: read error %d at %u", err, (unsigned)back->offset);
+        else
+            runtime->stat.fills ++;
+
+        sem_post(&runtime->ready_sem);
+    }
+}
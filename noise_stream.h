@@ -0,0 +1,60 @@
+#ifndef __NOISE_STREAM_H
+#define __NOISE_STREAM_H                1
+
+#include <features.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifndef NOISE_STREAM_CHUNK_SIZE
+    #define NOISE_STREAM_CHUNK_SIZE     (4096)  // multi-block read per fill, x2 double buffer
+#endif
+#ifndef NOISE_STREAM_HEAD_SIZE
+    #define NOISE_STREAM_HEAD_SIZE      (4096)  // retained file head: loop restart without SD access
+#endif
+#ifndef NOISE_STREAM_STACK_SIZE
+    #define NOISE_STREAM_STACK_SIZE     (1024)
+#endif
+
+    struct NOISE_STREAM_stat_t
+    {
+        uint32_t fills;         // chunk reads by reader thread
+        uint32_t loops;         // restarts served from head buffer
+        uint32_t stalls;        // decoder waited for a pending fill
+        uint32_t seeks;         // synchronous reads out of sequence
+    };
+
+__BEGIN_DECLS
+    /**
+     *  NOISE_STREAM_open()
+     *      open a long-running noise loop: head of file is retained, the payload is read
+     *      NOISE_STREAM_CHUNK_SIZE at once into double buffers ahead of the decoder,
+     *      by whole sectors directly to the buffers instead of through the shared DISKIO cache
+     *
+     *  @returns
+     *      file descriptor, or -1 with errno set: EBUSY when another noise stream is open,
+     *      ENOMEM, or errors of open() / lseek(). caller should fallback to open() on any of them
+     */
+extern __attribute__((nothrow))
+    int NOISE_STREAM_open(char const *path);
+
+    /**
+     *  NOISE_STREAM_is_stream()
+     *      fd was returned by NOISE_STREAM_open()
+     */
+extern __attribute__((nothrow, pure))
+    bool NOISE_STREAM_is_stream(int fd);
+
+extern __attribute__((nothrow))
+    ssize_t NOISE_STREAM_read(int fd, void *buf, size_t count);
+extern __attribute__((nothrow))
+    off_t NOISE_STREAM_seek(int fd, off_t offset, int whence);
+
+extern __attribute__((nothrow))
+    int NOISE_STREAM_close(int fd);
+
+extern __attribute__((nothrow, pure))
+    struct NOISE_STREAM_stat_t const *NOISE_STREAM_stat(void);
+
+__END_DECLS
+#endif
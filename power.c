@@ -0,0 +1,175 @@
+#include <string.h>
+#include <time.h>
+
+#include "power.h"
+
+/****************************************************************************
+ *  @def
+ ****************************************************************************/
+#define ANY                             POWER_CAUSE_COUNT
+
+struct POWER_runtime_t
+{
+    time_t since;
+
+    uint8_t depth[POWER_CAUSE_COUNT + 1];
+    clock_t start[POWER_CAUSE_COUNT + 1];
+
+    struct POWER_total_t total[POWER_CAUSE_COUNT + 1];
+
+    time_t hour_of_bucket[POWER_HISTORY_HOURS];
+    uint32_t bucket_ms[POWER_HISTORY_HOURS][POWER_CAUSE_COUNT + 1];
+};
+
+/****************************************************************************
+ *  @internal
+ ****************************************************************************/
+static void POWER_accumulate(unsigned idx, clock_t now);
+
+// var
+static struct POWER_runtime_t power;
+
+static char const *const cause_names[POWER_CAUSE_COUNT + 1] =
+{
+    [POWER_CAUSE_ALIVE]     = "alive",
+    [POWER_CAUSE_BUTTON]    = "button",
+    [POWER_CAUSE_DECODE]    = "decode",
+    [POWER_CAUSE_SDIO]      = "sdio",
+    [POWER_CAUSE_BLE]       = "ble",
+    [POWER_CAUSE_LED]       = "led",
+    [POWER_CAUSE_SENSOR]    = "sensor",
+    [ANY]                   = "awake",
+};
+
+/****************************************************************************
+ *  @implements
+ ****************************************************************************/
+void POWER_enter(enum POWER_cause_t cause)
+{
+    if (POWER_CAUSE_COUNT <= (unsigned)cause)
+        return;
+
+    clock_t now = clock();
+
+    if (0 == power.since)
+        power.since = time(NULL);
+
+    if (0 == power.depth[cause] ++)
+    {
+        power.start[cause] = now;
+        power.total[cause].count ++;
+
+        if (0 == power.depth[ANY] ++)
+        {
+            power.start[ANY] = now;
+            power.total[ANY].count ++;
+        }
+    }
+}
+
+void POWER_leave(enum POWER_cause_t cause)
+{
+    if (POWER_CAUSE_COUNT <= (unsigned)cause || 0 == power.depth[cause])
+        return;
+
+    if (0 == -- power.depth[cause])
+    {
+        clock_t now = clock();
+        POWER_accumulate(cause, now);
+
+        if (0 == -- power.depth[ANY])
+            POWER_accumulate(ANY, now);
+    }
+}
+
+void POWER_track(enum POWER_cause_t cause, bool active)
+{
+    if (POWER_CAUSE_COUNT <= (unsigned)cause)
+        return;
+
+    if (active && 0 == power.depth[cause])
+        POWER_enter(cause);
+    else if (! active && 0 != power.depth[cause])
+    {
+        power.depth[cause] = 1;
+        POWER_leave(cause);
+    }
+}
+
+void POWER_flush(void)
+{
+    clock_t now = clock();
+
+    for (unsigned idx = 0; idx <= POWER_CAUSE_COUNT; idx ++)
+    {
+        if (0 != power.depth[idx])
+            POWER_accumulate(idx, now);
+    }
+}
+
+void POWER_reset(void)
+{
+    POWER_flush();
+
+    memset(power.total, 0, sizeof(power.total));
+    memset(power.hour_of_bucket, 0, sizeof(power.hour_of_bucket));
+    memset(power.bucket_ms, 0, sizeof(power.bucket_ms));
+    power.since = time(NULL);
+}
+
+time_t POWER_since(void)
+{
+    return power.since;
+}
+
+void POWER_total(enum POWER_cause_t cause, struct POWER_total_t *total)
+{
+    if (POWER_CAUSE_COUNT < (unsigned)cause)
+        memset(total, 0, sizeof(*total));
+    else
+        *total = power.total[cause];
+}
+
+uint32_t POWER_hourly_ms(enum POWER_cause_t cause, unsigned hours_ago)
+{
+    if (POWER_CAUSE_COUNT < (unsigned)cause || POWER_HISTORY_HOURS <= hours_ago)
+        return 0;
+
+    time_t hour = time(NULL) / 3600 - (time_t)hours_ago;
+    unsigned bucket = (unsigned)(hour % POWER_HISTORY_HOURS);
+
+    if (hour != power.hour_of_bucket[bucket])
+        return 0;
+    else
+        return power.bucket_ms[bucket][cause];
+}
+
+char const *POWER_cause_name(enum POWER_cause_t cause)
+{
+    if (POWER_CAUSE_COUNT < (unsigned)cause)
+        return "?";
+    else
+        return cause_names[cause];
+}
+
+/****************************************************************************
+ *  @internal
+ ****************************************************************************/
+static void POWER_accumulate(unsigned idx, clock_t now)
+{
+    uint32_t ms = (uint32_t)((now - power.start[idx]) * 1000 / CLOCKS_PER_SEC);
+    power.start[idx] = now;
+
+    power.total[idx].ms += ms;
+
+    time_t hour = time(NULL) / 3600;
+    unsigned bucket = (unsigned)(hour % POWER_HISTORY_HOURS);
+
+    // bucket is reused after POWER_HISTORY_HOURS
+    if (hour != power.hour_of_bucket[bucket])
+    {
+        power.hour_of_bucket[bucket] = hour;
+        memset(power.bucket_ms[bucket], 0, sizeof(power.bucket_ms[bucket]));
+    }
+    power.bucket_ms[bucket][idx] += ms;
+}
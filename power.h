@@ -0,0 +1,105 @@
+#ifndef __POWER_H
+#define __POWER_H                       1
+
+#include <features.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <pmu.h>
+
+#ifndef POWER_HISTORY_HOURS
+    #define POWER_HISTORY_HOURS         (24)
+#endif
+
+    enum POWER_cause_t
+    {
+        POWER_CAUSE_ALIVE,          // MSG_alive tick
+        POWER_CAUSE_BUTTON,         // button / message handling of dispatch threads
+        POWER_CAUSE_DECODE,         // mplayer decode & rendering
+        POWER_CAUSE_SDIO,           // SD card powered
+        POWER_CAUSE_BLE,            // BLE connected
+        POWER_CAUSE_LED,            // LED refresh
+        POWER_CAUSE_SENSOR,         // sensor conversion & read
+        POWER_CAUSE_COUNT,
+    };
+
+    struct POWER_total_t
+    {
+        uint64_t ms;
+        uint32_t count;
+    };
+
+__BEGIN_DECLS
+    /**
+     *  POWER_enter() / POWER_leave()
+     *      attribute awake time to cause, nestable, overlapped causes are each accounted
+     *      NOTE: counters are statistics, updates from interrupt context may race
+     */
+extern __attribute__((nothrow))
+    void POWER_enter(enum POWER_cause_t cause);
+extern __attribute__((nothrow))
+    void POWER_leave(enum POWER_cause_t cause);
+
+    /**
+     *  POWER_track()
+     *      level triggered POWER_enter() / POWER_leave() for states sampled by polling
+     */
+extern __attribute__((nothrow))
+    void POWER_track(enum POWER_cause_t cause, bool active);
+
+    /**
+     *  POWER_flush()
+     *      account running intervals up to now, keeps long intervals in their hourly bucket
+     */
+extern __attribute__((nothrow))
+    void POWER_flush(void);
+
+    /**
+     *  POWER_reset()
+     *      clear totals & history, running intervals continue
+     */
+extern __attribute__((nothrow))
+    void POWER_reset(void);
+
+    /**
+     *  POWER_since()
+     *      wall clock of the first POWER_enter() / last POWER_reset()
+     */
+extern __attribute__((nothrow))
+    time_t POWER_since(void);
+
+    /**
+     *  POWER_total()
+     *      cumulative since boot / POWER_reset(), POWER_CAUSE_COUNT for awake time of any cause
+     *
+     *  POWER_hourly_ms()
+     *      awake ms of cause within the hour hours_ago (0 = current hour)
+     */
+extern __attribute__((nothrow, nonnull))
+    void POWER_total(enum POWER_cause_t cause, struct POWER_total_t *total);
+extern __attribute__((nothrow))
+    uint32_t POWER_hourly_ms(enum POWER_cause_t cause, unsigned hours_ago);
+
+extern __attribute__((nothrow, pure))
+    char const *POWER_cause_name(enum POWER_cause_t cause);
+
+    /**
+     *  POWER_lock() / POWER_unlock()
+     *      PMU_power_lock() / PMU_power_unlock() attributed to cause
+     */
+static inline
+    void POWER_lock(enum POWER_cause_t cause)
+    {
+        POWER_enter(cause);
+        PMU_power_lock();
+    }
+
+static inline
+    void POWER_unlock(enum POWER_cause_t cause)
+    {
+        PMU_power_unlock();
+        POWER_leave(cause);
+    }
+
+__END_DECLS
+#endif
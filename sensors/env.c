@@ -0,0 +1,127 @@
+#include <ultracore.h>
+
+#include <string.h>
+#include <stropts.h>
+#include <i2c.h>
+
+#include "env.h"
+
+/***************************************************************************
+ *  @def
+ ***************************************************************************/
+enum ENV_sensor_state_t
+{
+    ENV_SENSOR_IDLE             = 0,
+    ENV_SENSOR_CONVERTING,
+    ENV_SENSOR_RETRY_PENDING,
+};
+
+/***************************************************************************
+ *  @internal
+ ***************************************************************************/
+static void ENV_sensor_timeo_callback(struct ENV_sensor_t *sensor);
+static void ENV_sensor_issue(struct ENV_sensor_t *sensor);
+static void ENV_sensor_retry(struct ENV_sensor_t *sensor, int err);
+static void ENV_sensor_done(struct ENV_sensor_t *sensor, int err);
+static void ENV_sensor_schedule(struct ENV_sensor_t *sensor, enum ENV_sensor_state_t state, uint32_t ms);
+
+/***************************************************************************
+ *  @export
+ ***************************************************************************/
+int ENV_sensor_init(struct ENV_sensor_t *sensor, struct ENV_driver_t const *driver,
+    void *i2c_dev, uint16_t kbps, uint8_t da)
+{
+    memset(sensor, 0, sizeof(*sensor));
+    sensor->driver = driver;
+
+    sensor->fd = I2C_createfd(i2c_dev, 0 == da ? driver->da : da, kbps, 0, 0);
+    if (0 > sensor->fd)
+        return errno;
+
+    uint32_t timeout = driver->io_timeo;
+    ioctl(sensor->fd, OPT_RD_TIMEO, &timeout);
+    ioctl(sensor->fd, OPT_WR_TIMEO, &timeout);
+
+    timeout_init(&sensor->timeo, ENV_SENSOR_RETRY_INTV, (void *)ENV_sensor_timeo_callback, 0);
+    return 0;
+}
+
+int ENV_sensor_start(struct ENV_sensor_t *sensor, enum ENV_mode_t mode, ENV_sensor_callback_t callback, void *arg)
+{
+    if (0 >= sensor->fd)
+        return ENODEV;
+    if (ENV_sensor_is_busy(sensor))
+        return EBUSY;
+
+    sensor->mode = (uint8_t)mode;
+    sensor->callback = callback;
+    sensor->arg = arg;
+    sensor->retries = 0;
+
+    ENV_sensor_issue(sensor);
+    return 0;
+}
+
+/***************************************************************************
+ *  @internal
+ ***************************************************************************/
+static void ENV_sensor_timeo_callback(struct ENV_sensor_t *sensor)
+{
+    if (ENV_SENSOR_RETRY_PENDING == sensor->state)
+    {
+        ENV_sensor_issue(sensor);
+        return;
+    }
+
+    int err = sensor->driver->read(sensor);
+    if (0 == err)
+    {
+        sensor->tick = clock();
+        ENV_sensor_done(sensor, 0);
+    }
+    else if (EAGAIN == err && ENV_SENSOR_POLL_MAX > ++ sensor->polls)
+        ENV_sensor_schedule(sensor, ENV_SENSOR_CONVERTING, ENV_SENSOR_POLL_INTV);
+    else
+        ENV_sensor_retry(sensor, err);
+}
+
+static void ENV_sensor_issue(struct ENV_sensor_t *sensor)
+{
+    sensor->polls = 0;
+
+    int err = sensor->driver->start_convert(sensor);
+    if (0 == err)
+        ENV_sensor_schedule(sensor, ENV_SENSOR_CONVERTING, sensor->conv_ms);
+    else
+        ENV_sensor_retry(sensor, err);
+}
+
+static void ENV_sensor_retry(struct ENV_sensor_t *sensor, int err)
+{
+    LOG_warning("ENV: error %d, retry %d", err, sensor->retries);
+
+    // the bus & sensor recover by a restarted conversion, no more system reset
+    if (ENV_SENSOR_RETRIES > sensor->retries ++)
+        ENV_sensor_schedule(sensor, ENV_SENSOR_RETRY_PENDING, ENV_SENSOR_RETRY_INTV);
+    else
+        ENV_sensor_done(sensor, err);
+}
+
+static void ENV_sensor_done(struct ENV_sensor_t *sensor, int err)
+{
+    ENV_sensor_callback_t callback = sensor->callback;
+
+    sensor->state = ENV_SENSOR_IDLE;
+    sensor->callback = NULL;
+
+    callback(sensor, err, sensor->arg);
+}
+
+static void ENV_sensor_schedule(struct ENV_sensor_t *sensor, enum ENV_sensor_state_t state, uint32_t ms)
+{
+    sensor->state = (uint8_t)state;
+
+    timeout_stop(&sensor->timeo);
+    timeout_update(&sensor->timeo, ms);
+    timeout_start(&sensor->timeo, sensor);
+}
@@ -1,17 +1,140 @@
-#ifndef __AHT2X_H
-#define __AHT2X_H                       1
+#ifndef __ENV_SENSOR_H
+#define __ENV_SENSOR_H                  1
 
 #include <features.h>
+#include <ultracore/timeo.h>
+
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <time.h>
+
+/***************************************************************************
+ *  asynchronous temperature / humidity sensor
+ *
+ *      ENV_sensor_start() writes the convert command and returns, the result is read by
+ *      a timeout after the datasheet conversion delay of the driver, then callback() is
+ *      called from the timeout context: post a message when the work is heavy
+ *
+ *      I2C errors are retried by restarting the conversion, up to ENV_SENSOR_RETRIES
+ *      every sensor has its own context, multiple sensors / drivers coexist
+***************************************************************************/
+#ifndef ENV_SENSOR_RETRIES
+    #define ENV_SENSOR_RETRIES          (3)
+#endif
+#ifndef ENV_SENSOR_RETRY_INTV
+    #define ENV_SENSOR_RETRY_INTV       (20)    // ms, also I2C bus settling
+#endif
+#ifndef ENV_SENSOR_POLL_INTV
+    #define ENV_SENSOR_POLL_INTV        (10)    // ms, result not ready after conversion delay
+#endif
+#ifndef ENV_SENSOR_POLL_MAX
+    #define ENV_SENSOR_POLL_MAX         (5)
+#endif
+
+    enum ENV_mode_t
+    {
+        ENV_MODE_LOW_PRECISION      = 0,
+        ENV_MODE_MED_PRECISION,
+        ENV_MODE_HIGH_PRECISION,
+        ENV_MODE_HEATER,                // heater pulse, result is biased by heat
+    };
+
+    struct ENV_sensor_t;
+    typedef void (*ENV_sensor_callback_t)(struct ENV_sensor_t *sensor, int err, void *arg);
+
+    struct ENV_driver_t
+    {
+        uint8_t da;                     // default I2C address
+        uint32_t io_timeo;              // I2C read / write timeout
+        bool has_heater;
+
+        /**
+         *  write convert command of sensor->mode, set sensor->conv_ms
+         *      a driver without the mode uses the nearest one
+         *  @returns errno
+         */
+        int (* start_convert)(struct ENV_sensor_t *sensor);
+        /**
+         *  read result into sensor->tmpr / sensor->humidity
+         *  @returns errno, EAGAIN when conversion is not completed
+         */
+        int (* read)(struct ENV_sensor_t *sensor);
+    };
+
+    struct ENV_sensor_t
+    {
+        int fd;
+        struct ENV_driver_t const *driver;
+        struct timeout_t timeo;
+
+        ENV_sensor_callback_t callback; // conversion in progress while not NULL
+        void *arg;
+
+        uint16_t conv_ms;
+        uint8_t mode;                   // enum ENV_mode_t
+        uint8_t state;
+        uint8_t retries;
+        uint8_t polls;
+
+        int16_t tmpr;                   // 0.1°C
+        uint8_t humidity;               // %
+        clock_t tick;                   // last result
+    };
+
+    extern struct ENV_driver_t const ENV_sht4x_driver;
+    extern struct ENV_driver_t const ENV_aht2x_driver;
 
 __BEGIN_DECLS
+    /**
+     *  ENV_sensor_init()
+     *      da: I2C address, 0 for default of driver
+     *
+     *  @returns
+     *      errno
+     */
+extern __attribute__((nothrow, nonnull(1, 2, 3)))
+    int ENV_sensor_init(struct ENV_sensor_t *sensor, struct ENV_driver_t const *driver,
+        void *i2c_dev, uint16_t kbps, uint8_t da);
+
+    /**
+     *  ENV_sensor_start()
+     *      start a conversion by mode, callback() is called once by result or error after retries
+     *
+     *  @returns
+     *      EBUSY when a conversion is in progress
+     */
+extern __attribute__((nothrow, nonnull(1, 3)))
+    int ENV_sensor_start(struct ENV_sensor_t *sensor, enum ENV_mode_t mode, ENV_sensor_callback_t callback, void *arg);
 
+static inline
+    bool ENV_sensor_is_busy(struct ENV_sensor_t const *sensor)
+    {
+        return NULL != sensor->callback;
+    }
+
+    /**
+     *  ENV_sensor_createfd() / ENV_sensor_start_convert() / ENV_sensor_read()
+     *      blocking API of a single sensor by ENV_SENSOR_LEGACY_DRIVER (SHT4x by default),
+     *      kept for the panel: the sensor is sampled by ENV_policy since createfd(),
+     *      start_convert() marks the value displayed for ENV_SENSOR_LEGACY_DISPLAY_WINDOW,
+     *      read() waits for a conversion in progress and returns the last valid sample
+     *
+     *  ENV_sensor_set_displayed()
+     *      screen on / off: off returns to background sampling without waiting for the window
+     *
+     *  @returns
+     *      createfd(): fd, or -1 with errno set. others: errno
+     */
 extern __attribute__((nothrow))
-    int ENV_sensor_createfd(void *const dev, uint16_t kbps);
+    int ENV_sensor_createfd(void *dev, uint16_t kbps);
 
-extern __attribute__((nothrow, nonnull))
+extern __attribute__((nothrow))
     int ENV_sensor_start_convert(int fd);
 
+extern __attribute__((nothrow))
+    int ENV_sensor_set_displayed(int fd, bool displayed);
+
 extern __attribute__((nothrow, nonnull))
     int ENV_sensor_read(int fd, int16_t *tmpr, uint8_t *humidity);
 
@@ -1,8 +1,7 @@
 #include <ultracore.h>
 
-#include <stropts.h>
-#include <i2c.h>
 #include "env.h"
+#include "env_conv.h"
 
 /***************************************************************************
  *  @def
@@ -16,27 +15,32 @@
 /***************************************************************************
  *  @internal
  ***************************************************************************/
+static int AHT2X_start_convert(struct ENV_sensor_t *sensor);
+static int AHT2X_read(struct ENV_sensor_t *sensor);
+
 static uint8_t const cmd_start_convert[] = {0xAC, 0x33, 0};
+static uint8_t const cmd_calibrate[] = {0xBE, 0x08, 0};
 
 /***************************************************************************
  *  @export
  ***************************************************************************/
-int ENV_sensor_createfd(void *const dev, uint16_t kbps)
+struct ENV_driver_t const ENV_aht2x_driver =
 {
-    int fd = I2C_createfd(dev, AHT2X_DA, kbps, 0, 0);
-    {
-        uint32_t timeout = 5;
-
-        ioctl(fd, OPT_RD_TIMEO, &timeout);
-        ioctl(fd, OPT_WR_TIMEO, &timeout);
-    }
+    .da = AHT2X_DA,
+    .io_timeo = 5,
+    .start_convert = AHT2X_start_convert,
+    .read = AHT2X_read,
+};
 
-    return fd;
-}
-
-int ENV_sensor_start_convert(int fd)
+/***************************************************************************
+ *  @internal
+ ***************************************************************************/
+static int AHT2X_start_convert(struct ENV_sensor_t *sensor)
 {
-    if (sizeof(cmd_start_convert) != write(fd, cmd_start_convert, sizeof(cmd_start_convert)))
+    // single precision and no heater: every mode is the same measurement
+    sensor->conv_ms = AHT2X_MEASURE_TIMEO;
+
+    if (sizeof(cmd_start_convert) != write(sensor->fd, cmd_start_convert, sizeof(cmd_start_convert)))
     {
         int err = errno;
         LOG_error("AHT2X: start convert error %d", err);
@@ -46,47 +50,46 @@ int ENV_sensor_start_convert(int fd)
         return 0;
 }
 
-int ENV_sensor_read(int fd, int16_t *tmpr, uint8_t *humidity)
+static int AHT2X_read(struct ENV_sensor_t *sensor)
 {
     uint8_t stat;
     int retval;
 
-    if (sizeof(stat) != read(fd, &stat, sizeof(stat)))
+    if (sizeof(stat) != read(sensor->fd, &stat, sizeof(stat)))
     {
         retval = errno;
         goto read_exit;
     }
 
+    // busy: polled by ENV_SENSOR_POLL_INTV
     if (0 != (0x80 & stat))
-    {
-        retval = ENODATA;
-        goto read_exit;
-    }
+        return EAGAIN;
 
     if (0 == (0x08 & stat))
     {
-        // I2C_generic_recovery(fd);
-        retval = EAGAIN;
+        // not calibrated: calibrate, the conversion is restarted by ENV_SENSOR_RETRY_INTV
+        (void)write(sensor->fd, cmd_calibrate, sizeof(cmd_calibrate));
+        retval = ENODATA;
         goto read_exit;
     }
 
     uint8_t buf[7];
-    if (sizeof(buf) == read(fd, buf, sizeof(buf)))
+    if (sizeof(buf) == read(sensor->fd, buf, sizeof(buf)))
     {
         int val;
 
         val = (buf[3] & 0x0F) << 16 | buf[4] << 8 | buf[5];
         // RAW => tmpr
-        val = (int16_t)(val * (200 * 10) / 1048576 - 500);
+        val = AHT2X_tmpr((uint32_t)val);
 
         if (-200 < val && 1000 > val)   // validate tmpr range -20.0 ~ 100 °C
         {
-            *tmpr = (int16_t)val;
+            sensor->tmpr = (int16_t)val;
 
             val = (buf[3] & 0xF0) >>  4 | buf[1] << 12 | buf[2] << 4;
-            *humidity = (uint8_t)(val * 100 / 1048576);
+            sensor->humidity = AHT2X_humidity((uint32_t)val);
 
-            LOG_debug("AHT2X: tmpr %d, humidity %d", *tmpr, *humidity);
+            LOG_debug("AHT2X: tmpr %d, humidity %d", sensor->tmpr, sensor->humidity);
             retval = 0;
         }
         else
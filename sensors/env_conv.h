@@ -0,0 +1,87 @@
+#ifndef __ENV_CONV_H
+#define __ENV_CONV_H                    1
+
+#include <features.h>
+#include <stdint.h>
+
+/***************************************************************************
+ *  sensor reading conversions
+ *
+ *      all conversions round to nearest: value * num / den is taken as
+ *          (value * ENV_CONV_RECIPROCAL(num, den, shift) + half) >> shift
+ *      a 32 x 32 => 64 multiply (UMULL) without division, shift is picked exact for every input
+ *
+ *      tmpr in 0.1°C, humidity in %
+***************************************************************************/
+#define ENV_CONV_RECIPROCAL(num, den, shift)    \
+    ((uint32_t)((((uint64_t)(num) << (shift)) + (den) / 2) / (den)))
+
+// SHT4x: T = -45 + 175 * raw / 65535, RH = -6 + 125 * raw / 65535
+#define SHT4X_TMPR_SHIFT                (29)
+#define SHT4X_TMPR_RECIPROCAL           ENV_CONV_RECIPROCAL(1750, 65535, SHT4X_TMPR_SHIFT)
+#define SHT4X_HUMIDITY_SHIFT            (30)
+#define SHT4X_HUMIDITY_RECIPROCAL       ENV_CONV_RECIPROCAL(125, 65535, SHT4X_HUMIDITY_SHIFT)
+
+// AHT2x: T = -50 + 200 * raw / 2^20, RH = 100 * raw / 2^20
+#define AHT2X_SHIFT                     (20)
+
+// F = C * 9 / 5 + 32, celsius is offset by a multiple of 5 to be unsigned
+#define FAHRENHEIT_SHIFT                (29)
+#define FAHRENHEIT_RECIPROCAL           ENV_CONV_RECIPROCAL(9, 5, FAHRENHEIT_SHIFT)
+#define FAHRENHEIT_OFFSET               (32770)
+
+__BEGIN_DECLS
+
+static inline
+    uint32_t ENV_CONV_mul_round(uint32_t value, uint32_t reciprocal, unsigned shift)
+    {
+        return (uint32_t)(((uint64_t)value * reciprocal + (1ULL << (shift - 1))) >> shift);
+    }
+
+static inline
+    int16_t SHT4X_tmpr(uint16_t raw)
+    {
+        return (int16_t)((int)ENV_CONV_mul_round(raw, SHT4X_TMPR_RECIPROCAL, SHT4X_TMPR_SHIFT) - 450);
+    }
+
+static inline
+    uint8_t SHT4X_humidity(uint16_t raw)
+    {
+        int humidity = (int)ENV_CONV_mul_round(raw, SHT4X_HUMIDITY_RECIPROCAL, SHT4X_HUMIDITY_SHIFT) - 6;
+
+        // cropped as datasheet
+        if (0 > humidity)
+            return 0;
+        else if (100 < humidity)
+            return 100;
+        else
+            return (uint8_t)humidity;
+    }
+
+static inline
+    int16_t AHT2X_tmpr(uint32_t raw)
+    {
+        return (int16_t)((int)ENV_CONV_mul_round(raw & 0xFFFFF, 2000, AHT2X_SHIFT) - 500);
+    }
+
+static inline
+    uint8_t AHT2X_humidity(uint32_t raw)
+    {
+        return (uint8_t)ENV_CONV_mul_round(raw & 0xFFFFF, 100, AHT2X_SHIFT);
+    }
+
+    /**
+     *  ENV_CONV_fahrenheit()
+     *      0.1°C => 0.1°F
+     */
+static inline
+    int16_t ENV_CONV_fahrenheit(int16_t celsius_tmpr)
+    {
+        uint32_t offset = (uint32_t)(celsius_tmpr + FAHRENHEIT_OFFSET);
+
+        return (int16_t)((int32_t)ENV_CONV_mul_round(offset, FAHRENHEIT_RECIPROCAL, FAHRENHEIT_SHIFT)
+            - FAHRENHEIT_OFFSET * 9 / 5 + 320);
+    }
+
+__END_DECLS
+#endif
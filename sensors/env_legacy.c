@@ -0,0 +1,123 @@
+#include <ultracore.h>
+
+#include "env.h"
+#include "env_policy.h"
+#include "env_history.h"
+
+/***************************************************************************
+ *  @def
+ ***************************************************************************/
+#ifndef ENV_SENSOR_LEGACY_DRIVER
+    #define ENV_SENSOR_LEGACY_DRIVER    ENV_sht4x_driver
+#endif
+#ifndef ENV_SENSOR_LEGACY_TIMEO
+    #define ENV_SENSOR_LEGACY_TIMEO     (1000)  // ms, conversion and all of its retries
+#endif
+#ifndef ENV_SENSOR_LEGACY_DISPLAY_WINDOW
+    #define ENV_SENSOR_LEGACY_DISPLAY_WINDOW    (2 * ENV_POLICY_DISPLAY_MAX_INTV)   // ms since last start_convert()
+#endif
+
+/***************************************************************************
+ *  @internal
+ ***************************************************************************/
+static void ENV_legacy_callback(struct ENV_sensor_t *sensor, int err, void *arg);
+static void ENV_legacy_display_timeout(void *arg);
+
+// var
+static struct ENV_sensor_t env_legacy;
+static struct ENV_policy_t env_legacy_policy;
+static struct timeout_t env_legacy_display_timeo;
+static int env_legacy_err;
+static bool volatile env_legacy_fresh;  // a policy sample not yet recorded into history
+
+/***************************************************************************
+ *  @export
+ ***************************************************************************/
+int ENV_sensor_createfd(void *dev, uint16_t kbps)
+{
+    env_legacy_err = ENODATA;
+
+    if (0 != ENV_sensor_init(&env_legacy, &ENV_SENSOR_LEGACY_DRIVER, dev, kbps, 0))
+        return -1;
+
+    ENVH_init();
+    timeout_init(&env_legacy_display_timeo, ENV_SENSOR_LEGACY_DISPLAY_WINDOW, ENV_legacy_display_timeout, 0);
+
+    // background samples by the policy from now on: low precision, adaptive interval
+    ENV_policy_init(&env_legacy_policy, &env_legacy, ENV_legacy_callback, NULL);
+    return env_legacy.fd;
+}
+
+int ENV_sensor_start_convert(int fd)
+{
+    if (0 >= fd || fd != env_legacy.fd)
+        return ENODEV;
+
+    // caller reads for display: high precision, sampled now and then at least by ENV_POLICY_DISPLAY_MAX_INTV,
+    //  back to background sampling when no more reads for ENV_SENSOR_LEGACY_DISPLAY_WINDOW
+    timeout_stop(&env_legacy_display_timeo);
+    ENV_policy_set_displayed(&env_legacy_policy, true);
+    timeout_start(&env_legacy_display_timeo, NULL);
+    return 0;
+}
+
+int ENV_sensor_set_displayed(int fd, bool displayed)
+{
+    if (0 >= fd || fd != env_legacy.fd)
+        return ENODEV;
+
+    timeout_stop(&env_legacy_display_timeo);
+    ENV_policy_set_displayed(&env_legacy_policy, displayed);
+
+    if (displayed)
+        timeout_start(&env_legacy_display_timeo, NULL);
+    return 0;
+}
+
+int ENV_sensor_read(int fd, int16_t *tmpr, uint8_t *humidity)
+{
+    if (0 >= fd || fd != env_legacy.fd)
+        return ENODEV;
+
+    // blocking as before: a conversion in progress, and retries of the service
+    for (clock_t tick = clock(); ENV_sensor_is_busy(&env_legacy);)
+    {
+        if (ENV_SENSOR_LEGACY_TIMEO <= clock() - tick)
+            return ETIMEDOUT;
+        msleep(ENV_SENSOR_POLL_INTV);
+    }
+
+    if (0 == env_legacy_err)
+    {
+        *tmpr = env_legacy_policy.tmpr;
+        *humidity = env_legacy_policy.humidity;
+
+        // history saves files: recorded here in caller's thread, never by the timeout callback
+        if (env_legacy_fresh)
+        {
+            env_legacy_fresh = false;
+            ENVH_record(time(NULL), *tmpr, *humidity);
+        }
+    }
+    return env_legacy_err;
+}
+
+/***************************************************************************
+ *  @internal
+ ***************************************************************************/
+static void ENV_legacy_callback(struct ENV_sensor_t *sensor, int err, void *arg)
+{
+    (void)sensor;
+    (void)arg;
+
+    // NOTE: heater pulses never reach here, their biased results are dropped by the policy
+    env_legacy_err = err;
+    if (0 == err)
+        env_legacy_fresh = true;
+}
+
+static void ENV_legacy_display_timeout(void *arg)
+{
+    (void)arg;
+    ENV_policy_set_displayed(&env_legacy_policy, false);
+}
@@ -0,0 +1,118 @@
+#include <ultracore.h>
+#include <stdlib.h>
+
+#include "env_policy.h"
+
+#if ENV_POLICY_MAX_INTV < ENV_POLICY_DISPLAY_MAX_INTV || ENV_POLICY_DISPLAY_MAX_INTV < ENV_POLICY_MIN_INTV
+    #pragma GCC error "ENV_POLICY_MIN_INTV <= ENV_POLICY_DISPLAY_MAX_INTV <= ENV_POLICY_MAX_INTV"
+#endif
+
+/***************************************************************************
+ *  @internal
+ ***************************************************************************/
+static void ENV_policy_sample(struct ENV_policy_t *policy);
+static void ENV_policy_sensor_callback(struct ENV_sensor_t *sensor, int err, struct ENV_policy_t *policy);
+static void ENV_policy_schedule(struct ENV_policy_t *policy, uint32_t ms);
+
+/***************************************************************************
+ *  @export
+ ***************************************************************************/
+void ENV_policy_init(struct ENV_policy_t *policy, struct ENV_sensor_t *sensor,
+    ENV_sensor_callback_t callback, void *arg)
+{
+    policy->sensor = sensor;
+    policy->callback = callback;
+    policy->arg = arg;
+
+    policy->intv = ENV_POLICY_MIN_INTV;
+    policy->heater_tick = clock();
+    policy->valid = false;
+    policy->displayed = false;
+
+    timeout_init(&policy->timeo, policy->intv, (void *)ENV_policy_sample, 0);
+    ENV_policy_sample(policy);
+}
+
+void ENV_policy_set_displayed(struct ENV_policy_t *policy, bool displayed)
+{
+    if (displayed == policy->displayed)
+        return;
+
+    policy->displayed = displayed;
+
+    if (displayed)
+    {
+        policy->intv = MIN(policy->intv, ENV_POLICY_DISPLAY_MAX_INTV);
+
+        // a running conversion reschedules by itself
+        if (! ENV_sensor_is_busy(policy->sensor))
+        {
+            timeout_stop(&policy->timeo);
+            ENV_policy_sample(policy);
+        }
+    }
+}
+
+/***************************************************************************
+ *  @internal
+ ***************************************************************************/
+static void ENV_policy_sample(struct ENV_policy_t *policy)
+{
+    enum ENV_mode_t mode = policy->displayed ? ENV_POLICY_DISPLAY_MODE : ENV_POLICY_BACKGROUND_MODE;
+
+    if (policy->sensor->driver->has_heater && policy->valid &&
+        ENV_POLICY_HEATER_HUMIDITY <= policy->humidity &&
+        ENV_POLICY_HEATER_INTV <= clock() - policy->heater_tick)
+    {
+        mode = ENV_MODE_HEATER;
+    }
+
+    int err = ENV_sensor_start(policy->sensor, mode, (void *)ENV_policy_sensor_callback, policy);
+    if (0 != err)
+        ENV_policy_schedule(policy, ENV_POLICY_MIN_INTV);
+}
+
+static void ENV_policy_sensor_callback(struct ENV_sensor_t *sensor, int err, struct ENV_policy_t *policy)
+{
+    if (ENV_MODE_HEATER == sensor->mode)
+    {
+        // heated result: keep the last valid
+        sensor->tmpr = policy->tmpr;
+        sensor->humidity = policy->humidity;
+
+        policy->heater_tick = clock();
+        ENV_policy_schedule(policy, ENV_POLICY_HEATER_SETTLE);
+        return;
+    }
+
+    if (0 == err)
+    {
+        if (policy->valid)
+        {
+            int dt = abs(sensor->tmpr - policy->tmpr);
+            int dh = abs(sensor->humidity - policy->humidity);
+
+            if (ENV_POLICY_FAST_TMPR <= dt || ENV_POLICY_FAST_HUMIDITY <= dh)
+                policy->intv = MAX(ENV_POLICY_MIN_INTV, policy->intv / 2);
+            else if (ENV_POLICY_FAST_TMPR / 2 >= dt && ENV_POLICY_FAST_HUMIDITY / 2 >= dh)
+                policy->intv = MIN(ENV_POLICY_MAX_INTV, policy->intv * 2);
+        }
+
+        policy->tmpr = sensor->tmpr;
+        policy->humidity = sensor->humidity;
+        policy->valid = true;
+    }
+
+    if (policy->displayed)
+        policy->intv = MIN(policy->intv, ENV_POLICY_DISPLAY_MAX_INTV);
+
+    ENV_policy_schedule(policy, policy->intv);
+    policy->callback(sensor, err, policy->arg);
+}
+
+static void ENV_policy_schedule(struct ENV_policy_t *policy, uint32_t ms)
+{
+    timeout_stop(&policy->timeo);
+    timeout_update(&policy->timeo, ms);
+    timeout_start(&policy->timeo, policy);
+}
@@ -0,0 +1,90 @@
+#ifndef __ENV_POLICY_H
+#define __ENV_POLICY_H                  1
+
+#include <features.h>
+#include <ultracore/timeo.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "env.h"
+
+/***************************************************************************
+ *  environment sensor sampling policy
+ *
+ *      background samples are low precision, high precision while the value is displayed
+ *      sample interval halves by a fast change and doubles while stable,
+ *      between ENV_POLICY_MIN_INTV and ENV_POLICY_MAX_INTV (ENV_POLICY_DISPLAY_MAX_INTV displayed)
+ *
+ *      at high humidity a heater pulse is taken every ENV_POLICY_HEATER_INTV against creep,
+ *      its biased result is dropped and the next sample waits ENV_POLICY_HEATER_SETTLE
+***************************************************************************/
+#ifndef ENV_POLICY_MIN_INTV
+    #define ENV_POLICY_MIN_INTV         (5000)
+#endif
+#ifndef ENV_POLICY_MAX_INTV
+    #define ENV_POLICY_MAX_INTV         (120000)
+#endif
+#ifndef ENV_POLICY_DISPLAY_MAX_INTV
+    #define ENV_POLICY_DISPLAY_MAX_INTV (30000)
+#endif
+#ifndef ENV_POLICY_BACKGROUND_MODE
+    #define ENV_POLICY_BACKGROUND_MODE  ENV_MODE_LOW_PRECISION
+#endif
+#ifndef ENV_POLICY_DISPLAY_MODE
+    #define ENV_POLICY_DISPLAY_MODE     ENV_MODE_HIGH_PRECISION
+#endif
+
+// fast change: either of, stable: neither of half
+#ifndef ENV_POLICY_FAST_TMPR
+    #define ENV_POLICY_FAST_TMPR        (4)     // 0.1°C
+#endif
+#ifndef ENV_POLICY_FAST_HUMIDITY
+    #define ENV_POLICY_FAST_HUMIDITY    (2)     // %
+#endif
+
+#ifndef ENV_POLICY_HEATER_HUMIDITY
+    #define ENV_POLICY_HEATER_HUMIDITY  (80)    // %
+#endif
+#ifndef ENV_POLICY_HEATER_INTV
+    #define ENV_POLICY_HEATER_INTV      (300000)
+#endif
+#ifndef ENV_POLICY_HEATER_SETTLE
+    #define ENV_POLICY_HEATER_SETTLE    (10000)
+#endif
+
+    struct ENV_policy_t
+    {
+        struct ENV_sensor_t *sensor;
+        struct timeout_t timeo;
+
+        ENV_sensor_callback_t callback;
+        void *arg;
+
+        uint32_t intv;
+        clock_t heater_tick;
+
+        int16_t tmpr;                   // last valid sample
+        uint8_t humidity;
+        bytebool_t valid;
+        bytebool_t displayed;
+    };
+
+__BEGIN_DECLS
+    /**
+     *  ENV_policy_init()
+     *      start sampling sensor, callback() is called by every result but heater pulses
+     */
+extern __attribute__((nothrow, nonnull(1, 2, 3)))
+    void ENV_policy_init(struct ENV_policy_t *policy, struct ENV_sensor_t *sensor,
+        ENV_sensor_callback_t callback, void *arg);
+
+    /**
+     *  ENV_policy_set_displayed()
+     *      value is displayed by panel or app: high precision, a sample is taken immediately
+     */
+extern __attribute__((nothrow, nonnull))
+    void ENV_policy_set_displayed(struct ENV_policy_t *policy, bool displayed);
+
+__END_DECLS
+#endif
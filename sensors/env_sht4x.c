@@ -1,12 +1,10 @@
 #include <ultracore.h>
 
 #include <stdbool.h>
-#include <stropts.h>
-#include <gpio.h>
-#include <i2c.h>
 #include <hash/crc8.h>
 
 #include "env.h"
+#include "env_conv.h"
 
 /***************************************************************************
  *  @def
@@ -19,91 +17,65 @@
     #define SHT4X_MED_PRECISION_TIMEO   (5)
     #define SHT4X_LOW_PRECISION_TIMEO   (2)
 
+// heater 110mW 0.1s: datasheet limits heater duty to 10%, ENV_policy keeps far below
+#ifndef SHT4X_HEATER_CMD
+    #define SHT4X_HEATER_CMD            (0x24)
+    #define SHT4X_HEATER_TIMEO          (110)   // heating + high precision measurement
+#endif
+
 /***************************************************************************
  *  @internal
  ***************************************************************************/
+static int SHT4X_start_convert(struct ENV_sensor_t *sensor);
+static int SHT4X_read(struct ENV_sensor_t *sensor);
+
 static int write_command(int fd, uint8_t cmd);
 static int read_reponse(int fd, uint16_t *d1, uint16_t *d2);
 
-struct SHT4X_context
+/***************************************************************************
+ *  @export
+ ***************************************************************************/
+struct ENV_driver_t const ENV_sht4x_driver =
 {
-    clock_t tick;
-    uint32_t timeout;
-
-    int tmpr;
-    int uncropped_humidity;
+    .da = SHT4X_A_DA,
+    .io_timeo = 10,
+    .has_heater = true,
+    .start_convert = SHT4X_start_convert,
+    .read = SHT4X_read,
 };
-struct SHT4X_context context;
 
 /***************************************************************************
- *  @export
+ *  @internal
  ***************************************************************************/
-int ENV_sensor_createfd(void *i2c_dev, uint16_t kbps)
+static int SHT4X_start_convert(struct ENV_sensor_t *sensor)
 {
-    int fd = I2C_createfd(i2c_dev, SHT4X_A_DA, kbps, 0, 0);
+    static struct
     {
-        int timeout = 10;
-
-        ioctl(fd, OPT_RD_TIMEO, &timeout);
-        ioctl(fd, OPT_WR_TIMEO, &timeout);
-    }
-    return fd;
-}
-
-int ENV_sensor_start_convert(int fd)
-{
-    if (0 < fd)
+        uint8_t cmd;
+        uint16_t timeo;
+    } const modes[] =
     {
-        context.timeout = SHT4X_HIGH_PRECISION_TIMEO;
-        int retval = write_command(fd, 0xFD);
-
-        // context.timeout = SHT4X_MED_PRECISION_TIMEO;
-        // int retval = write_command(fd, 0xF6);
-
-        // context.timeout = SHT4X_LOW_PRECISION_TIMEO;
-        // int retval = write_command(fd, 0xE0);
-
-        // context.timeout = 100;        // heater 0.1s
-        // int retval = write_command(fd, 0x32);
-
-        if (0 == retval)
-            context.tick = clock();
-        else
-            NVIC_SystemReset();
-
-        return retval;
-    }
-    else
-        return -1;
+        [ENV_MODE_LOW_PRECISION]  = {0xE0, SHT4X_LOW_PRECISION_TIMEO},
+        [ENV_MODE_MED_PRECISION]  = {0xF6, SHT4X_MED_PRECISION_TIMEO},
+        [ENV_MODE_HIGH_PRECISION] = {0xFD, SHT4X_HIGH_PRECISION_TIMEO},
+        [ENV_MODE_HEATER]         = {SHT4X_HEATER_CMD, SHT4X_HEATER_TIMEO},
+    };
+    unsigned mode = MIN(sensor->mode, lengthof(modes) - 1);
+
+    sensor->conv_ms = modes[mode].timeo;
+    return write_command(sensor->fd, modes[mode].cmd);
 }
 
-int ENV_sensor_read(int fd, int16_t *tmpr, uint8_t *humidity)
+static int SHT4X_read(struct ENV_sensor_t *sensor)
 {
-    if (0 >= fd)
-        return __set_errno_neg(ENODEV);
-
     uint16_t d1 = 0, d2 = 0;
 
-    int retval = read_reponse(fd, &d1, &d2);
-    context.tick = 0;
-
+    int retval = read_reponse(sensor->fd, &d1, &d2);
     if (0 == retval)
     {
-        context.tmpr = (int16_t)(d1 * 1750 / 65535 - 450);
-        context.uncropped_humidity = d2 * 1250 / 65535 - 60;
-
-        if (context.uncropped_humidity < 0 || context.uncropped_humidity > 1000)
-        {
-            if (context.uncropped_humidity < 0)
-                context.uncropped_humidity = 0;
-            else if (context.uncropped_humidity > 1000)
-                context.uncropped_humidity = 1000;
-        }
+        sensor->tmpr = SHT4X_tmpr(d1);
+        sensor->humidity = SHT4X_humidity(d2);
     }
-
-    *tmpr = (int16_t)context.tmpr;
-    *humidity = (uint8_t)((context.uncropped_humidity + 5) / 10);
-
     return retval;
 }
 
@@ -119,30 +91,23 @@ static int read_reponse(int fd, uint16_t *d1, uint16_t *d2)
 {
     uint8_t buf[6];
 
-    if (context.tick)
-    {
-        uint32_t diff = clock() - context.tick;
-
-        if (diff < context.timeout)
-            msleep(context.timeout - diff);
-    }
-
+    // NOTE: SHT4x NACKs the read during conversion
     if (sizeof(buf) != read(fd, buf, sizeof(buf)))
-        return -1;
+        return EAGAIN;
 
     if (d1)
     {
          if (buf[2] == CRC8_hash(&buf[0], 2))
              *d1 = (uint16_t)(buf[0] << 8 | (buf[1]));
          else
-            return __set_errno_neg(EIO);
+            return EIO;
     }
     if (d2)
     {
         if (buf[5] == CRC8_hash(&buf[3], 2))
             *d2 = (uint16_t)(buf[3] << 8 | buf[4]);
         else
-            return __set_errno_neg(EIO);
+            return EIO;
     }
     return 0;
 }
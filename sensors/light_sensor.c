@@ -0,0 +1,90 @@
+#include <features.h>
+#include <stddef.h>
+
+#include "light_sensor.h"
+
+#if 100 <= LIGHT_SENSOR_HYST_UP || 100 <= LIGHT_SENSOR_HYST_DOWN
+    #pragma GCC error "hysteresis must be less than the band width"
+#endif
+
+/****************************************************************************
+ *  @internal
+ ****************************************************************************/
+static int LIGHT_SENSOR_band(struct LIGHT_SENSOR_t const *ls, int value)
+{
+    value = MAX(0, MIN(ls->max_value, value));
+    return MIN(LIGHT_SENSOR_BANDS - 1, value * LIGHT_SENSOR_BANDS / (ls->max_value + 1));
+}
+
+static int LIGHT_SENSOR_target(struct LIGHT_SENSOR_t const *ls, int value)
+{
+    int width = (ls->max_value + 1) / LIGHT_SENSOR_BANDS;
+    int band;
+
+    // beyond the edges by hysteresis, otherwise stays in posted band
+    band = LIGHT_SENSOR_band(ls, value - width * LIGHT_SENSOR_HYST_UP / 100);
+    if (band > ls->band)
+        return band;
+
+    band = LIGHT_SENSOR_band(ls, value + width * LIGHT_SENSOR_HYST_DOWN / 100);
+    if (band < ls->band)
+        return band;
+
+    return ls->band;
+}
+
+/****************************************************************************
+ *  @implements
+ ****************************************************************************/
+void LIGHT_SENSOR_init(struct LIGHT_SENSOR_t *ls, uint16_t max_value)
+{
+    ls->max_value = max_value;
+    ls->value = 0;
+    ls->acc = 0;
+    ls->cnt = 0;
+    ls->band = -1;
+    ls->pending = -1;
+    ls->pending_ts = 0;
+}
+
+int LIGHT_SENSOR_feed(struct LIGHT_SENSOR_t *ls, int raw, clock_t ts)
+{
+    ls->acc += (uint32_t)MAX(0, MIN(ls->max_value, raw));
+
+    if (LIGHT_SENSOR_DECIMATE > ++ ls->cnt)
+        return -1;
+
+    ls->value = (uint16_t)((ls->acc + LIGHT_SENSOR_DECIMATE / 2) / LIGHT_SENSOR_DECIMATE);
+    ls->acc = 0;
+    ls->cnt = 0;
+
+    if (-1 == ls->band)
+    {
+        ls->band = (int8_t)LIGHT_SENSOR_band(ls, ls->value);
+        return ls->band;
+    }
+
+    int band = LIGHT_SENSOR_target(ls, ls->value);
+    if (band == ls->band)
+    {
+        ls->pending = -1;
+        return -1;
+    }
+
+    // dwell restarts when the direction is reversed, a further band in the same direction keeps it
+    if (-1 == ls->pending || (band > ls->band) != (ls->pending > ls->band))
+        ls->pending_ts = ts;
+    ls->pending = (int8_t)band;
+
+    if (LIGHT_SENSOR_DWELL_MS > ts - ls->pending_ts)
+        return -1;
+
+    ls->band = ls->pending;
+    ls->pending = -1;
+    return ls->band;
+}
+
+int LIGHT_SENSOR_band_value(struct LIGHT_SENSOR_t const *ls, int band)
+{
+    return (2 * band + 1) * (ls->max_value + 1) / (2 * LIGHT_SENSOR_BANDS);
+}
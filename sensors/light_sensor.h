@@ -0,0 +1,81 @@
+#ifndef __SMARTCUCKOO_LIGHT_SENSOR_H
+#define __SMARTCUCKOO_LIGHT_SENSOR_H    1
+
+#include <features.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/***************************************************************************
+ *  ambient light level
+ *
+ *      raw samples are averaged by every LIGHT_SENSOR_DECIMATE into one filtered value,
+ *      the filtered value is quantized into LIGHT_SENSOR_BANDS bands
+ *
+ *      a band change needs the filtered value beyond the band edge by hysteresis,
+ *      brighter and darker are separated (percent of band width), and the new band
+ *      must hold for LIGHT_SENSOR_DWELL_MS before it is posted
+ *
+ *      tools/light_replay.py mirrors this filter to tune with recorded traces
+***************************************************************************/
+#ifndef LIGHT_SENSOR_SAMPLE_INTV
+    #define LIGHT_SENSOR_SAMPLE_INTV    (2000)  // ms, each one is a wakeup & ADC conversion
+#endif
+#ifndef LIGHT_SENSOR_DECIMATE
+    #define LIGHT_SENSOR_DECIMATE       (4)
+#endif
+#ifndef LIGHT_SENSOR_BANDS
+    #define LIGHT_SENSOR_BANDS          (16)
+#endif
+#ifndef LIGHT_SENSOR_HYST_UP
+    #define LIGHT_SENSOR_HYST_UP        (25)    // %, brighter
+#endif
+#ifndef LIGHT_SENSOR_HYST_DOWN
+    #define LIGHT_SENSOR_HYST_DOWN      (50)    // %, darker: shadows & flicker
+#endif
+#ifndef LIGHT_SENSOR_DWELL_MS
+    #define LIGHT_SENSOR_DWELL_MS       (4000)
+#endif
+
+    struct LIGHT_SENSOR_t
+    {
+        uint16_t max_value;
+        uint16_t value;                 // last filtered value
+
+        uint32_t acc;
+        uint8_t cnt;
+
+        int8_t band;                    // posted, -1 before first filtered value
+        int8_t pending;                 // band waiting for dwell, -1 none
+        clock_t pending_ts;
+    };
+
+__BEGIN_DECLS
+    /**
+     *  LIGHT_SENSOR_init()
+     *      max_value: raw samples are clamped
+     */
+extern __attribute__((nothrow, nonnull))
+    void LIGHT_SENSOR_init(struct LIGHT_SENSOR_t *ls, uint16_t max_value);
+
+    /**
+     *  LIGHT_SENSOR_feed()
+     *      feed a raw sample taken at ts, clock() in ms
+     *
+     *  @returns
+     *      the new band when it is changed, the first filtered value is posted immediately
+     *      -1 no change
+     */
+extern __attribute__((nothrow, nonnull))
+    int LIGHT_SENSOR_feed(struct LIGHT_SENSOR_t *ls, int raw, clock_t ts);
+
+    /**
+     *  LIGHT_SENSOR_band_value()
+     *      raw value at center of band
+     */
+extern __attribute__((nothrow, nonnull, pure))
+    int LIGHT_SENSOR_band_value(struct LIGHT_SENSOR_t const *ls, int band);
+
+__END_DECLS
+#endif
@@ -5,12 +5,33 @@
 #include "smartcuckoo.h"
 #include "ble.hpp"
 #include "flash.h"
+#include "checksum.h"
+#include "power.h"
+#include "diskio_trace.h"
+#include "noise_stream.h"
+#include "env_history.h"
 
 #if defined(PANEL_B) || defined(PANEL_C)
     #include "panel_private.h"
     #define PANEL_APPLICATION
 #endif
 
+/**
+ *  scan response is 31 bytes: manufacturer data & time TLV, then the remaining battery hours
+ *      or the panel sensors. TLV size follows the value type: hours as uint16_t is no larger than
+ *      the panel celsius TLV alone, so either set fits where the baseline panel set did
+ */
+#ifndef ADV_BATT_HOURS_TLV
+    #ifdef PANEL_APPLICATION
+        #define ADV_BATT_HOURS_TLV      (0)
+    #else
+        #define ADV_BATT_HOURS_TLV      (1)
+    #endif
+#endif
+#if ADV_BATT_HOURS_TLV && defined(PANEL_APPLICATION)
+    #error "no room for battery hours TLV with panel sensors TLVs in scan response"
+#endif
+
 /*****************************************************************************/
 /** @imports
 *****************************************************************************/
@@ -20,9 +41,15 @@ extern "C" int SHELL_ota(struct UCSH_env *env);         // shell_ota.c
 /** @internal
 *****************************************************************************/
 static int SHELL_batt(struct UCSH_env *env);
+static int SHELL_power(struct UCSH_env *env);
+static int SHELL_dtrace(struct UCSH_env *env);
 static int SHELL_locale(struct UCSH_env *env);
 static int SHELL_dfmt(struct UCSH_env *env);
 static int SHELL_hfmt(struct UCSH_env *env);
+#ifdef PANEL_APPLICATION
+static int SHELL_envh(struct UCSH_env *env);
+#endif
+static uint8_t *SHELL_hash_buffer(struct UCSH_env *env, size_t *bufsize);
 
 /// @var
 TUltraCorePeripheral BLE;
@@ -54,6 +81,11 @@ static void SHELL_register(void)
 
     UCSH_REGISTER("ota",        SHELL_ota);
     UCSH_REGISTER("batt",       SHELL_batt);
+    UCSH_REGISTER("power",      SHELL_power);
+    UCSH_REGISTER("dtrace",     SHELL_dtrace);
+#ifdef PANEL_APPLICATION
+    UCSH_REGISTER("envh",       SHELL_envh);
+#endif
 
     UCSH_REGISTER("rtcc",
         [](struct UCSH_env *env)
@@ -85,25 +117,62 @@ static void SHELL_register(void)
             if (-1 == fd)
                 return errno;
 
-            MD5_context_t *md5_ctx = (MD5_context_t *)&env->buf[64];
-            MD5_init(md5_ctx);
+            MD5_context_t md5_ctx;
+            MD5_init(&md5_ctx);
+
+            size_t bufsize;
+            uint8_t *buf = SHELL_hash_buffer(env, &bufsize);
 
             while (true)
             {
-                ssize_t len = read(fd, env->buf, 64);
+                ssize_t len = read(fd, buf, bufsize);
 
                 if (len > 0)
-                    MD5_update(md5_ctx, env->buf, (size_t)len);
+                    MD5_update(&md5_ctx, buf, (size_t)len);
                 else
                     break;
             }
-            MD5_t md5 = MD5_final(md5_ctx);
+            MD5_t md5 = MD5_final(&md5_ctx);
             close(fd);
 
             writeln(env->fd, env->buf, (size_t)MD5_sprintf(env->buf, &md5));
             return 0;
         });
 
+    UCSH_REGISTER("crc32",
+        [](struct UCSH_env *env)
+        {
+            if (2 != env->argc)
+                return EINVAL;
+
+            int fd = open(env->argv[1], O_RDONLY);
+            if (-1 == fd)
+                return errno;
+
+            uint32_t crc = CRC32_INIT;
+            uint32_t total = 0;
+
+            size_t bufsize;
+            uint8_t *buf = SHELL_hash_buffer(env, &bufsize);
+
+            while (true)
+            {
+                ssize_t len = read(fd, buf, bufsize);
+
+                if (len > 0)
+                {
+                    crc = CHECKSUM_crc32(crc, buf, (size_t)len);
+                    total += (uint32_t)len;
+                }
+                else
+                    break;
+            }
+            close(fd);
+
+            UCSH_printf(env, "%08lx %lu\n", (unsigned long)~crc, (unsigned long)total);
+            return 0;
+        });
+
     UCSH_REGISTER("vol",
         [](struct UCSH_env *env)
         {
@@ -170,6 +239,12 @@ static void SHELL_register(void)
                 UCSH_printf(env, "\tunused  : %u\n", SYSCON_get_heap_unused());
                 UCSH_printf(env, "\tfreed   : %u\n", freed);
             #endif
+
+            UCSH_puts(env, "shell pool\n");
+            UCSH_printf(env, "\tused    : %u/%u\n", BLE.ShellPoolUsed(), SHELL_ENV_POOL_SIZE);
+            UCSH_printf(env, "\tpeak    : %u\n", BLE.ShellPoolPeak());
+            UCSH_printf(env, "\trejected: %u\n", BLE.ShellPoolRejected());
+            UCSH_printf(env, "\tstack   : %u/%u\n", BLE.ShellStackPeak(), SHELL_STACK_SIZE);
             return 0;
         });
 
@@ -263,6 +338,15 @@ void PERIPHERAL_write_tlv(TMemStream &advs)
         advs.Write(&tlv, tlv.size());
     }
 
+#if ADV_BATT_HOURS_TLV
+    if (0 != PERIPHERAL_batt_minutes())
+    {
+        // remaining runtime in 0.1 hour
+        BluetoothTLV tlv(ATT_UNIT_HOUR, 1, (uint16_t)MIN(PERIPHERAL_batt_minutes() / 6, UINT16_MAX));
+        advs.Write(&tlv, tlv.size());
+    }
+#endif
+
     #ifdef PANEL_APPLICATION
     if (1)
     {
@@ -327,6 +411,13 @@ void UCSH_prompt_handle(struct UCSH_env *env)
 /*****************************************************************************/
 /** @internal
 *****************************************************************************/
+static uint8_t *SHELL_hash_buffer(struct UCSH_env *env, size_t *bufsize)
+{
+    // shell I/O buffer in whole sectors, up to CHECKSUM_BLOCK_SIZE: no heap allocation per command
+    *bufsize = MIN(CHECKSUM_BLOCK_SIZE, 512 <= env->bufsize ? env->bufsize & ~(size_t)511 : env->bufsize);
+    return (uint8_t *)env->buf;
+}
+
 static int SHELL_batt(struct UCSH_env *env)
 {
     if (3 == env->argc && 0 == strcasecmp("shift", env->argv[1]))
@@ -346,15 +437,214 @@ static int SHELL_batt(struct UCSH_env *env)
         shift = FLASH_get_batt_shift();
         UCSH_printf(env, "batt=%u shift: %d\n", batt, shift);
     }
+    else if (2 == env->argc && 0 == strcasecmp("est", env->argv[1]))
+    {
+        struct BATT_estimator_t const *est = PERIPHERAL_batt_estimator();
+        uint32_t minutes = PERIPHERAL_batt_minutes();
+
+        if (NULL == est)
+            return ENODEV;
+
+        UCSH_printf(env, "level=%u volt_level=%u\n", PERIPHERAL_batt_level(), BATT_mv_level(PERIPHERAL_batt_volt()));
+        UCSH_printf(env, "charge=%ld/%ld mAh\n", (long)(est->charge_uah / 1000), (long)(est->capacity_uah / 1000));
+        UCSH_printf(env, "loads=0x%02x led=%u load=%lu uA avg=%lu uA\n",
+            est->loads, est->led_percent, (unsigned long)est->load_ua, (unsigned long)est->avg_ua);
+        UCSH_printf(env, "remain=%lu:%02lu\n", (unsigned long)(minutes / 60), (unsigned long)(minutes % 60));
+    }
     else
     {
-        int batt  = PERIPHERAL_batt_ad_sync();
-        UCSH_printf(env, "batt=%u\n", BATT_mv_level(batt));
+        // parsed by the app: remaining time is of "batt est" only
+        UCSH_printf(env, "batt=%u\n", PERIPHERAL_batt_level());
     }
 
     return 0;
 }
 
+static int SHELL_power(struct UCSH_env *env)
+{
+    POWER_flush();
+
+    if (2 == env->argc && 0 == strcasecmp("reset", env->argv[1]))
+    {
+        POWER_reset();
+    }
+    else if (2 == env->argc && 0 == strcasecmp("hist", env->argv[1]))
+    {
+        // rolling history: awake seconds per cause for each of last POWER_HISTORY_HOURS
+        int pos = sprintf(env->buf, "hour");
+        for (unsigned cause = 0; cause <= POWER_CAUSE_COUNT; cause ++)
+            pos += sprintf(env->buf + pos, "\t%s", POWER_cause_name((enum POWER_cause_t)cause));
+        UCSH_printf(env, "%s\n", env->buf);
+
+        for (unsigned hours_ago = 0; hours_ago < POWER_HISTORY_HOURS; hours_ago ++)
+        {
+            pos = sprintf(env->buf, "-%uh", hours_ago);
+            for (unsigned cause = 0; cause <= POWER_CAUSE_COUNT; cause ++)
+            {
+                uint32_t ms = POWER_hourly_ms((enum POWER_cause_t)cause, hours_ago);
+                pos += sprintf(env->buf + pos, "\t%lu.%lu", (unsigned long)(ms / 1000), (unsigned long)(ms % 1000 / 100));
+            }
+            UCSH_printf(env, "%s\n", env->buf);
+        }
+    }
+    else if (1 == env->argc)
+    {
+        UCSH_printf(env, "cause\tcount\tseconds\n");
+
+        for (unsigned cause = 0; cause <= POWER_CAUSE_COUNT; cause ++)
+        {
+            struct POWER_total_t total;
+            POWER_total((enum POWER_cause_t)cause, &total);
+
+            UCSH_printf(env, "%s\t%lu\t%lu.%lu\n", POWER_cause_name((enum POWER_cause_t)cause),
+                (unsigned long)total.count, (unsigned long)(total.ms / 1000), (unsigned long)(total.ms % 1000 / 100));
+        }
+        UCSH_printf(env, "since\t-\t%lu\n", (unsigned long)(time(NULL) - POWER_since()));
+    }
+    else
+        return EINVAL;
+
+    return 0;
+}
+
+static int SHELL_dtrace(struct UCSH_env *env)
+{
+    if (2 == env->argc && 0 == strcasecmp("on", env->argv[1]))
+    {
+        DTRACE_clear();
+        DTRACE_enable(true);
+    }
+    else if (2 == env->argc && 0 == strcasecmp("off", env->argv[1]))
+    {
+        DTRACE_enable(false);
+    }
+    else if (2 == env->argc && 0 == strcasecmp("clear", env->argv[1]))
+    {
+        DTRACE_clear();
+    }
+    else if (2 == env->argc && 0 == strcasecmp("dump", env->argv[1]))
+    {
+        // replay by tools/diskio_sim.py
+        bool enabled = DTRACE_is_enabled();
+        DTRACE_enable(false);
+
+        UCSH_printf(env, "# lba count hit us tag\n");
+        for (unsigned idx = 0; idx < DTRACE_count(); idx ++)
+        {
+            struct DTRACE_entry_t const *entry = DTRACE_get(idx);
+
+            UCSH_printf(env, "%lu %u %u %lu %s\n", (unsigned long)entry->lba, entry->count, entry->hit,
+                (unsigned long)entry->us, DTRACE_tag_name((enum DTRACE_tag_t)entry->tag));
+        }
+        UCSH_printf(env, "# dropped %lu\n", (unsigned long)DTRACE_dropped());
+
+        DTRACE_enable(enabled);
+    }
+    else if (1 == env->argc)
+    {
+        unsigned hits = 0;
+        uint64_t us = 0;
+
+        for (unsigned idx = 0; idx < DTRACE_count(); idx ++)
+        {
+            struct DTRACE_entry_t const *entry = DTRACE_get(idx);
+
+            hits += entry->hit;
+            us += entry->us;
+        }
+        UCSH_printf(env, "dtrace %s: %u entries, %lu dropped, %u hits, avg %lu us\n",
+            DTRACE_is_enabled() ? "on" : "off", DTRACE_count(), (unsigned long)DTRACE_dropped(), hits,
+            (unsigned long)(0 == DTRACE_count() ? 0 : us / DTRACE_count()));
+
+        struct NOISE_STREAM_stat_t const *stat = NOISE_STREAM_stat();
+        UCSH_printf(env, "noise stream: %lu fills, %lu loops, %lu stalls, %lu seeks\n",
+            (unsigned long)stat->fills, (unsigned long)stat->loops, (unsigned long)stat->stalls,
+            (unsigned long)stat->seeks);
+    }
+    else
+        return EINVAL;
+
+    return 0;
+}
+
+#ifdef PANEL_APPLICATION
+static int SHELL_envh(struct UCSH_env *env)
+{
+    if (1 == env->argc)
+    {
+        UCSH_printf(env, "envh: %u blocks of %u, %u hours, %u days\n",
+            ENVH_block_count(), ENVH_BLOCK_SAMPLES,
+            ENVH_rollup_count(ENVH_SERIES_HOURS), ENVH_rollup_count(ENVH_SERIES_DAYS));
+    }
+    else if (2 == env->argc && 0 == strcasecmp("save", env->argv[1]))
+    {
+        return ENVH_save();
+    }
+    else if (2 == env->argc && 0 == strcasecmp("clear", env->argv[1]))
+    {
+        ENVH_clear();
+    }
+    else if (5 > env->argc)
+    {
+        // envh <samples|hours|days> [from] [to]: records by ts, decoded by tools/envh_decode.py
+        uint32_t from = 2 < env->argc ? strtoul(env->argv[2], NULL, 10) : 0;
+        uint32_t to = 3 < env->argc ? strtoul(env->argv[3], NULL, 10) : UINT32_MAX;
+        bool blocks = 0 == strcasecmp("samples", env->argv[1]);
+        enum ENVH_series_t series;
+
+        if (blocks)
+            series = ENVH_SERIES_HOURS;
+        else if (0 == strcasecmp("hours", env->argv[1]))
+            series = ENVH_SERIES_HOURS;
+        else if (0 == strcasecmp("days", env->argv[1]))
+            series = ENVH_SERIES_DAYS;
+        else
+            return EINVAL;
+
+        unsigned total = blocks ? ENVH_block_count() : ENVH_rollup_count(series);
+        unsigned first = total;
+        unsigned count = 0;
+
+        for (unsigned idx = 0; idx < total; idx ++)
+        {
+            uint32_t ts, last;
+
+            if (blocks)
+            {
+                struct ENVH_block_t const *blk = ENVH_block_get(idx);
+                ts = blk->ts;
+                last = blk->ts + (blk->count - 1U) * ENVH_SAMPLE_INTV;
+            }
+            else
+                ts = last = ENVH_rollup_get(series, idx)->ts;
+
+            if (from <= last && to >= ts)
+            {
+                if (total == first)
+                    first = idx;
+                count = idx - first + 1;
+            }
+        }
+
+        // text header, then count records in binary as is
+        size_t size = blocks ? sizeof(struct ENVH_block_t) : sizeof(struct ENVH_rollup_t);
+        UCSH_printf(env, "envh %s %u %u\n", env->argv[1], (unsigned)size, count);
+
+        for (unsigned idx = first; idx < first + count; idx ++)
+        {
+            if (blocks)
+                writebuf(env->fd, ENVH_block_get(idx), size);
+            else
+                writebuf(env->fd, ENVH_rollup_get(series, idx), size);
+        }
+    }
+    else
+        return EINVAL;
+
+    return 0;
+}
+#endif
+
 static void voice_avail_locales_callback(int id, char const *lcid,
     enum LOCALE_dfmt_t dfmt, enum LOCALE_hfmt_t hfmt,  char const *voice, void *arg, bool final)
 {
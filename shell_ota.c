@@ -1,10 +1,10 @@
 #include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
 #include <errno.h>
 
 #include <sh/ucsh.h>
 #include <fs/ultrafs.h>
-#include <hash/crc16.h>
 
 #include <pmu.h>
 #include <wdt.h>
@@ -12,6 +12,9 @@
 #include <gpio.h>
 #include <wdt.h>
 
+#include "checksum.h"
+#include "inflate.h"
+#include "delta.h"
 
 extern void PERIPHERAL_ota_init(void);
 
@@ -23,17 +26,61 @@ extern void PERIPHERAL_ota_init(void);
     #define OTA_download_complete()
 #endif
 
-int SHELL_ota(struct UCSH_env *env)
+#ifndef OTA_PACKET_BATCH
+    #define OTA_PACKET_BATCH            (16U)
+#endif
+
+/**
+ *  source image of delta patches: the running image, read as memory mapped flash
+ *      assumes the image is linked at the N32WB452 flash base, as every target here without
+ *      a bootloader. a target linked elsewhere must define OTA_DELTA_SOURCE_BASE by its config,
+ *      a wrong base writes nothing: DELTA_feed() verifies the source MD5 before the first byte
+ */
+#ifndef OTA_DELTA_SOURCE_BASE
+    #define OTA_DELTA_SOURCE_BASE       (0x08000000UL)
+#endif
+
+#ifndef OTA_DELTA_SOURCE_LIMIT
+    #define OTA_DELTA_SOURCE_LIMIT      (512U * 1024U)
+#endif
+
+struct OTA_packet
 {
-    struct OTA_packet
-    {
-        uint16_t Idx;
-        uint16_t crc;
-        uint8_t Payload[16];
-    };
+    uint16_t Idx;
+    uint16_t crc;
+    uint8_t Payload[16];
+};
+
+struct OTA_stream
+{
+    int fd;
+    int ota_fd;
+
+    uint16_t idx;
+    uint32_t remain;
+    uint32_t size;
+    uint32_t written;
+
+    struct DELTA_t *delta;
 
-    struct OTA_packet packet;
+    uint32_t packet_remain;
+    uint8_t batch_pos;
+    uint8_t batch_cnt;
+    struct OTA_packet batch[OTA_PACKET_BATCH];
+};
+
+static struct OTA_packet const *OTA_packet_next(struct OTA_stream *stream, int *err);
+static ssize_t OTA_stream_read(void *arg, uint8_t *buf, size_t count);
+static int OTA_stream_write(void *arg, uint8_t const *buf, size_t count);
+static int OTA_flash_write(void *arg, uint8_t const *buf, size_t count);
+
+int SHELL_ota(struct UCSH_env *env)
+{
+    struct OTA_stream stream;
+    struct OTA_packet const *packet;
     uint32_t size;
+    uint32_t zsize = 0;
+    uint32_t dsize = 0;
     uint16_t crc;
 
     int ota_fd;
@@ -55,6 +102,48 @@ int SHELL_ota(struct UCSH_env *env)
         crc  = (uint16_t)strtoul(param, &p, 10);
         if (0 == crc && 'x' == tolower(*p))
             crc = (uint16_t)strtoul(param, NULL, 16);
+
+        // optional: gzip compressed transfer size, s= & c= remains of decompressed image
+        param = CMD_paramvalue_byname("z", env->argc, env->argv);
+        if (param)
+        {
+            zsize = strtoul(param, &p, 10);
+            if (0 == zsize && 'x' == tolower(*p))
+                zsize = strtoul(param, NULL, 16);
+            if (0 == zsize)
+                return EINVAL;
+        }
+
+        // optional: delta patch size against the running image, patch can be gzip compressed as well
+        param = CMD_paramvalue_byname("d", env->argc, env->argv);
+        if (param)
+        {
+            dsize = strtoul(param, &p, 10);
+            if (0 == dsize && 'x' == tolower(*p))
+                dsize = strtoul(param, NULL, 16);
+            if (0 == dsize)
+                return EINVAL;
+        }
+    }
+
+    struct INFLATE_t *inflate = NULL;
+    uint8_t *window = NULL;
+    struct DELTA_t *delta = NULL;
+
+    if (0 != zsize)
+    {
+        inflate = malloc(sizeof(*inflate));
+        window = malloc(INFLATE_WINDOW_SIZE);
+    }
+    if (0 != dsize)
+        delta = malloc(sizeof(*delta));
+
+    if ((0 != zsize && (! inflate || ! window)) || (0 != dsize && ! delta))
+    {
+        free(inflate);
+        free(window);
+        free(delta);
+        return ENOMEM;
     }
 
     PMU_power_lock();
@@ -70,25 +159,83 @@ int SHELL_ota(struct UCSH_env *env)
     // response "ok"
     write(env->fd, "0: ok\n", 6);
 
-    uint32_t packet_count = ((size + sizeof(packet.Payload) - 1) & ~(sizeof(packet.Payload) - 1)) / sizeof(packet.Payload);
+    memset(&stream, 0, sizeof(stream));
+    stream.fd = env->fd;
+    stream.ota_fd = ota_fd;
+    stream.size = size;
+    stream.delta = delta;
 
-    for (unsigned idx = 0; idx < packet_count; idx ++)
+    if (0 != zsize || 0 != dsize)
     {
-        WDOG_feed();
+        int err;
 
-        if (sizeof(packet) != readbuf(env->fd, &packet, sizeof(packet)) || idx != packet.Idx)
-            goto ota_io_error;
+        stream.remain = 0 != zsize ? zsize : dsize;
+        stream.packet_remain = (stream.remain + sizeof(packet->Payload) - 1) / sizeof(packet->Payload);
 
-        // packet crc
-        uint16_t packet_crc = CRC16_hash(CRC16_XMODEM, packet.Payload, sizeof(packet.Payload));
-        if (packet_crc != packet.crc)
-            goto ota_crc_error;
+        if (delta)
+        {
+            DELTA_init(delta, OTA_flash_write, &stream,
+                (uint8_t const *)OTA_DELTA_SOURCE_BASE, OTA_DELTA_SOURCE_LIMIT);
+        }
+
+        if (inflate)
+        {
+            INFLATE_init(inflate, OTA_stream_read, OTA_stream_write, &stream, window);
+            err = INFLATE_gzip(inflate);
+
+            free(window);
+            free(inflate);
+        }
+        else
+        {
+            uint8_t buf[sizeof(packet->Payload)];
+            err = 0;
+
+            while (0 == err && 0 != stream.remain)
+            {
+                ssize_t len = OTA_stream_read(&stream, buf, sizeof(buf));
+
+                if (0 > len)
+                    err = (int)-len;
+                else
+                    err = OTA_stream_write(&stream, buf, (size_t)len);
+            }
+        }
 
-        // ota writing
-        if (sizeof(packet.Payload) != writebuf(ota_fd, packet.Payload, sizeof(packet.Payload)))
+        if (delta)
+        {
+            if (0 == err)
+                err = DELTA_finish(delta);
+            free(delta);
+        }
+
+        if (EIO == err)
             goto ota_io_error;
+        if (0 != err || size != stream.written)
+            goto ota_crc_error;
+    }
+    else
+    {
+        uint32_t packet_count = ((size + sizeof(packet->Payload) - 1) & ~(sizeof(packet->Payload) - 1)) / sizeof(packet->Payload);
+        stream.packet_remain = packet_count;
+
+        for (unsigned idx = 0; idx < packet_count; idx ++)
+        {
+            int err;
+
+            packet = OTA_packet_next(&stream, &err);
+            if (! packet)
+            {
+                if (EIO == err)
+                    goto ota_io_error;
+                else
+                    goto ota_crc_error;
+            }
 
-        OTA_downloading();
+            // ota writing
+            if (sizeof(packet->Payload) != writebuf(ota_fd, packet->Payload, sizeof(packet->Payload)))
+                goto ota_io_error;
+        }
     }
     OTA_download_complete();
 
@@ -121,3 +268,93 @@ ota_io_error:
     NVIC_SystemReset();
     return 0;
 }
+
+/****************************************************************************
+ *  @internal: compressed / delta stream
+ ****************************************************************************/
+static struct OTA_packet const *OTA_packet_next(struct OTA_stream *stream, int *err)
+{
+    // packets are read in batches, BLE / USB fd delivers them in larger chunks anyway
+    if (stream->batch_pos == stream->batch_cnt)
+    {
+        WDOG_feed();
+
+        unsigned cnt = MIN(OTA_PACKET_BATCH, stream->packet_remain);
+        if (0 == cnt || (ssize_t)(cnt * sizeof(struct OTA_packet)) !=
+            readbuf(stream->fd, stream->batch, cnt * sizeof(struct OTA_packet)))
+        {
+            *err = EIO;
+            return NULL;
+        }
+
+        stream->packet_remain -= cnt;
+        stream->batch_cnt = (uint8_t)cnt;
+        stream->batch_pos = 0;
+    }
+
+    struct OTA_packet const *packet = &stream->batch[stream->batch_pos ++];
+
+    if (stream->idx != packet->Idx)
+    {
+        *err = EIO;
+        return NULL;
+    }
+    // packet crc
+    if (packet->crc != CHECKSUM_crc16_xmodem(0, packet->Payload, sizeof(packet->Payload)))
+    {
+        *err = EINTEGRITY;
+        return NULL;
+    }
+
+    stream->idx ++;
+    OTA_downloading();
+
+    return packet;
+}
+
+static ssize_t OTA_stream_read(void *arg, uint8_t *buf, size_t count)
+{
+    struct OTA_stream *stream = arg;
+    struct OTA_packet const *packet;
+    int err;
+
+    if (0 == stream->remain)
+        return -EIO;
+    if (sizeof(packet->Payload) > count)
+        return -EINVAL;
+
+    packet = OTA_packet_next(stream, &err);
+    if (! packet)
+        return -err;
+
+    // last packet is padded
+    size_t len = MIN(sizeof(packet->Payload), stream->remain);
+    stream->remain -= len;
+
+    memcpy(buf, packet->Payload, len);
+    return (ssize_t)len;
+}
+
+static int OTA_stream_write(void *arg, uint8_t const *buf, size_t count)
+{
+    struct OTA_stream *stream = arg;
+
+    if (stream->delta)
+        return DELTA_feed(stream->delta, buf, count);
+    else
+        return OTA_flash_write(arg, buf, count);
+}
+
+static int OTA_flash_write(void *arg, uint8_t const *buf, size_t count)
+{
+    struct OTA_stream *stream = arg;
+
+    if (stream->written + count > stream->size)
+        return EINTEGRITY;
+
+    if (count != (size_t)writebuf(stream->ota_fd, buf, count))
+        return EIO;
+
+    stream->written += count;
+    return 0;
+}
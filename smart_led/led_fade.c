@@ -0,0 +1,120 @@
+#include <ultracore/timeo.h>
+#include <stddef.h>
+
+#include "led_fade.h"
+
+/****************************************************************************
+ *  @internal
+ ****************************************************************************/
+static void LED_FADE_intv_callback(void *arg);
+
+// var
+static struct timeout_t led_fade_intv;
+static struct LED_FADE_t *led_fades;
+
+static uint8_t LED_FADE_linear(uint16_t pos)
+{
+    uint32_t sq = (uint32_t)pos * pos >> 16;
+    return (uint8_t)((sq + 127) / 255);
+}
+
+static uint16_t LED_FADE_perceptual(uint8_t dim)
+{
+    // isqrt(dim * 255) << 8
+    uint32_t val = (uint32_t)dim * 255 << 16;
+    uint32_t root = 0;
+
+    for (uint32_t bit = 1UL << 30; 0 != bit; bit >>= 2)
+    {
+        if (val >= root + bit)
+        {
+            val -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+            root >>= 1;
+    }
+    return (uint16_t)root;
+}
+
+/****************************************************************************
+ *  @implements
+ ****************************************************************************/
+void LED_FADE_init(struct LED_FADE_t *fade, uint8_t dim, LED_FADE_apply_t apply)
+{
+    if (NULL == led_fades)
+        timeout_init(&led_fade_intv, LED_FADE_INTV, LED_FADE_intv_callback, TIMEOUT_FLAG_REPEAT);
+
+    fade->apply = apply;
+    fade->current = fade->target = dim;
+    fade->pos = fade->target_pos = LED_FADE_perceptual(dim);
+    fade->steps = 0;
+
+    fade->next = led_fades;
+    led_fades = fade;
+}
+
+void LED_FADE_to(struct LED_FADE_t *fade, uint8_t target, uint32_t ms)
+{
+    fade->target = target;
+    fade->target_pos = LED_FADE_perceptual(target);
+
+    if (0 == ms)
+    {
+        fade->pos = fade->target_pos;
+
+        if (target != fade->current)
+        {
+            fade->current = target;
+            fade->apply(fade, target);
+        }
+        return;
+    }
+
+    fade->steps = ms / LED_FADE_INTV + (0 != ms % LED_FADE_INTV ? 1 : 0);
+    timeout_start(&led_fade_intv, NULL);
+}
+
+void LED_FADE_stop(struct LED_FADE_t *fade)
+{
+    fade->target = fade->current;
+    fade->target_pos = fade->pos;
+}
+
+/****************************************************************************
+ *  @internal
+ ****************************************************************************/
+static void LED_FADE_intv_callback(void *arg)
+{
+    (void)arg;
+    bool running = false;
+
+    for (struct LED_FADE_t *fade = led_fades; NULL != fade; fade = fade->next)
+    {
+        if (fade->pos != fade->target_pos)
+        {
+            // distance left over steps left: the last step lands on target
+            uint32_t steps = 0 != fade->steps ? fade->steps -- : 1;
+
+            if (fade->pos < fade->target_pos)
+                fade->pos = (uint16_t)(fade->pos + (uint32_t)(fade->target_pos - fade->pos) / steps);
+            else
+                fade->pos = (uint16_t)(fade->pos - (uint32_t)(fade->pos - fade->target_pos) / steps);
+        }
+
+        // exact target dim at the end, perceptual rounding aside
+        uint8_t dim = fade->pos == fade->target_pos ? fade->target : LED_FADE_linear(fade->pos);
+
+        if (dim != fade->current)
+        {
+            fade->current = dim;
+            fade->apply(fade, dim);
+        }
+
+        if (LED_FADE_is_running(fade))
+            running = true;
+    }
+
+    if (! running)
+        timeout_stop(&led_fade_intv);
+}
@@ -0,0 +1,69 @@
+#ifndef SMART_LED_FADE_H
+#define SMART_LED_FADE_H                1
+
+#include <features.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/***************************************************************************
+ *  smart led brightness fade
+ *
+ *      every fade owns current & target dim of a chain, a shared repeating timeout
+ *      steps all running fades by LED_FADE_INTV and stops when all targets are reached
+ *
+ *      steps are linear in perceptual space: dim = L * L / 255 (gamma 2),
+ *      so a fade does not rush through the dark end
+ *
+ *      each step moves the perceptual distance left over the steps left, fractions of 1/256 L
+ *      are carried to later steps: any ms up to UINT32_MAX ends exactly on its last step
+***************************************************************************/
+#ifndef LED_FADE_INTV
+    #define LED_FADE_INTV               (20)    // ms, 50 steps per second
+#endif
+
+    struct LED_FADE_t;
+    typedef void (*LED_FADE_apply_t)(struct LED_FADE_t *fade, uint8_t dim);
+
+    struct LED_FADE_t
+    {
+        struct LED_FADE_t *next;
+        LED_FADE_apply_t apply;
+
+        uint8_t current;                // linear dim applied
+        uint8_t target;
+        uint16_t pos;                   // perceptual position, L << 8
+        uint16_t target_pos;
+        uint32_t steps;                 // LED_FADE_INTV left
+    };
+
+__BEGIN_DECLS
+    /**
+     *  LED_FADE_init()
+     *      register fade at dim, apply() is called from the timeout callback for every changed dim
+     */
+extern __attribute__((nothrow, nonnull))
+    void LED_FADE_init(struct LED_FADE_t *fade, uint8_t dim, LED_FADE_apply_t apply);
+
+    /**
+     *  LED_FADE_to()
+     *      fade to target dim in ms rounded up to LED_FADE_INTV, 0 applies immediately
+     */
+extern __attribute__((nothrow, nonnull))
+    void LED_FADE_to(struct LED_FADE_t *fade, uint8_t target, uint32_t ms);
+
+    /**
+     *  LED_FADE_stop()
+     *      hold current dim
+     */
+extern __attribute__((nothrow, nonnull))
+    void LED_FADE_stop(struct LED_FADE_t *fade);
+
+static inline
+    bool LED_FADE_is_running(struct LED_FADE_t const *fade)
+    {
+        return fade->pos != fade->target_pos;
+    }
+
+__END_DECLS
+#endif
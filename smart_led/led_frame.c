@@ -0,0 +1,81 @@
+#include <stddef.h>
+
+#include "led_frame.h"
+
+#define LED_FRAME_ON                    (1U << 31)
+
+static void LED_FRAME_diff(struct LED_FRAME_t *frame, uint8_t dim, enum SMART_LED_color_t color,
+    enum SMART_LED_color_t const *colors, uint32_t mask)
+{
+    unsigned prefix = 0;
+
+    for (unsigned i = 0; i < frame->count; i ++)
+    {
+        uint32_t led = 0;
+
+        if (32 > i && ((1UL << i) & mask))
+            led = LED_FRAME_ON | (uint32_t)dim << 16 | (uint32_t)(colors ? colors[i] : color);
+
+        if (led != frame->sent[i])
+        {
+            frame->sent[i] = led;
+            prefix = i + 1;
+        }
+    }
+
+    if (0 != prefix)
+    {
+        // a later update before commit may touch fewer LEDs, keep the longest
+        frame->prefix = (uint8_t)MAX(frame->prefix, prefix);
+        frame->dim = dim;
+        frame->color = color;
+        frame->colors = colors;
+        frame->mask = mask;
+    }
+}
+
+void LED_FRAME_update(struct LED_FRAME_t *frame, uint8_t dim, enum SMART_LED_color_t color, uint32_t mask)
+{
+    LED_FRAME_diff(frame, dim, color, NULL, mask);
+}
+
+void LED_FRAME_update_color(struct LED_FRAME_t *frame, uint8_t dim, enum SMART_LED_color_t const *colors,
+    uint32_t mask)
+{
+    LED_FRAME_diff(frame, dim, 0, colors, mask);
+}
+
+void LED_FRAME_invalidate(struct LED_FRAME_t *frame)
+{
+    // no valid frame has a LED on without LED_FRAME_ON
+    for (unsigned i = 0; i < frame->count; i ++)
+        frame->sent[i] = ~LED_FRAME_ON;
+}
+
+unsigned LED_FRAME_commit(struct LED_FRAME_t *const frames[], unsigned count)
+{
+    unsigned sent = 0;
+
+    for (unsigned idx = 0; idx < count; idx ++)
+    {
+        struct LED_FRAME_t *frame = frames[idx];
+        if (0 == frame->prefix)
+            continue;
+
+    #if LED_FRAME_PARTIAL
+        struct SMART_LED_attr_t attr = *frame->attr;
+        attr.count = frame->prefix;
+    #else
+        struct SMART_LED_attr_t const attr = *frame->attr;
+    #endif
+
+        if (frame->colors)
+            SMART_LED_update_color(&attr, frame->dim, frame->colors, frame->mask);
+        else
+            SMART_LED_update(&attr, frame->dim, frame->color, frame->mask);
+
+        frame->prefix = 0;
+        sent ++;
+    }
+    return sent;
+}
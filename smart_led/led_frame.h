@@ -0,0 +1,70 @@
+#ifndef SMART_LED_FRAME_H
+#define SMART_LED_FRAME_H               1
+
+#include <features.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <hw/smart_led.h>
+
+/***************************************************************************
+ *  smart led frame diff
+ *
+ *      keeps the last frame sent per chain: per LED 0 when off, or dim & color when on
+ *      an update only marks the chain pending when the frame differs, LED_FRAME_commit()
+ *      clocks out all pending chains back to back, each up to its last changed LED:
+ *      WS2812B LEDs behind a shorter transfer keep their latched color
+***************************************************************************/
+#ifndef LED_FRAME_PARTIAL
+    #define LED_FRAME_PARTIAL           (1)     // clock out changed prefix only, 0 sends whole chain
+#endif
+
+    struct LED_FRAME_t
+    {
+        struct SMART_LED_attr_t const *attr;
+        uint32_t *sent;
+        uint8_t count;
+
+        uint8_t prefix;                 // LEDs to clock out, 0 when nothing is pending
+        uint8_t dim;
+        enum SMART_LED_color_t color;
+        enum SMART_LED_color_t const *colors;
+        uint32_t mask;
+    };
+
+    #define LED_FRAME_INITIALIZER(ATTR, SENT)   \
+        {.attr = (ATTR), .sent = (SENT), .count = lengthof(SENT), .prefix = 0}
+
+__BEGIN_DECLS
+    /**
+     *  LED_FRAME_update()
+     *      same as SMART_LED_update(), but only marks the chain pending when frame was changed
+     *
+     *  LED_FRAME_update_color()
+     *      same as SMART_LED_update_color(), colors[] is read again by LED_FRAME_commit()
+     */
+extern __attribute__((nothrow, nonnull))
+    void LED_FRAME_update(struct LED_FRAME_t *frame, uint8_t dim, enum SMART_LED_color_t color, uint32_t mask);
+extern __attribute__((nothrow, nonnull))
+    void LED_FRAME_update_color(struct LED_FRAME_t *frame, uint8_t dim, enum SMART_LED_color_t const *colors,
+        uint32_t mask);
+
+    /**
+     *  LED_FRAME_invalidate()
+     *      chain was powered off or written directly, next update sends the whole frame
+     */
+extern __attribute__((nothrow, nonnull))
+    void LED_FRAME_invalidate(struct LED_FRAME_t *frame);
+
+    /**
+     *  LED_FRAME_commit()
+     *      clock out pending chains in one refresh
+     *
+     *  @returns
+     *      number of chains sent
+     */
+extern __attribute__((nothrow, nonnull))
+    unsigned LED_FRAME_commit(struct LED_FRAME_t *const frames[], unsigned count);
+
+__END_DECLS
+#endif
@@ -1,17 +1,36 @@
 #include "led_time.h"
 
-static uint8_t const SMART_LED_digit_mapping[10] =
+#define SMART_LED_SEG_0                 (1U << 0 | 1U << 1 | 1U << 2 | 1U << 3 | 1U << 4 | 1U << 5)
+#define SMART_LED_SEG_1                 (1U << 1 | 1U << 2)
+#define SMART_LED_SEG_2                 (1U << 0 | 1U << 1 | 1U << 6 | 1U << 4 | 1U << 3)
+#define SMART_LED_SEG_3                 (1U << 0 | 1U << 1 | 1U << 6 | 1U << 2 | 1U << 3)
+#define SMART_LED_SEG_4                 (1U << 5 | 1U << 6 | 1U << 1 | 1U << 2)
+#define SMART_LED_SEG_5                 (1U << 0 | 1U << 5 | 1U << 6 | 1U << 2 | 1U << 3)
+#define SMART_LED_SEG_6                 (1U << 0 | 1U << 5 | 1U << 4 | 1U << 3 | 1U << 2 | 1U << 6)
+#define SMART_LED_SEG_7                 (1U << 0 | 1U << 1 | 1U << 2)
+#define SMART_LED_SEG_8                 (0x7FU)
+#define SMART_LED_SEG_9                 (1U << 0 | 1U << 5 | 1U << 6 | 1U << 1 | 1U << 2 | 1U << 3)
+
+#define SMART_LED_SEG(d)                \
+    (0 == (d) ? SMART_LED_SEG_0 : 1 == (d) ? SMART_LED_SEG_1 : 2 == (d) ? SMART_LED_SEG_2 : \
+     3 == (d) ? SMART_LED_SEG_3 : 4 == (d) ? SMART_LED_SEG_4 : 5 == (d) ? SMART_LED_SEG_5 : \
+     6 == (d) ? SMART_LED_SEG_6 : 7 == (d) ? SMART_LED_SEG_7 : 8 == (d) ? SMART_LED_SEG_8 : SMART_LED_SEG_9)
+
+// tens digit at bit 0, ones digit at bit 7: same layout for hour & minute part
+#define SMART_LED_PAIR(t, o)            ((uint16_t)(SMART_LED_SEG(t) | SMART_LED_SEG(o) << 7))
+#define SMART_LED_PAIR_ROW(t)           \
+    SMART_LED_PAIR(t, 0), SMART_LED_PAIR(t, 1), SMART_LED_PAIR(t, 2), SMART_LED_PAIR(t, 3), \
+    SMART_LED_PAIR(t, 4), SMART_LED_PAIR(t, 5), SMART_LED_PAIR(t, 6), SMART_LED_PAIR(t, 7), \
+    SMART_LED_PAIR(t, 8), SMART_LED_PAIR(t, 9)
+
+#define SMART_LED_PAIR_TENS             (0x7FU)
+
+// 00 ~ 99 with leading zero, blank tens by masking out SMART_LED_PAIR_TENS
+static uint16_t const SMART_LED_pair_mapping[100] =
 {
-    /* 0 */ 1U << 0 | 1U << 1 | 1U << 2 | 1U << 3 | 1U << 4 | 1U << 5,
-    /* 1 */ 1U << 1 | 1U << 2,
-    /* 2 */ 1U << 0 | 1U << 1 | 1U << 6 | 1U << 6 | 1U << 4 | 1U << 3,
-    /* 3 */ 1U << 0 | 1U << 1 | 1U << 6 | 1U << 2 | 1U << 3,
-    /* 4 */ 1U << 5 | 1U << 6 | 1U << 1 | 1U << 2,
-    /* 5 */ 1U << 0 | 1U << 5 | 1U << 6 | 1U << 2 | 1U << 3,
-    /* 6 */ 1U << 0 | 1U << 5 | 1U << 4 | 1U << 3 | 1U << 2 | 1U << 6,
-    /* 7 */ 1U << 0 | 1U << 1 | 1U << 2,
-    /* 8 */ 0x7FU,
-    /* 9 */ 1U << 0 | 1U << 5 | 1U << 6 | 1U << 1 | 1U << 2 | 1U << 3,
+    SMART_LED_PAIR_ROW(0), SMART_LED_PAIR_ROW(1), SMART_LED_PAIR_ROW(2), SMART_LED_PAIR_ROW(3),
+    SMART_LED_PAIR_ROW(4), SMART_LED_PAIR_ROW(5), SMART_LED_PAIR_ROW(6), SMART_LED_PAIR_ROW(7),
+    SMART_LED_PAIR_ROW(8), SMART_LED_PAIR_ROW(9),
 };
 
 uint32_t SMART_LED_time_mask(time_t const ts)
@@ -21,48 +40,37 @@ uint32_t SMART_LED_time_mask(time_t const ts)
 
 uint32_t SMART_LED_time_mask_tm(struct tm const *dt)
 {
-    uint32_t mask = SMART_LED_time_mask_digit(dt->tm_hour * 100 + dt->tm_min, true);
-    mask |= 0x03 << 14;
-    return mask;
+    return SMART_LED_time_mask_hm((unsigned)dt->tm_hour, (unsigned)dt->tm_min, true) | SMART_LED_TIME_MASK_IND;
 }
 
-uint32_t SMART_LED_time_mask_digit(int digit, bool leading_zero)
+uint32_t SMART_LED_time_mask_hm(unsigned hour, unsigned minute, bool leading_zero)
 {
-    uint32_t mask = 0;
+    uint32_t mask = SMART_LED_pair_mapping[hour % 100];
 
-    if (1)  // minute part
-    {
-        mask |= (uint64_t)SMART_LED_digit_mapping[digit % 10];
-        digit /= 10;
+    if (! leading_zero && 10 > hour)
+        mask &= ~SMART_LED_PAIR_TENS;
 
-        mask <<= 7;
-        if (leading_zero || 0 != digit)
-        {
-            mask |= (uint64_t)SMART_LED_digit_mapping[digit % 10];
-            digit /= 10;
-        }
-    }
+    return mask | (uint32_t)SMART_LED_pair_mapping[minute % 100] << SMART_LED_TIME_SHIFT_MINUTE;
+}
+
+uint32_t SMART_LED_time_mask_digit(int digit, bool leading_zero)
+{
+    unsigned val = (unsigned)digit;
 
-    if (1)  // indicator part
+    // digits above 9999 are cut off, the remaining 4 digits are all significant
+    if (9999 < val)
     {
-        mask <<= 2;
+        val %= 10000;
+        leading_zero = true;
     }
 
-    if (1) // hour part
-    {
-        mask <<= 7;
-        if (leading_zero || 0 != digit)
-        {
-            mask |= (uint64_t)SMART_LED_digit_mapping[digit % 10];
-            digit /= 10;
-        }
+    if (leading_zero || 100 <= val)
+        return SMART_LED_time_mask_hm(val / 100, val % 100, leading_zero);
 
-        mask <<= 7;
-        if (leading_zero || 0 != digit)
-        {
-            mask |= (uint64_t)SMART_LED_digit_mapping[digit % 10];
-            digit /= 10;
-        }
-    }
-    return mask;
+    // hour part blank, minute tens blank below 10
+    uint32_t mask = SMART_LED_pair_mapping[val];
+    if (10 > val)
+        mask &= ~SMART_LED_PAIR_TENS;
+
+    return mask << SMART_LED_TIME_SHIFT_MINUTE;
 }
@@ -33,6 +33,14 @@ __BEGIN_DECLS
 extern __attribute__((nothrow))
     uint32_t SMART_LED_time_mask_digit(int digit, bool leading_zero);
 
+    /**
+     *  SMART_LED_time_mask_hm()
+     *      table lookup of hour & minute part, without leading zero the hour tens is blank below 10
+     *      24h and 12h display share the table: hour 0 ~ 23 / 1 ~ 12
+    */
+extern __attribute__((nothrow, pure))
+    uint32_t SMART_LED_time_mask_hm(unsigned hour, unsigned minute, bool leading_zero);
+
     /**
      *  SMART_LED_time_mask()
     */
@@ -40,6 +40,8 @@
 
 #include "N32X45X_config.h"
 #include "PERIPHERAL_config.h"
+// board values of battery.h
+#include "battery.h"
 
 /***************************************************************************
  *  @def: global consts
@@ -129,13 +131,50 @@ extern __attribute__((nothrow))
 extern __attribute__((nothrow))
     uint8_t PERIPHERAL_sync_id(void);
 
+    /**
+     *  PERIPHERAL_batt_schedule()
+     *      start a battery conversion when the adaptive sampling interval elapsed, never blocks
+     *
+     *  PERIPHERAL_batt_volt()
+     *      cached & filtered battery mV, compensated for playback sag
+     *
+     *  PERIPHERAL_batt_ad_sync()
+     *      start a conversion & wait it up to BATT_AD_SYNC_TIMEOUT, unfiltered mV for calibration,
+     *      0 when timed out
+     */
 extern __attribute__((nothrow))
     void PERIPHERAL_batt_ad_start(void);
 extern __attribute__((nothrow))
     uint16_t PERIPHERAL_batt_ad_sync(void);
+extern __attribute__((nothrow))
+    void PERIPHERAL_batt_schedule(void);
 extern __attribute__((nothrow))
     uint16_t PERIPHERAL_batt_volt(void);
 
+    /**
+     *  PERIPHERAL_batt_load()
+     *      enable / disable loads not sampled by PERIPHERAL_batt_schedule(): BATT_LOAD_BLE
+     *
+     *  PERIPHERAL_batt_led_percent()
+     *      weak, LED brightness 0~100 for current model, 0 when LED is off
+     *
+     *  PERIPHERAL_batt_level()
+     *      estimated remaining 0~100%
+     *
+     *  PERIPHERAL_batt_minutes()
+     *      predicted runtime in minutes, 0 when unknown
+     */
+extern __attribute__((nothrow))
+    void PERIPHERAL_batt_load(unsigned loads, bool en);
+extern __attribute__((nothrow))
+    uint8_t PERIPHERAL_batt_led_percent(void);
+extern __attribute__((nothrow))
+    uint8_t PERIPHERAL_batt_level(void);
+extern __attribute__((nothrow))
+    uint32_t PERIPHERAL_batt_minutes(void);
+extern __attribute__((nothrow))
+    struct BATT_estimator_t const *PERIPHERAL_batt_estimator(void);
+
 extern __attribute__((nothrow))
     void PERIPHERAL_adv_start(void);
 extern __attribute__((nothrow))
@@ -1,4 +1,11 @@
 #include "smartcuckoo.h"
+#include "button.h"
+#include "ui_fsm.h"
+#include "ui_setting.h"
+#include "power.h"
+#include "audio_pm.h"
+
+#include "talking_button_ui.h"
 
 /****************************************************************************
  *  @def
@@ -7,25 +14,16 @@
 #define MQUEUE_PAYLOAD_SIZE             (8)
 #define MQUEUE_LENGTH                   (8)
 
-enum talking_button_message_t
-{
-    MSG_VOICE_BUTTON            = 1,
-    MSG_SETTING_BUTTON,
-
-    MSG_ALARM_SW,
-    MSG_SETTING_TIMEOUT,
-};
-
 struct talking_button_runtime_t
 {
     int mqd;
     clock_t voice_last_tick;
-    time_t batt_last_ts;
 
+    struct BUTTON_engine_t buttons;
+    struct UI_fsm_t ui;
     timeout_t setting_timeo;
     timeout_t alarm_sw_timeo;
 
-    bool setting;
     bool setting_is_modified;
     bool setting_alarm_is_modified;
 
@@ -37,14 +35,21 @@ struct talking_button_runtime_t
  *  @private
  ****************************************************************************/
 static __attribute__((noreturn)) void *MSG_dispatch_thread(struct talking_button_runtime_t *runtime);
-static void MSG_alive(struct talking_button_runtime_t *runtime);
 
 static void GPIO_button_callback(uint32_t pins, struct talking_button_runtime_t *runtime);
+static uint32_t GPIO_button_scan(struct talking_button_runtime_t *runtime);
 static void setting_timeout_callback(void *arg);
 static void alaramsw_timeout_callback(void *arg);
 
 // var
 static struct talking_button_runtime_t talking_button = {0};
+
+static struct BUTTON_t const talking_buttons[] =
+{
+    {.id = MSG_VOICE_BUTTON},
+    {.id = MSG_SETTING_BUTTON},
+};
+
 __THREAD_STACK static uint32_t talking_button_stack[1280 / sizeof(uint32_t)];
 
 /****************************************************************************
@@ -70,7 +75,6 @@ void PERIPHERAL_init(void)
     timeout_init(&talking_button.alarm_sw_timeo, 50, alaramsw_timeout_callback, 0);
 
     talking_button.voice_last_tick = (clock_t)-SETTING_TIMEOUT;
-    talking_button.batt_last_ts = time(NULL);
 
     // load settings
     if (0 != NVM_get(NVM_SETTING, sizeof(smartcuckoo), &smartcuckoo))
@@ -90,14 +94,19 @@ void PERIPHERAL_init(void)
 
     smartcuckoo.voice_sel_id = VOICE_init(smartcuckoo.voice_sel_id, &smartcuckoo.locale);
 
-    GPIO_intr_enable(PIN_VOICE_BUTTON, TRIG_BY_FALLING_EDGE,
+    MQUEUE_INIT(&talking_button.mqd, MQUEUE_PAYLOAD_SIZE, MQUEUE_LENGTH);
+    UI_FSM_init(&talking_button.ui, talking_button_ui, lengthof(talking_button_ui), TALKING_BUTTON_UI_IDLE,
+        &talking_button);
+    BUTTON_engine_init(&talking_button.buttons, talking_button.mqd, talking_buttons, lengthof(talking_buttons),
+        BUTTON_SCAN_INTV, (void *)GPIO_button_scan, NULL, &talking_button);
+
+    GPIO_intr_enable(PIN_VOICE_BUTTON, TRIG_BY_BOTH_EDGE,
         (void *)GPIO_button_callback, &talking_button);
-    GPIO_intr_enable(PIN_SETTING_BUTTON, TRIG_BY_FALLING_EDGE,
+    GPIO_intr_enable(PIN_SETTING_BUTTON, TRIG_BY_BOTH_EDGE,
         (void *)GPIO_button_callback, &talking_button);
     GPIO_intr_enable(PIN_ALARM_SW, TRIG_BY_BOTH_EDGE,
         (void *)GPIO_button_callback, &talking_button);
 
-    MQUEUE_INIT(&talking_button.mqd, MQUEUE_PAYLOAD_SIZE, MQUEUE_LENGTH);
     if (true)
     {
         uint32_t timeout = MQUEUE_ALIVE_INTV;
@@ -111,7 +120,7 @@ void PERIPHERAL_init(void)
         pthread_create(&id, &attr, (void *)MSG_dispatch_thread, &talking_button);
         pthread_attr_destroy(&attr);
 
-        MSG_alive(&talking_button);
+        UI_FSM_dispatch(&talking_button.ui, MSG_ALIVE);
     }
 
     if (1)
@@ -147,10 +156,12 @@ void PERIPHERAL_init(void)
  ****************************************************************************/
 void mplayer_idle_callback(void)
 {
-    if (talking_button.setting)
+    if (UI_FSM_is_state(&talking_button.ui, TALKING_BUTTON_UI_SETTING))
         timeout_start(&talking_button.setting_timeo, NULL);
     else
         CLOCK_schedule();
+
+    AUDIO_PM_idle();
 }
 
 /****************************************************************************
@@ -158,17 +169,31 @@ void mplayer_idle_callback(void)
  ****************************************************************************/
 static void GPIO_button_callback(uint32_t pins, struct talking_button_runtime_t *runtime)
 {
-    timeout_stop(&talking_button.setting_timeo);
+    // buttons of both edges: a release keeps the setting timeout running
+    if (0 == ((PIN_SETTING_BUTTON | PIN_VOICE_BUTTON) & pins) || 0 != GPIO_button_scan(runtime))
+        timeout_stop(&talking_button.setting_timeo);
 
-    if (PIN_SETTING_BUTTON == (PIN_SETTING_BUTTON & pins))
-        mqueue_postv(runtime->mqd, MSG_SETTING_BUTTON, 0, 0);
-    if (PIN_VOICE_BUTTON == (PIN_VOICE_BUTTON & pins))
-        mqueue_postv(runtime->mqd, MSG_VOICE_BUTTON, 0, 0);
+    if (0 != ((PIN_SETTING_BUTTON | PIN_VOICE_BUTTON) & pins))
+        BUTTON_trigger(&runtime->buttons);
 
     if (PIN_ALARM_SW == (PIN_ALARM_SW & pins))
         timeout_start(&talking_button.alarm_sw_timeo, (void *)1);
 }
 
+static uint32_t GPIO_button_scan(struct talking_button_runtime_t *runtime)
+{
+    (void)runtime;
+    uint32_t mask = 0;
+
+    // same order as talking_buttons[]
+    if (0 == GPIO_peek(PIN_VOICE_BUTTON))
+        mask |= 1U << 0;
+    if (0 == GPIO_peek(PIN_SETTING_BUTTON))
+        mask |= 1U << 1;
+
+    return mask;
+}
+
 static void setting_timeout_callback(void *arg)
 {
     ARG_UNUSED(arg);
@@ -194,261 +219,208 @@ static void alaramsw_timeout_callback(void *arg)
     }
 }
 
-static void MSG_alive(struct talking_button_runtime_t *runtime)
+/****************************************************************************
+ *  @private: talking_button_ui[] guards & actions
+ ****************************************************************************/
+static void BUTTON_begin(void)
 {
-    // LOG_debug("alive");
-    if (BATT_EMPTY_MV > PERIPHERAL_batt_volt())
-    {
-        // trigger ad batery everytime, no other actions
-        runtime->batt_last_ts = time(NULL);
-        PERIPHERAL_batt_ad_start();
-    }
-    else
-    {
-        if (! runtime->setting)
-            CLOCK_schedule();
+    POWER_lock(POWER_CAUSE_BUTTON);
+    mplayer_playlist_clear();
 
-        if (BATT_AD_INTV_SECONDS < CLOCK_get_timestamp() - runtime->batt_last_ts)
-        {
-            runtime->batt_last_ts = CLOCK_get_timestamp();
-            PERIPHERAL_batt_ad_start();
-        }
-    }
+    // any button will stop alarming & snooze reminders
+    CLOCK_dismiss();
 }
 
-static void MSG_voice_button(struct talking_button_runtime_t *runtime)
+static void BUTTON_end(void)
 {
-    PERIPHERAL_batt_ad_sync();
+    POWER_unlock(POWER_CAUSE_BUTTON);
+}
 
-    uint16_t mv = PERIPHERAL_batt_volt();
+static void BUTTON_batt_volume(uint16_t mv)
+{
     LOG_info("batt %dmV", mv);
 
-    if (BATT_EMPTY_MV > mv)
+    uint8_t percent = BATT_mv_level(mv);
+    if (50 > percent)
     {
-        runtime->setting = false;
-        return;
+        percent = MIN(smartcuckoo.volume, MAX(25, percent));
+        AUDIO_set_volume_percent(percent);
     }
     else
-    {
-        uint8_t percent = BATT_mv_level(mv);
-        if (50 > percent)
-        {
-            percent = MIN(smartcuckoo.volume, MAX(25, percent));
-            AUDIO_set_volume_percent(percent);
-        }
-        else
-            AUDIO_set_volume_percent(smartcuckoo.volume);
-    }
-
-    struct tm const *dt = CLOCK_update_timestamp(&runtime->batt_last_ts);
-    PMU_power_lock();
-    mplayer_playlist_clear();
-
-    // any button will stop alarming & snooze reminders
-    CLOCK_dismiss();
-
-    // insert say low battery
-    if (BATT_HINT_MV > PERIPHERAL_batt_volt())
-        VOICE_say_setting(VOICE_SETTING_EXT_LOW_BATT);
+        AUDIO_set_volume_percent(smartcuckoo.volume);
+}
 
-    if (! runtime->setting)
-    {
-        if (SETTING_TIMEOUT < clock() - runtime->voice_last_tick)
-        {
-            runtime->voice_last_tick = clock();
+static void SETTING_say_part(struct talking_button_runtime_t *runtime)
+{
+    struct CLOCK_moment_t *alarm0 = CLOCK_get_alarm(0);
+    UI_setting_load(runtime->setting_part, alarm0, &runtime->setting_dt);
 
-            VOICE_say_time(dt);
-            CLOCK_say_reminders(dt, true);
-        }
-        else
-        {
-            runtime->voice_last_tick -= SETTING_TIMEOUT;
-            VOICE_say_date(dt);
-        }
-    }
-    else
-    {
-        int16_t old_voice_id;
-        struct CLOCK_moment_t *alarm0 = CLOCK_get_alarm(0);
+    VOICE_say_setting(runtime->setting_part);
+    VOICE_say_setting_part(runtime->setting_part, &runtime->setting_dt, alarm0->ringtone_id);
+}
 
-        switch (runtime->setting_part)
-        {
-        case VOICE_SETTING_EXT_LOW_BATT:
-        case VOICE_SETTING_EXT_ALARM_ON:
-        case VOICE_SETTING_EXT_ALARM_OFF:
-            break;
+static bool MSG_batt_is_empty(void *ctx, uint8_t event, uint8_t id)
+{
+    (void)ctx;
+    (void)event;
+    (void)id;
 
-        case VOICE_SETTING_LANG:
-            old_voice_id = smartcuckoo.voice_sel_id;
-            smartcuckoo.voice_sel_id = VOICE_next_locale();
+    return BATT_EMPTY_MV > PERIPHERAL_batt_volt();
+}
 
-            if (old_voice_id != smartcuckoo.voice_sel_id)
-            {
-                smartcuckoo.locale.dfmt = DFMT_DEFAULT;
-                smartcuckoo.locale.hfmt = HFMT_DEFAULT;
-                runtime->setting_is_modified = true;
-            }
-            break;
+static void MSG_alive_batt(void *ctx, uint8_t event, uint8_t id)
+{
+    (void)ctx;
+    (void)event;
+    (void)id;
 
-        case VOICE_SETTING_VOICE:
-            old_voice_id = smartcuckoo.voice_sel_id;
-            smartcuckoo.voice_sel_id = VOICE_next_voice();
+    // LOG_debug("alive");
+    // sampling is kept at shortest interval below BATT_HINT_MV, no other actions when empty
+    PERIPHERAL_batt_schedule();
+}
 
-            if (old_voice_id != smartcuckoo.voice_sel_id)
-            {
-                smartcuckoo.locale.dfmt = DFMT_DEFAULT;
-                smartcuckoo.locale.hfmt = HFMT_DEFAULT;
-                runtime->setting_is_modified = true;
-            }
-            break;
+static void MSG_alive(void *ctx, uint8_t event, uint8_t id)
+{
+    MSG_alive_batt(ctx, event, id);
 
-        case VOICE_SETTING_HOUR:
-            runtime->setting_dt.tm_hour = (runtime->setting_dt.tm_hour + 1) % 24;
-            goto setting_rtc_set_time;
+    if (BATT_EMPTY_MV <= PERIPHERAL_batt_volt())
+        CLOCK_schedule();
+}
 
-        case VOICE_SETTING_MINUTE:
-            runtime->setting_dt.tm_min = (runtime->setting_dt.tm_min + 1) % 60;
-            goto setting_rtc_set_time;
+static void MSG_alarm_sw(void *ctx, uint8_t event, uint8_t id)
+{
+    struct talking_button_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
 
-        case VOICE_SETTING_YEAR:
-            TM_year_add(&runtime->setting_dt, 1);
-            goto setting_rtc_set_date;
+    // alaramsw_timeout_callback((void *)1);
+    timeout_start(&runtime->alarm_sw_timeo, (void *)1);
+}
 
-        case VOICE_SETTING_MONTH:
-            TM_month_add(&runtime->setting_dt, 1);
-            goto setting_rtc_set_date;
+static void MSG_voice(void *ctx, uint8_t event, uint8_t id)
+{
+    struct talking_button_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
 
-        case VOICE_SETTING_MDAY:
-            TM_mday_add(&runtime->setting_dt, 1);
-            goto setting_rtc_set_date;
+    BUTTON_batt_volume(PERIPHERAL_batt_volt());
 
-        case VOICE_SETTING_ALARM_HOUR:
-            runtime->setting_dt.tm_hour = (runtime->setting_dt.tm_hour + 1) % 24;
-            goto setting_modify_alarm;
+    struct tm const *dt = CLOCK_update_timestamp(NULL);
+    BUTTON_begin();
 
-        case VOICE_SETTING_ALARM_MIN:
-            runtime->setting_dt.tm_min = (runtime->setting_dt.tm_min + 1) % 60;
-            goto setting_modify_alarm;
+    // insert say low battery
+    if (BATT_HINT_MV > PERIPHERAL_batt_volt())
+        VOICE_say_setting(VOICE_SETTING_EXT_LOW_BATT);
 
-        case VOICE_SETTING_ALARM_RINGTONE:
-            alarm0->ringtone_id = (uint8_t)VOICE_next_ringtone(alarm0->ringtone_id);
-            goto setting_modify_alarm;
+    if (SETTING_TIMEOUT < clock() - runtime->voice_last_tick)
+    {
+        runtime->voice_last_tick = clock();
 
-        case VOICE_SETTING_COUNT:
-            break;
-        };
+        VOICE_say_time(dt);
+        CLOCK_say_reminders(dt, true);
+    }
+    else
+    {
+        runtime->voice_last_tick -= SETTING_TIMEOUT;
+        VOICE_say_date(dt);
+    }
+    BUTTON_end();
+}
 
-        if (false)
-        {
-        setting_rtc_set_time:
-            runtime->setting_dt.tm_sec = 0;
-            RTC_set_epoch_time(mktime(&runtime->setting_dt) - get_dst_offset(&runtime->setting_dt));
+static void MSG_setting_enter(void *ctx, uint8_t event, uint8_t id)
+{
+    struct talking_button_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
 
-            LOG_info("%02d:%02d:%02d", runtime->setting_dt.tm_hour,
-                runtime->setting_dt.tm_min,
-                runtime->setting_dt.tm_sec);
-        }
+    BUTTON_begin();
 
-        if (false)
-        {
-            struct tm date;
-
-        setting_rtc_set_date:
-            date = runtime->setting_dt;
-            date.tm_hour = 0;
-            date.tm_min = 0;
-            date.tm_sec = 0;
-            RTC_set_epoch_time(time(NULL) % 86400 + mktime(&date));
-
-            LOG_info("%04d/%02d/%02d", runtime->setting_dt.tm_year + 1900,
-                runtime->setting_dt.tm_mon + 1,
-                runtime->setting_dt.tm_mday);
-        }
+    // say low battery only
+    if (BATT_HINT_MV > PERIPHERAL_batt_volt())
+        VOICE_say_setting(VOICE_SETTING_EXT_LOW_BATT);
 
-        if (false)
-        {
-        setting_modify_alarm:
-            runtime->setting_alarm_is_modified = true;
-            alarm0->enabled = true;
-            alarm0->mtime = time2mtime(mktime(&runtime->setting_dt));
-            alarm0->mdate = 0;
-            alarm0->wdays = 0x7F;
-        }
+    runtime->setting_part = VOICE_first_setting();
+    runtime->setting_is_modified = false;
+    runtime->setting_alarm_is_modified = false;
 
-        mplayer_playlist_clear();
-        VOICE_say_setting_part(runtime->setting_part, &runtime->setting_dt, alarm0->ringtone_id);
-    }
-    PMU_power_unlock();
+    SETTING_say_part(runtime);
+    BUTTON_end();
 }
 
-static void MSG_setting_button(struct talking_button_runtime_t *runtime)
+static void MSG_setting_next(void *ctx, uint8_t event, uint8_t id)
 {
-    PMU_power_lock();
-    mplayer_playlist_clear();
+    struct talking_button_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
 
-    // any button will stop alarming & snooze reminders
-    CLOCK_dismiss();
+    BUTTON_begin();
 
     // say low battery only
-    if (1)
-    {
-        uint16_t batt = PERIPHERAL_batt_volt();
-        if (BATT_EMPTY_MV > batt)
-            return;
-        if (BATT_HINT_MV > batt)
-            VOICE_say_setting(VOICE_SETTING_EXT_LOW_BATT);
-    }
+    if (BATT_HINT_MV > PERIPHERAL_batt_volt())
+        VOICE_say_setting(VOICE_SETTING_EXT_LOW_BATT);
 
-    if (! runtime->setting)
-    {
-        runtime->setting_part = VOICE_first_setting();
+    runtime->setting_part = VOICE_next_setting(runtime->setting_part);
 
-        runtime->setting = true;
-        runtime->setting_is_modified = false;
-        runtime->setting_alarm_is_modified = false;
-    }
-    else
-        runtime->setting_part = VOICE_next_setting(runtime->setting_part);
+    SETTING_say_part(runtime);
+    BUTTON_end();
+}
 
-    struct CLOCK_moment_t *alarm0 = CLOCK_get_alarm(0);
+static void MSG_setting_adjust(void *ctx, uint8_t event, uint8_t id)
+{
+    struct talking_button_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
 
-    if (VOICE_SETTING_ALARM_HOUR == runtime->setting_part ||
-        VOICE_SETTING_ALARM_MIN == runtime->setting_part)
-    {
-        time_t ts = mtime2time(alarm0->mtime);
+    BUTTON_batt_volume(PERIPHERAL_batt_volt());
+    BUTTON_begin();
 
-        localtime_r(&ts, &runtime->setting_dt);
-        runtime->setting_dt.tm_sec = 0;
-    }
-    else
-    {
-        time_t ts = time(NULL);
+    // insert say low battery
+    if (BATT_HINT_MV > PERIPHERAL_batt_volt())
+        VOICE_say_setting(VOICE_SETTING_EXT_LOW_BATT);
 
-        localtime_r(&ts, &runtime->setting_dt);
-        runtime->setting_dt.tm_sec = 0;
-    }
+    struct CLOCK_moment_t *alarm0 = CLOCK_get_alarm(0);
+    unsigned modified = UI_setting_adjust(runtime->setting_part, &runtime->setting_dt, alarm0, true);
 
-    VOICE_say_setting(runtime->setting_part);
+    if (UI_SETTING_MODIFIED & modified)
+        runtime->setting_is_modified = true;
+    if (UI_SETTING_ALARM_MODIFIED & modified)
+        runtime->setting_alarm_is_modified = true;
+
+    mplayer_playlist_clear();
     VOICE_say_setting_part(runtime->setting_part, &runtime->setting_dt, alarm0->ringtone_id);
 
-    PMU_power_unlock();
+    BUTTON_end();
 }
 
-static void MSG_setting_timeout(struct talking_button_runtime_t *runtime)
+static void MSG_setting_dismiss(void *ctx, uint8_t event, uint8_t id)
 {
-    if (runtime->setting)
-    {
-        runtime->setting = false;
+    (void)ctx;
+    (void)event;
+    (void)id;
+
+    BUTTON_begin();
+    BUTTON_end();
+}
 
-        if (runtime->setting_alarm_is_modified)
-            CLOCK_update_alarms();
-        if (runtime->setting_is_modified)
-            NVM_set(NVM_SETTING, sizeof(smartcuckoo), &smartcuckoo);
+static void MSG_setting_timeout(void *ctx, uint8_t event, uint8_t id)
+{
+    struct talking_button_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
 
-        VOICE_say_setting(VOICE_SETTING_DONE);
-    }
+    LOG_warning("talking button: setting timeout");
+
+    if (runtime->setting_alarm_is_modified)
+        CLOCK_update_alarms();
+    if (runtime->setting_is_modified)
+        NVM_set(NVM_SETTING, sizeof(smartcuckoo), &smartcuckoo);
+
+    VOICE_say_setting(VOICE_SETTING_DONE);
 }
 
+/****************************************************************************
+ *  @private: message thread
+ ****************************************************************************/
 static __attribute__((noreturn)) void *MSG_dispatch_thread(struct talking_button_runtime_t *runtime)
 {
     while (true)
@@ -458,30 +430,17 @@ static __attribute__((noreturn)) void *MSG_dispatch_thread(struct talking_button
 
         if (msg)
         {
-            switch ((enum talking_button_message_t)msg->msgid)
-            {
-            case MSG_VOICE_BUTTON:
-                MSG_voice_button(runtime);
-                break;
-
-            case MSG_SETTING_BUTTON:
-                MSG_setting_button(runtime);
-                break;
-
-            case MSG_SETTING_TIMEOUT:
-                LOG_warning("talking button: setting timeout");
-                MSG_setting_timeout(runtime);
-                break;
-
-            case MSG_ALARM_SW:
-                // alaramsw_timeout_callback((void *)1);
-                timeout_start(&runtime->alarm_sw_timeo, (void *)1);
-                break;
-            }
+            POWER_enter(POWER_CAUSE_BUTTON);
+            UI_FSM_dispatch(&runtime->ui, msg->msgid);
+            POWER_leave(POWER_CAUSE_BUTTON);
 
             mqueue_release_pool(runtime->mqd, msg);
         }
         else
-            MSG_alive(runtime);
+        {
+            POWER_enter(POWER_CAUSE_ALIVE);
+            UI_FSM_dispatch(&runtime->ui, MSG_ALIVE);
+            POWER_leave(POWER_CAUSE_ALIVE);
+        }
     }
 }
@@ -0,0 +1,62 @@
+#ifndef __TALKING_BUTTON_UI_H
+#define __TALKING_BUTTON_UI_H           1
+
+#include "button.h"
+#include "ui_fsm.h"
+
+/***************************************************************************
+ *  talking button UI: states x events => actions
+ *
+ *      included by talking_button.c implementing the actions & guards,
+ *      and by test/host/test_ui_talking_button.c replaying scripts against stubs of them
+***************************************************************************/
+enum talking_button_message_t
+{
+    MSG_VOICE_BUTTON            = 1,
+    MSG_SETTING_BUTTON,
+
+    MSG_ALARM_SW,
+    MSG_SETTING_TIMEOUT,
+    MSG_ALIVE,
+};
+
+enum talking_button_ui_state_t
+{
+    TALKING_BUTTON_UI_IDLE      = 0,
+    TALKING_BUTTON_UI_SETTING,
+};
+
+static bool MSG_batt_is_empty(void *ctx, uint8_t event, uint8_t id);
+
+static void MSG_alive(void *ctx, uint8_t event, uint8_t id);
+static void MSG_alive_batt(void *ctx, uint8_t event, uint8_t id);
+static void MSG_alarm_sw(void *ctx, uint8_t event, uint8_t id);
+static void MSG_voice(void *ctx, uint8_t event, uint8_t id);
+
+static void MSG_setting_enter(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_next(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_adjust(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_dismiss(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_timeout(void *ctx, uint8_t event, uint8_t id);
+
+static struct UI_transition_t const talking_button_ui[] =
+{
+    UI_ON(UI_STATE_ANY,                 UI_EVENT_ANY,   MSG_ALARM_SW,           MSG_alarm_sw,           UI_STATE_SAME),
+    UI_ON(TALKING_BUTTON_UI_SETTING,    UI_EVENT_ANY,   MSG_SETTING_TIMEOUT,    MSG_setting_timeout,    TALKING_BUTTON_UI_IDLE),
+    UI_ON(TALKING_BUTTON_UI_IDLE,       UI_EVENT_ANY,   MSG_ALIVE,              MSG_alive,              UI_STATE_SAME),
+    UI_ON(TALKING_BUTTON_UI_SETTING,    UI_EVENT_ANY,   MSG_ALIVE,              MSG_alive_batt,         UI_STATE_SAME),
+
+    // VOICE: says time, adjusts setting part in setting. empty battery abandons setting
+    UI_ON_IF(UI_STATE_ANY,              BUTTON_PRESS,   MSG_VOICE_BUTTON,       MSG_batt_is_empty,
+        NULL,                           TALKING_BUTTON_UI_IDLE),
+    UI_ON(TALKING_BUTTON_UI_IDLE,       BUTTON_PRESS,   MSG_VOICE_BUTTON,       MSG_voice,              UI_STATE_SAME),
+    UI_ON(TALKING_BUTTON_UI_SETTING,    BUTTON_PRESS,   MSG_VOICE_BUTTON,       MSG_setting_adjust,     UI_STATE_SAME),
+
+    // SETTING: enters setting, then selects next setting part. empty battery only dismisses alarm
+    UI_ON_IF(UI_STATE_ANY,              BUTTON_PRESS,   MSG_SETTING_BUTTON,     MSG_batt_is_empty,
+        MSG_setting_dismiss,            UI_STATE_SAME),
+    UI_ON(TALKING_BUTTON_UI_IDLE,       BUTTON_PRESS,   MSG_SETTING_BUTTON,     MSG_setting_enter,      TALKING_BUTTON_UI_SETTING),
+    UI_ON(TALKING_BUTTON_UI_SETTING,    BUTTON_PRESS,   MSG_SETTING_BUTTON,     MSG_setting_next,       UI_STATE_SAME),
+};
+
+#endif
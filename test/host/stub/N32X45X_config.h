@@ -0,0 +1,8 @@
+#ifndef __HOST_N32X45X_CONFIG_H
+#define __HOST_N32X45X_CONFIG_H         1
+
+/***************************************************************************
+ *  host build: ws2812b_driver.c encoder only, WS2812B_DMA 0
+***************************************************************************/
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef __HOST_GPIO_H
+#define __HOST_GPIO_H                   1
+
+/***************************************************************************
+ *  host build: ws2812b_driver.c encoder only, WS2812B_DMA 0
+***************************************************************************/
+#include <stdint.h>
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef __HOST_MD5_H
+#define __HOST_MD5_H                    1
+
+#include <openssl/md5.h>
+
+    typedef MD5_CTX MD5_context_t;
+    typedef struct { uint8_t digest[MD5_DIGEST_LENGTH]; } MD5_t;
+
+static inline
+    void MD5_init(MD5_context_t *ctx)
+    {
+        MD5_Init(ctx);
+    }
+
+static inline
+    void MD5_update(MD5_context_t *ctx, void const *buf, size_t count)
+    {
+        MD5_Update(ctx, buf, count);
+    }
+
+static inline
+    MD5_t MD5_final(MD5_context_t *ctx)
+    {
+        MD5_t md5;
+        MD5_Final(md5.digest, ctx);
+        return md5;
+    }
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef __HOST_H
+#define __HOST_H                        1
+
+/***************************************************************************
+ *  host build of firmware modules: the few ultracore definitions they use
+***************************************************************************/
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef EINTEGRITY
+    #define EINTEGRITY                  (1001)
+#endif
+
+#ifndef MIN
+    #define MIN(a, b)                   ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+    #define MAX(a, b)                   ((a) > (b) ? (a) : (b))
+#endif
+#ifndef lengthof
+    #define lengthof(a)                 (sizeof(a) / sizeof((a)[0]))
+#endif
+#ifndef ARG_UNUSED
+    #define ARG_UNUSED(...)             ((void)(__VA_ARGS__))
+#endif
+
+    typedef uint8_t bytebool_t;
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef __HOST_HW_SMART_LED_H
+#define __HOST_HW_SMART_LED_H           1
+
+/***************************************************************************
+ *  host build: smart_led/led_time.c needs no driver definitions
+***************************************************************************/
+#include <stdint.h>
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef __HOST_ULTRACORE_LOG_H
+#define __HOST_ULTRACORE_LOG_H          1
+
+/***************************************************************************
+ *  host build: logging is dropped
+***************************************************************************/
+    #define LOG_error(...)
+    #define LOG_warning(...)
+    #define LOG_info(...)
+    #define LOG_verbose(...)
+
+#endif
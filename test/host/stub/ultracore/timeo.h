@@ -0,0 +1,23 @@
+#ifndef __HOST_ULTRACORE_TIMEO_H
+#define __HOST_ULTRACORE_TIMEO_H        1
+
+/***************************************************************************
+ *  host build: timeout_t is embedded by structures,
+ *      tests running timeouts define the functions and call back by themselves
+***************************************************************************/
+#include <stdint.h>
+
+    #define TIMEOUT_FLAG_REPEAT         (1)
+
+    typedef struct timeout_t
+    {
+        void *callback;
+        void *arg;
+        uint32_t intv;
+    } timeout_t;
+
+extern void timeout_init(struct timeout_t *timeo, uint32_t intv, void (*callback)(void *arg), int flags);
+extern void timeout_start(struct timeout_t *timeo, void *arg);
+extern void timeout_stop(struct timeout_t *timeo);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef __HOST_VINFO_H
+#define __HOST_VINFO_H                  1
+
+/***************************************************************************
+ *  host build: board PERIPHERAL_config.h for its constants only
+***************************************************************************/
+#include <stdint.h>
+
+    #define VERSION_INFO(major, minor, build)   ((uint32_t)(major) << 24 | (uint32_t)(minor) << 16 | (build))
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef __HOST_WDT_H
+#define __HOST_WDT_H                    1
+
+    extern unsigned host_wdog_feeds;
+
+static inline
+    void WDOG_feed(void)
+    {
+        host_wdog_feeds ++;
+    }
+
+#endif
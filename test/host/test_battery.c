@@ -0,0 +1,81 @@
+/***************************************************************************
+ *  battery.c with board values
+ *
+ *      test_battery_<board>
+ *      PERIPHERAL_config.h of the board is included before battery.h as smartcuckoo.h does,
+ *      its BATT_AD_INTV_SECONDS must cap the sampling interval, the load model must reach the estimator
+***************************************************************************/
+#include <stdio.h>
+
+#include "PERIPHERAL_config.h"
+#include "battery.h"
+
+#ifndef BATT_AD_INTV_SECONDS
+    #error "board without BATT_AD_INTV_SECONDS"
+#endif
+
+static int failed;
+
+static void check(char const *name, long val, long expect)
+{
+    if (val != expect)
+    {
+        if (10 > failed ++)
+            printf("FAIL %s %s: %ld, expect %ld\n", PROJECT_ID, name, val, expect);
+    }
+}
+
+int main(void)
+{
+    struct BATT_monitor_t mon;
+    struct BATT_estimator_t est;
+    static struct BATT_load_model_t const model = BATT_LOAD_MODEL_INITIALIZER;
+    time_t ts = 1000000;
+
+    check("BATT_SAMPLE_MAX_SECONDS", BATT_SAMPLE_MAX_SECONDS, BATT_AD_INTV_SECONDS);
+
+    // flat voltage: no discharge slope, sampled by the max interval of the board
+    BATT_monitor_init(&mon, BATT_HINT_MV, BATT_SAMPLE_MAX_SECONDS);
+    for (int i = 0; i < 16; i ++)
+    {
+        if (! BATT_monitor_schedule(&mon, ts))
+            check("schedule", 0, 1);
+
+        BATT_monitor_sample(&mon, 3900, false, ts);
+        check("flat intv", (long)(mon.next_ts - ts), BATT_AD_INTV_SECONDS);
+
+        if (BATT_monitor_schedule(&mon, ts + BATT_AD_INTV_SECONDS - 1))
+            check("early schedule", 1, 0);
+        ts = mon.next_ts;
+    }
+
+    // discharging 1 mV / hour: the step interval of 10 hours is capped as well
+    for (int i = 0; i < 64; i ++)
+    {
+        BATT_monitor_schedule(&mon, ts);
+        BATT_monitor_sample(&mon, 3900 - (int)((ts - 1000000) / 3600), false, ts);
+        ts = mon.next_ts;
+    }
+    check("slow intv", (long)(mon.next_ts - mon.idle_ts), BATT_AD_INTV_SECONDS);
+
+    // below low_mv
+    BATT_monitor_init(&mon, BATT_HINT_MV, BATT_SAMPLE_MAX_SECONDS);
+    BATT_monitor_schedule(&mon, ts);
+    BATT_monitor_sample(&mon, BATT_HINT_MV - 50, false, ts);
+    check("low intv", (long)(mon.next_ts - ts), BATT_SAMPLE_MIN_SECONDS);
+
+    // load model
+    BATT_estimator_init(&est, BATT_CAPACITY_MAH, &model);
+    check("idle ua", (long)est.load_ua, BATT_IDLE_UA);
+    check("idle minutes", (long)BATT_estimator_minutes(&est), (long)BATT_CAPACITY_MAH * 1000 * 60 / BATT_IDLE_UA);
+
+    BATT_estimator_load(&est, BATT_LOAD_VOICE | BATT_LOAD_LED | BATT_LOAD_BLE, 50, ts);
+    check("load ua", (long)est.load_ua, BATT_IDLE_UA + BATT_VOICE_UA + BATT_LED_FULL_UA / 2 + BATT_BLE_UA);
+
+    BATT_estimator_load(&est, BATT_LOAD_VOICE | BATT_LOAD_LED | BATT_LOAD_BLE, 50, ts + 3600);
+    check("charge", est.charge_uah, (long)BATT_CAPACITY_MAH * 1000 - (BATT_IDLE_UA + BATT_VOICE_UA + BATT_LED_FULL_UA / 2 + BATT_BLE_UA));
+
+    printf("%s battery %s: max intv %d s, idle %d uA\n", failed ? "FAIL" : "PASS", PROJECT_ID,
+        BATT_AD_INTV_SECONDS, BATT_IDLE_UA);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,196 @@
+/***************************************************************************
+ *  delta.c against tools/ota_delta.py
+ *
+ *      test_delta <old.bin> <patch> <new.bin>
+ *      apply a patch of ota_delta.py as shell_ota.c does: gzip patches through inflate,
+ *      patch bytes in OTA packet sized pushes, compare with new.bin.
+ *      then a different source image and malformed control records must be rejected
+***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "checksum.h"
+#include "delta.h"
+#include "inflate.h"
+
+unsigned host_wdog_feeds;
+
+struct stream_t
+{
+    uint8_t const *patch;
+    size_t patch_size;
+    size_t patch_pos;
+
+    struct DELTA_t delta;
+
+    uint8_t const *expect;
+    size_t size;
+    size_t pos;
+    bool mismatch;
+};
+
+static uint8_t window[INFLATE_WINDOW_SIZE];
+
+static uint8_t *load(char const *path, size_t *size)
+{
+    FILE *fp = fopen(path, "rb");
+    if (! fp)
+    {
+        perror(path);
+        exit(2);
+    }
+
+    fseek(fp, 0, SEEK_END);
+    *size = (size_t)ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    uint8_t *buf = malloc(*size + 1);
+    if (*size != fread(buf, 1, *size, fp))
+    {
+        perror(path);
+        exit(2);
+    }
+    fclose(fp);
+    return buf;
+}
+
+static int flash_write(struct stream_t *stream, uint8_t const *buf, size_t count)
+{
+    if (count > stream->size - stream->pos || 0 != memcmp(stream->expect + stream->pos, buf, count))
+        stream->mismatch = true;
+
+    stream->pos += count;
+    return 0;
+}
+
+static ssize_t stream_read(struct stream_t *stream, uint8_t *buf, size_t count)
+{
+    // OTA packet payload
+    size_t len = MIN(count, 16);
+    len = MIN(len, stream->patch_size - stream->patch_pos);
+
+    memcpy(buf, stream->patch + stream->patch_pos, len);
+    stream->patch_pos += len;
+    return (ssize_t)len;
+}
+
+static int stream_write(struct stream_t *stream, uint8_t const *buf, size_t count)
+{
+    return DELTA_feed(&stream->delta, buf, count);
+}
+
+static int apply(uint8_t const *old, size_t old_size, uint8_t const *patch, size_t patch_size,
+    uint8_t const *expect, size_t size, bool *mismatch)
+{
+    static struct stream_t stream;
+    int err;
+
+    memset(&stream, 0, sizeof(stream));
+    stream.patch = patch;
+    stream.patch_size = patch_size;
+    stream.expect = expect;
+    stream.size = size;
+
+    DELTA_init(&stream.delta, (DELTA_write_t)flash_write, &stream, old, (uint32_t)old_size);
+
+    if (2 <= patch_size && 0x1F == patch[0] && 0x8B == patch[1])
+    {
+        struct INFLATE_t inflate;
+
+        INFLATE_init(&inflate, (INFLATE_read_t)stream_read, (INFLATE_write_t)stream_write, &stream, window);
+        err = INFLATE_gzip(&inflate);
+    }
+    else
+    {
+        uint8_t buf[16];
+        err = 0;
+
+        while (0 == err && stream.patch_pos < stream.patch_size)
+        {
+            ssize_t len = stream_read(&stream, buf, sizeof(buf));
+            err = stream_write(&stream, buf, (size_t)len);
+        }
+    }
+
+    if (0 == err)
+        err = DELTA_finish(&stream.delta);
+
+    *mismatch = stream.mismatch || stream.pos != size;
+    return err;
+}
+
+static void put_le32(uint8_t *p, uint32_t val)
+{
+    p[0] = (uint8_t)val;
+    p[1] = (uint8_t)(val >> 8);
+    p[2] = (uint8_t)(val >> 16);
+    p[3] = (uint8_t)(val >> 24);
+}
+
+int main(int argc, char **argv)
+{
+    if (4 != argc)
+    {
+        fprintf(stderr, "usage: %s <old.bin> <patch> <new.bin>\n", argv[0]);
+        return 2;
+    }
+
+    size_t old_size, patch_size, new_size;
+    uint8_t *old = load(argv[1], &old_size);
+    uint8_t *patch = load(argv[2], &patch_size);
+    uint8_t *new = load(argv[3], &new_size);
+    int failed = 0;
+    bool mismatch;
+    int err;
+
+    err = apply(old, old_size, patch, patch_size, new, new_size, &mismatch);
+    if (0 != err || mismatch)
+    {
+        printf("FAIL %s: err %d, mismatch %d\n", argv[2], err, mismatch);
+        failed ++;
+    }
+    if (old_size > CHECKSUM_BLOCK_SIZE && 0 == host_wdog_feeds)
+    {
+        printf("FAIL %s: watchdog not fed while hashing %zu bytes\n", argv[2], old_size);
+        failed ++;
+    }
+
+    // a different running image: nothing written
+    old[old_size / 2] ^= 0x5A;
+    err = apply(old, old_size, patch, patch_size, new, new_size, &mismatch);
+    if (EINTEGRITY != err)
+    {
+        printf("FAIL %s: source mismatch err %d\n", argv[2], err);
+        failed ++;
+    }
+    old[old_size / 2] ^= 0x5A;
+
+    // diff_len + extra_len wraps 32 bits
+    if (0x1F != patch[0])
+    {
+        uint8_t bad[DELTA_HEADER_SIZE + DELTA_CTRL_SIZE];
+
+        memcpy(bad, patch, DELTA_HEADER_SIZE);
+        put_le32(&bad[DELTA_HEADER_SIZE], 16);
+        put_le32(&bad[DELTA_HEADER_SIZE + 4], UINT32_MAX - 8);
+        put_le32(&bad[DELTA_HEADER_SIZE + 8], 0);
+
+        struct stream_t stream = {.expect = new, .size = new_size};
+        DELTA_init(&stream.delta, (DELTA_write_t)flash_write, &stream, old, (uint32_t)old_size);
+
+        err = DELTA_feed(&stream.delta, bad, sizeof(bad));
+        if (EINVAL != err)
+        {
+            printf("FAIL %s: wrapping control record err %d\n", argv[2], err);
+            failed ++;
+        }
+    }
+
+    printf("%s %s: %zu + %zu => %zu bytes\n", failed ? "FAIL" : "PASS", argv[2], old_size, patch_size, new_size);
+
+    free(old);
+    free(patch);
+    free(new);
+    return failed ? 1 : 0;
+}
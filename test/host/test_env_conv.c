@@ -0,0 +1,69 @@
+/***************************************************************************
+ *  sensors/env_conv.h reciprocal multiplies against exact rounding
+ *
+ *      test_env_conv
+ *      every SHT4x code, every AHT2x code and the whole int16 range of Fahrenheit,
+ *      reference is round half up by integer floor division: floor((2 * num * value + den) / (2 * den))
+***************************************************************************/
+#include <stdio.h>
+
+#include "sensors/env_conv.h"
+
+static unsigned failed;
+static unsigned count;
+
+static int64_t floor_div(int64_t num, int64_t den)
+{
+    int64_t q = num / den;
+    return (num % den != 0 && (num < 0) != (den < 0)) ? q - 1 : q;
+}
+
+static int64_t round_mul_div(int64_t value, int64_t num, int64_t den)
+{
+    return floor_div(2 * num * value + den, 2 * den);
+}
+
+static void check(char const *name, long raw, long val, long expect)
+{
+    count ++;
+    if (val != expect)
+    {
+        if (10 > failed ++)
+            printf("FAIL %s(%ld): %ld, expect %ld\n", name, raw, val, expect);
+    }
+}
+
+int main(void)
+{
+    for (uint32_t raw = 0; raw <= UINT16_MAX; raw ++)
+    {
+        check("SHT4X_tmpr", (long)raw, SHT4X_tmpr((uint16_t)raw), (long)(round_mul_div(raw, 1750, 65535) - 450));
+
+        int64_t humidity = round_mul_div(raw, 125, 65535) - 6;
+        humidity = 0 > humidity ? 0 : 100 < humidity ? 100 : humidity;
+        check("SHT4X_humidity", (long)raw, SHT4X_humidity((uint16_t)raw), (long)humidity);
+    }
+
+    for (uint32_t raw = 0; raw < 1UL << 20; raw ++)
+    {
+        int16_t tmpr = AHT2X_tmpr(raw);
+        uint8_t humidity = AHT2X_humidity(raw);
+
+        check("AHT2X_tmpr", (long)raw, tmpr, (long)(round_mul_div(raw, 2000, 1L << 20) - 500));
+        check("AHT2X_humidity", (long)raw, humidity, (long)round_mul_div(raw, 100, 1L << 20));
+
+        // status / humidity bits above the 20 bit code are masked
+        check("AHT2X_tmpr mask", (long)raw, AHT2X_tmpr(raw | 0xFFF00000UL), tmpr);
+        check("AHT2X_humidity mask", (long)raw, AHT2X_humidity(raw | 0xFFF00000UL), humidity);
+    }
+
+    // 0.1°C => 0.1°F, results beyond int16 wrap alike
+    for (int32_t celsius = INT16_MIN; celsius <= INT16_MAX; celsius ++)
+    {
+        check("ENV_CONV_fahrenheit", (long)celsius, ENV_CONV_fahrenheit((int16_t)celsius),
+            (int16_t)(round_mul_div(celsius, 9, 5) + 320));
+    }
+
+    printf("%s env_conv: %u conversions, %u mismatch\n", failed ? "FAIL" : "PASS", count, failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+/***************************************************************************
+ *  inflate.c round trip
+ *
+ *      test_inflate <image.bin.gz> <image.bin>
+ *      decompress a real gzip image in random sized reads, compare with the original,
+ *      then corrupted / truncated copies of it must be rejected
+***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inflate.h"
+
+// one arg for both callbacks, as OTA_stream of shell_ota.c
+struct stream_t
+{
+    uint8_t const *src;
+    size_t src_size;
+    size_t src_pos;
+
+    uint8_t const *expect;
+    size_t size;
+    size_t pos;
+    bool mismatch;
+};
+
+static uint8_t window[INFLATE_WINDOW_SIZE];
+
+static uint8_t *load(char const *path, size_t *size)
+{
+    FILE *fp = fopen(path, "rb");
+    if (! fp)
+    {
+        perror(path);
+        exit(2);
+    }
+
+    fseek(fp, 0, SEEK_END);
+    *size = (size_t)ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    uint8_t *buf = malloc(*size + 1);
+    if (*size != fread(buf, 1, *size, fp))
+    {
+        perror(path);
+        exit(2);
+    }
+    fclose(fp);
+    return buf;
+}
+
+static ssize_t stream_read(struct stream_t *stream, uint8_t *buf, size_t count)
+{
+    // random chunking as BLE / USB packets
+    size_t len = MIN(count, (size_t)(1 + rand() % 19));
+    len = MIN(len, stream->src_size - stream->src_pos);
+
+    memcpy(buf, stream->src + stream->src_pos, len);
+    stream->src_pos += len;
+    return (ssize_t)len;
+}
+
+static int stream_write(struct stream_t *stream, uint8_t const *buf, size_t count)
+{
+    if (count > stream->size - stream->pos || 0 != memcmp(stream->expect + stream->pos, buf, count))
+        stream->mismatch = true;
+
+    stream->pos += count;
+    return 0;
+}
+
+static int run(uint8_t const *gz, size_t gz_size, uint8_t const *raw, size_t raw_size, bool *mismatch)
+{
+    struct INFLATE_t ctx;
+    struct stream_t stream = {.src = gz, .src_size = gz_size, .expect = raw, .size = raw_size};
+
+    INFLATE_init(&ctx, (INFLATE_read_t)stream_read, (INFLATE_write_t)stream_write, &stream, window);
+    int err = INFLATE_gzip(&ctx);
+
+    *mismatch = stream.mismatch || stream.pos != raw_size;
+    return err;
+}
+
+int main(int argc, char **argv)
+{
+    if (3 != argc)
+    {
+        fprintf(stderr, "usage: %s <image.bin.gz> <image.bin>\n", argv[0]);
+        return 2;
+    }
+
+    size_t gz_size, raw_size;
+    uint8_t *gz = load(argv[1], &gz_size);
+    uint8_t *raw = load(argv[2], &raw_size);
+    int failed = 0;
+    bool mismatch;
+
+    srand(1);
+    int err = run(gz, gz_size, raw, raw_size, &mismatch);
+    if (0 != err || mismatch)
+    {
+        printf("FAIL %s: err %d, mismatch %d\n", argv[1], err, mismatch);
+        failed ++;
+    }
+
+    // corrupted payload: deflate error or CRC32 of trailer, header name / comment are not covered
+    size_t hdr_size = 10;
+    if (0 != (0x04 & gz[3]))
+        hdr_size += 2 + (size_t)(gz[hdr_size] | gz[hdr_size + 1] << 8);
+    for (uint8_t flag = 0x08; flag <= 0x10; flag = (uint8_t)(flag << 1))
+    {
+        if (0 != (flag & gz[3]))
+            hdr_size += strlen((char *)&gz[hdr_size]) + 1;
+    }
+    if (0 != (0x02 & gz[3]))
+        hdr_size += 2;
+
+    for (unsigned i = 0; i < 64; i ++)
+    {
+        size_t pos = hdr_size + (size_t)rand() % (gz_size - hdr_size - 8);
+        uint8_t orig = gz[pos];
+        gz[pos] ^= (uint8_t)(1 + rand() % 255);
+
+        if (0 == run(gz, gz_size, raw, raw_size, &mismatch))
+        {
+            printf("FAIL %s: corruption at %zu accepted\n", argv[1], pos);
+            failed ++;
+        }
+        gz[pos] = orig;
+    }
+
+    // truncated
+    if (0 == run(gz, gz_size - 5, raw, raw_size, &mismatch))
+    {
+        printf("FAIL %s: truncated stream accepted\n", argv[1]);
+        failed ++;
+    }
+
+    printf("%s %s: %zu => %zu bytes\n", failed ? "FAIL" : "PASS", argv[1], gz_size, raw_size);
+
+    free(gz);
+    free(raw);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,110 @@
+/***************************************************************************
+ *  smart_led/led_fade.c timing
+ *
+ *      test_led_fade
+ *      the shared timeout is stepped by hand, LED_FADE_INTV per call:
+ *      a fade must stop on the step of its ms moving one way only, the target dim is reached
+ *      within its last 1% (8 bit dim rounds the last perceptual steps)
+ *      the 30 min sunrise of zinc wake light, a 60 min fade down and short clock dim fades
+***************************************************************************/
+#include <stdio.h>
+
+#include <ultracore/timeo.h>
+
+#include "smart_led/led_fade.h"
+
+static struct timeout_t *timeo;
+static bool running;
+
+static unsigned failed;
+static uint8_t applied;
+
+void timeout_init(struct timeout_t *t, uint32_t intv, void (*callback)(void *arg), int flags)
+{
+    (void)flags;
+    t->callback = (void *)callback;
+    t->intv = intv;
+    timeo = t;
+}
+
+void timeout_start(struct timeout_t *t, void *arg)
+{
+    t->arg = arg;
+    running = true;
+}
+
+void timeout_stop(struct timeout_t *t)
+{
+    (void)t;
+    running = false;
+}
+
+static void apply(struct LED_FADE_t *fade, uint8_t dim)
+{
+    (void)fade;
+    applied = dim;
+}
+
+static void fade(char const *name, uint8_t from, uint8_t to, uint32_t ms)
+{
+    static struct LED_FADE_t led;
+    static bool registered;
+
+    if (! registered)
+    {
+        LED_FADE_init(&led, from, apply);
+        registered = true;
+    }
+    else
+        LED_FADE_to(&led, from, 0);
+
+    applied = from;
+    LED_FADE_to(&led, to, ms);
+
+    uint32_t expect = (ms + LED_FADE_INTV - 1) / LED_FADE_INTV;
+    uint32_t reached = 0;
+    uint32_t steps = 0;
+    uint8_t last = from;
+
+    while (running && steps <= expect + 1)
+    {
+        ((void (*)(void *))timeo->callback)(timeo->arg);
+        steps ++;
+
+        if ((to > from && applied < last) || (to < from && applied > last))
+        {
+            if (10 > failed ++)
+                printf("FAIL %s: step %u dim %u => %u\n", name, (unsigned)steps, last, applied);
+        }
+        if (0 == reached && to == applied)
+            reached = steps;
+        last = applied;
+    }
+
+    if ((uint64_t)reached * 100 < (uint64_t)expect * 99 || expect != steps || to != applied || running)
+    {
+        if (10 > failed ++)
+        {
+            printf("FAIL %s: %u => %u in %lu ms: target at %lu ms, stopped at %lu ms, dim %u\n", name, from, to,
+                (unsigned long)ms, (unsigned long)reached * LED_FADE_INTV, (unsigned long)steps * LED_FADE_INTV, applied);
+        }
+    }
+}
+
+int main(void)
+{
+    // zinc wake light: LAMP_MIN_BRIGHTRESS => LAMP_MAX_BRIGHTRESS
+    fade("sunrise 15 min", 8, 160, 15UL * 60 * 1000);
+    fade("sunrise 30 min", 8, 160, 30UL * 60 * 1000);
+    fade("sunrise 60 min", 8, 160, 60UL * 60 * 1000);
+    fade("down 60 min", 255, 1, 60UL * 60 * 1000);
+
+    // light sensor auto dim / lamp dim, ms not a multiple of LED_FADE_INTV
+    fade("clock dim", 200, 20, 1500);
+    fade("lamp dim", 40, 41, 30);
+    fade("zero to full", 0, 255, 1000);
+
+    printf("%s led_fade: sunrise 30 min in %lu steps of %u ms\n", failed ? "FAIL" : "PASS",
+        30UL * 60 * 1000 / LED_FADE_INTV, LED_FADE_INTV);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,128 @@
+/***************************************************************************
+ *  smart_led/led_time.c table lookup against digit by digit masks
+ *
+ *      test_led_time
+ *      every value SMART_LED_time_mask_digit() can show in both leading zero modes,
+ *      every hour / minute pair of SMART_LED_time_mask_hm() and every time of day
+***************************************************************************/
+#include <stdio.h>
+
+#include "smart_led/led_time.h"
+
+static uint8_t const digit_mapping[10] =
+{
+    /* 0 */ 1U << 0 | 1U << 1 | 1U << 2 | 1U << 3 | 1U << 4 | 1U << 5,
+    /* 1 */ 1U << 1 | 1U << 2,
+    /* 2 */ 1U << 0 | 1U << 1 | 1U << 6 | 1U << 4 | 1U << 3,
+    /* 3 */ 1U << 0 | 1U << 1 | 1U << 6 | 1U << 2 | 1U << 3,
+    /* 4 */ 1U << 5 | 1U << 6 | 1U << 1 | 1U << 2,
+    /* 5 */ 1U << 0 | 1U << 5 | 1U << 6 | 1U << 2 | 1U << 3,
+    /* 6 */ 1U << 0 | 1U << 5 | 1U << 4 | 1U << 3 | 1U << 2 | 1U << 6,
+    /* 7 */ 1U << 0 | 1U << 1 | 1U << 2,
+    /* 8 */ 0x7FU,
+    /* 9 */ 1U << 0 | 1U << 5 | 1U << 6 | 1U << 1 | 1U << 2 | 1U << 3,
+};
+
+// digit by digit from minute ones, as led_time.c before table lookup
+static uint32_t ref_mask_digit(int digit, bool leading_zero)
+{
+    uint32_t mask = digit_mapping[digit % 10];
+    digit /= 10;
+
+    mask <<= 7;
+    if (leading_zero || 0 != digit)
+    {
+        mask |= digit_mapping[digit % 10];
+        digit /= 10;
+    }
+
+    mask <<= 2;
+
+    mask <<= 7;
+    if (leading_zero || 0 != digit)
+    {
+        mask |= digit_mapping[digit % 10];
+        digit /= 10;
+    }
+
+    mask <<= 7;
+    if (leading_zero || 0 != digit)
+        mask |= digit_mapping[digit % 10];
+
+    return mask;
+}
+
+// hour part is never blanked as a whole: only its tens below 10 without leading zero
+static uint32_t ref_mask_hm(unsigned hour, unsigned minute, bool leading_zero)
+{
+    uint32_t mask = (uint32_t)digit_mapping[hour % 10] << 7;
+
+    if (leading_zero || 10 <= hour)
+        mask |= digit_mapping[hour / 10];
+
+    mask |= (uint32_t)digit_mapping[minute / 10] << SMART_LED_TIME_SHIFT_MINUTE;
+    mask |= (uint32_t)digit_mapping[minute % 10] << (SMART_LED_TIME_SHIFT_MINUTE + 7);
+    return mask;
+}
+
+int main(void)
+{
+    unsigned failed = 0;
+    unsigned count = 0;
+
+    // 4 digits and the wrap above them
+    for (int digit = 0; digit < 100000; digit ++)
+    {
+        for (int lz = 0; lz < 2; lz ++)
+        {
+            uint32_t mask = SMART_LED_time_mask_digit(digit, lz);
+            uint32_t expect = ref_mask_digit(digit, lz);
+
+            count ++;
+            if (mask != expect)
+            {
+                if (10 > failed ++)
+                    printf("FAIL mask_digit(%d, %d): %08x, expect %08x\n", digit, lz, mask, expect);
+            }
+        }
+    }
+
+    for (unsigned hour = 0; hour < 100; hour ++)
+    {
+        for (unsigned minute = 0; minute < 100; minute ++)
+        {
+            for (int lz = 0; lz < 2; lz ++)
+            {
+                uint32_t mask = SMART_LED_time_mask_hm(hour, minute, lz);
+                uint32_t expect = ref_mask_hm(hour, minute, lz);
+
+                count ++;
+                if (mask != expect)
+                {
+                    if (10 > failed ++)
+                        printf("FAIL mask_hm(%u, %u, %d): %08x, expect %08x\n", hour, minute, lz, mask, expect);
+                }
+            }
+        }
+    }
+
+    for (int hour = 0; hour < 24; hour ++)
+    {
+        for (int minute = 0; minute < 60; minute ++)
+        {
+            struct tm dt = {.tm_hour = hour, .tm_min = minute};
+            uint32_t mask = SMART_LED_time_mask_tm(&dt);
+            uint32_t expect = ref_mask_digit(hour * 100 + minute, true) | SMART_LED_TIME_MASK_IND;
+
+            count ++;
+            if (mask != expect)
+            {
+                if (10 > failed ++)
+                    printf("FAIL mask_tm(%02d:%02d): %08x, expect %08x\n", hour, minute, mask, expect);
+            }
+        }
+    }
+
+    printf("%s led_time: %u masks, %u mismatch\n", failed ? "FAIL" : "PASS", count, failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,67 @@
+/***************************************************************************
+ *  talking_button_ui[] of talking_button/talking_button_ui.h
+ *
+ *      test_ui_talking_button [session.txt]
+ *      see ui_harness.h
+***************************************************************************/
+#include "ui_harness.h"
+#include "talking_button/talking_button_ui.h"
+
+// battery is empty when guard is true
+static bool MSG_batt_is_empty(void *ctx, uint8_t event, uint8_t id)
+{
+    (void)ctx;
+    (void)event;
+    (void)id;
+    return ui_guard_false;
+}
+
+UI_STUB_ACTION(MSG_alive)
+UI_STUB_ACTION(MSG_alive_batt)
+UI_STUB_ACTION(MSG_alarm_sw)
+UI_STUB_ACTION(MSG_voice)
+
+UI_STUB_ACTION(MSG_setting_enter)
+UI_STUB_ACTION(MSG_setting_next)
+UI_STUB_ACTION(MSG_setting_adjust)
+UI_STUB_ACTION(MSG_setting_dismiss)
+UI_STUB_ACTION(MSG_setting_timeout)
+
+// guard_false column: battery is empty
+static struct UI_step_t const steps[] =
+{
+    {0,                     MSG_ALIVE,              false,  TALKING_BUTTON_UI_IDLE,     "MSG_alive"},
+    {0,                     MSG_ALARM_SW,           false,  TALKING_BUTTON_UI_IDLE,     "MSG_alarm_sw"},
+    {0,                     MSG_SETTING_TIMEOUT,    false,  TALKING_BUTTON_UI_IDLE,     NULL},
+
+    {BUTTON_PRESS,          MSG_VOICE_BUTTON,       false,  TALKING_BUTTON_UI_IDLE,     "MSG_voice"},
+    {BUTTON_RELEASE,        MSG_VOICE_BUTTON,       false,  TALKING_BUTTON_UI_IDLE,     NULL},
+    {BUTTON_PRESS,          MSG_VOICE_BUTTON,       true,   TALKING_BUTTON_UI_IDLE,     NULL},
+    {BUTTON_PRESS,          MSG_SETTING_BUTTON,     true,   TALKING_BUTTON_UI_IDLE,     "MSG_setting_dismiss"},
+
+    {BUTTON_PRESS,          MSG_SETTING_BUTTON,     false,  TALKING_BUTTON_UI_SETTING,  "MSG_setting_enter"},
+    {0,                     MSG_ALIVE,              false,  TALKING_BUTTON_UI_SETTING,  "MSG_alive_batt"},
+    {BUTTON_PRESS,          MSG_VOICE_BUTTON,       false,  TALKING_BUTTON_UI_SETTING,  "MSG_setting_adjust"},
+    {BUTTON_PRESS,          MSG_SETTING_BUTTON,     false,  TALKING_BUTTON_UI_SETTING,  "MSG_setting_next"},
+    {BUTTON_PRESS,          MSG_SETTING_BUTTON,     true,   TALKING_BUTTON_UI_SETTING,  "MSG_setting_dismiss"},
+    {0,                     MSG_ALARM_SW,           false,  TALKING_BUTTON_UI_SETTING,  "MSG_alarm_sw"},
+    {0,                     MSG_SETTING_TIMEOUT,    false,  TALKING_BUTTON_UI_IDLE,     "MSG_setting_timeout"},
+
+    // empty battery abandons setting
+    {BUTTON_PRESS,          MSG_SETTING_BUTTON,     false,  TALKING_BUTTON_UI_SETTING,  "MSG_setting_enter"},
+    {BUTTON_PRESS,          MSG_VOICE_BUTTON,       true,   TALKING_BUTTON_UI_IDLE,     NULL},
+};
+
+int main(int argc, char **argv)
+{
+    if (2 == argc)
+    {
+        return UI_HARNESS_replay(argv[1], talking_button_ui, lengthof(talking_button_ui),
+            TALKING_BUTTON_UI_IDLE);
+    }
+    else
+    {
+        return UI_HARNESS_run("talking_button_ui", talking_button_ui, lengthof(talking_button_ui),
+            TALKING_BUTTON_UI_IDLE, steps, lengthof(steps)) ? 1 : 0;
+    }
+}
@@ -0,0 +1,89 @@
+/***************************************************************************
+ *  zinc_ui[] of zinc/zinc_ui.h
+ *
+ *      test_ui_zinc [session.txt]
+ *      see ui_harness.h
+***************************************************************************/
+#include "ui_harness.h"
+#include "zinc/zinc_ui.h"
+
+UI_STUB_GUARD(MSG_lamp_is_on)
+UI_STUB_GUARD(MSG_lamp_was_on)
+
+UI_STUB_ACTION(MSG_earphone_det)
+UI_STUB_ACTION(MSG_alive)
+UI_STUB_ACTION(MSG_alive_batt)
+UI_STUB_ACTION(MSG_mynoise)
+UI_STUB_ACTION(MSG_volume)
+UI_STUB_ACTION(MSG_volume_done)
+UI_STUB_ACTION(MSG_lamp_press)
+UI_STUB_ACTION(MSG_lamp_off)
+UI_STUB_ACTION(MSG_lamp_dim)
+UI_STUB_ACTION(MSG_lamp_dim_stop)
+UI_STUB_ACTION(MSG_lamp_color)
+
+UI_STUB_ACTION(MSG_setting_enter)
+UI_STUB_ACTION(MSG_setting_done)
+UI_STUB_ACTION(MSG_setting_step)
+UI_STUB_ACTION(MSG_setting_adjust)
+UI_STUB_ACTION(MSG_setting_dim)
+UI_STUB_ACTION(MSG_setting_color)
+UI_STUB_ACTION(MSG_setting_dismiss)
+UI_STUB_ACTION(MSG_setting_timeout)
+UI_STUB_ACTION(MSG_setting_save)
+
+static struct UI_step_t const steps[] =
+{
+    {0,                     MSG_ALIVE,              false,  ZINC_UI_IDLE,       "MSG_alive"},
+    {0,                     MSG_EARPHONE_DET,       false,  ZINC_UI_IDLE,       "MSG_earphone_det"},
+    {0,                     MSG_SETTING_TIMEOUT,    false,  ZINC_UI_IDLE,       "MSG_setting_save"},
+
+    {BUTTON_PRESS,          MSG_NOISE_BUTTON,       false,  ZINC_UI_IDLE,       "MSG_mynoise"},
+    {BUTTON_PRESS,          MSG_NEXT_BUTTON,        false,  ZINC_UI_IDLE,       "MSG_mynoise"},
+    {BUTTON_RELEASE,        MSG_NEXT_BUTTON,        false,  ZINC_UI_IDLE,       NULL},
+    {BUTTON_PRESS,          MSG_SNOOZE_BUTTON,      false,  ZINC_UI_IDLE,       NULL},
+
+    {BUTTON_PRESS,          MSG_VOLUME_DOWN_BUTTON, false,  ZINC_UI_IDLE,       "MSG_volume"},
+    {BUTTON_REPEAT,         MSG_VOLUME_DOWN_BUTTON, false,  ZINC_UI_IDLE,       "MSG_volume"},
+    {BUTTON_LONG_RELEASE,   MSG_VOLUME_DOWN_BUTTON, false,  ZINC_UI_IDLE,       "MSG_volume_done"},
+
+    // LAMP: press turning on, the release keeps it on
+    {BUTTON_PRESS,          MSG_LAMP_BUTTON,        false,  ZINC_UI_IDLE,       "MSG_lamp_press"},
+    {BUTTON_RELEASE,        MSG_LAMP_BUTTON,        true,   ZINC_UI_IDLE,       NULL},
+    {BUTTON_PRESS,          MSG_LAMP_BUTTON,        false,  ZINC_UI_IDLE,       "MSG_lamp_press"},
+    {BUTTON_LONG_PRESS,     MSG_LAMP_BUTTON,        false,  ZINC_UI_IDLE,       "MSG_lamp_dim"},
+    {BUTTON_LONG_RELEASE,   MSG_LAMP_BUTTON,        false,  ZINC_UI_IDLE,       "MSG_lamp_dim_stop"},
+    {BUTTON_PRESS,          MSG_LAMP_BUTTON,        false,  ZINC_UI_IDLE,       "MSG_lamp_press"},
+    {BUTTON_RELEASE,        MSG_LAMP_BUTTON,        false,  ZINC_UI_IDLE,       "MSG_lamp_off"},
+
+    // COLOR: only when lamp is on
+    {BUTTON_PRESS,          MSG_COLOR_BUTTON,       false,  ZINC_UI_IDLE,       NULL},
+    {BUTTON_RELEASE,        MSG_COLOR_BUTTON,       true,   ZINC_UI_IDLE,       NULL},
+    {BUTTON_RELEASE,        MSG_COLOR_BUTTON,       false,  ZINC_UI_IDLE,       "MSG_lamp_color"},
+    {BUTTON_LONG_PRESS,     MSG_COLOR_BUTTON,       false,  ZINC_UI_IDLE,       "MSG_lamp_dim"},
+    {BUTTON_LONG_RELEASE,   MSG_COLOR_BUTTON,       false,  ZINC_UI_IDLE,       "MSG_lamp_dim_stop"},
+
+    // setting
+    {BUTTON_PRESS,          MSG_TIMER_BUTTON,       false,  ZINC_UI_SETTING,    "MSG_setting_enter"},
+    {0,                     MSG_ALIVE,              false,  ZINC_UI_SETTING,    "MSG_alive_batt"},
+    {BUTTON_PRESS,          MSG_NEXT_BUTTON,        false,  ZINC_UI_SETTING,    "MSG_setting_step"},
+    {BUTTON_PRESS,          MSG_PREV_BUTTON,        false,  ZINC_UI_SETTING,    "MSG_setting_step"},
+    {BUTTON_REPEAT,         MSG_VOLUME_UP_BUTTON,   false,  ZINC_UI_SETTING,    NULL},
+    {BUTTON_PRESS,          MSG_VOLUME_UP_BUTTON,   false,  ZINC_UI_SETTING,    "MSG_setting_adjust"},
+    {BUTTON_PRESS,          MSG_SETTING_DIM,        false,  ZINC_UI_SETTING,    "MSG_setting_dim"},
+    {BUTTON_PRESS,          MSG_COLOR_BUTTON,       false,  ZINC_UI_SETTING,    "MSG_setting_color"},
+    {BUTTON_PRESS,          MSG_NOISE_BUTTON,       false,  ZINC_UI_SETTING,    "MSG_setting_dismiss"},
+    {0,                     MSG_EARPHONE_DET,       false,  ZINC_UI_SETTING,    "MSG_earphone_det"},
+    {BUTTON_PRESS,          MSG_TIMER_BUTTON,       false,  ZINC_UI_IDLE,       "MSG_setting_done"},
+
+    {BUTTON_PRESS,          MSG_TIMER_BUTTON,       false,  ZINC_UI_SETTING,    "MSG_setting_enter"},
+    {0,                     MSG_SETTING_TIMEOUT,    false,  ZINC_UI_IDLE,       "MSG_setting_timeout"},
+};
+
+int main(int argc, char **argv)
+{
+    if (2 == argc)
+        return UI_HARNESS_replay(argv[1], zinc_ui, lengthof(zinc_ui), ZINC_UI_IDLE);
+    else
+        return UI_HARNESS_run("zinc_ui", zinc_ui, lengthof(zinc_ui), ZINC_UI_IDLE, steps, lengthof(steps)) ? 1 : 0;
+}
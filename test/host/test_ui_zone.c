@@ -0,0 +1,95 @@
+/***************************************************************************
+ *  zone_ui[] of zone/zone_ui.h
+ *
+ *      test_ui_zone [session.txt]
+ *      see ui_harness.h
+***************************************************************************/
+#include "ui_harness.h"
+#include "zone/zone_ui.h"
+
+UI_STUB_GUARD(MSG_top_is_free)
+UI_STUB_GUARD(MSG_power_is_free)
+UI_STUB_GUARD(MSG_prev_next_is_free)
+
+UI_STUB_ACTION(MSG_alive)
+UI_STUB_ACTION(MSG_alive_batt)
+UI_STUB_ACTION(MSG_top_press)
+UI_STUB_ACTION(MSG_top_voice)
+UI_STUB_ACTION(MSG_top_mynoise)
+UI_STUB_ACTION(MSG_power_press)
+UI_STUB_ACTION(MSG_power_down)
+UI_STUB_ACTION(MSG_power_wakeup)
+UI_STUB_ACTION(MSG_power_mynoise)
+UI_STUB_ACTION(MSG_prev_next_press)
+UI_STUB_ACTION(MSG_prev_next_release)
+UI_STUB_ACTION(MSG_volume)
+UI_STUB_ACTION(MSG_volume_done)
+
+UI_STUB_ACTION(MSG_setting_enter)
+UI_STUB_ACTION(MSG_setting_done)
+UI_STUB_ACTION(MSG_setting_step)
+UI_STUB_ACTION(MSG_setting_adjust)
+UI_STUB_ACTION(MSG_setting_dismiss)
+UI_STUB_ACTION(MSG_setting_timeout)
+UI_STUB_ACTION(MSG_setting_save)
+
+static struct UI_step_t const steps[] =
+{
+    {0,                     MSG_ALIVE,              false,  ZONE_UI_IDLE,       "MSG_alive"},
+    {0,                     MSG_SETTING_TIMEOUT,    false,  ZONE_UI_IDLE,       "MSG_setting_save"},
+
+    // TOP: long press says time, release after it does nothing
+    {BUTTON_PRESS,          MSG_TOP_BUTTON,         false,  ZONE_UI_IDLE,       "MSG_top_press"},
+    {BUTTON_LONG_PRESS,     MSG_TOP_BUTTON,         false,  ZONE_UI_IDLE,       "MSG_top_voice"},
+    {BUTTON_LONG_RELEASE,   MSG_TOP_BUTTON,         false,  ZONE_UI_IDLE,       NULL},
+    {BUTTON_PRESS,          MSG_TOP_BUTTON,         false,  ZONE_UI_IDLE,       "MSG_top_press"},
+    {BUTTON_RELEASE,        MSG_TOP_BUTTON,         false,  ZONE_UI_IDLE,       "MSG_top_mynoise"},
+    // press was consumed by dismissing an alarm
+    {BUTTON_RELEASE,        MSG_TOP_BUTTON,         true,   ZONE_UI_IDLE,       NULL},
+
+    // VOLUME
+    {BUTTON_PRESS,          MSG_VOLUME_UP_BUTTON,   false,  ZONE_UI_IDLE,       "MSG_volume"},
+    {BUTTON_REPEAT,         MSG_VOLUME_UP_BUTTON,   false,  ZONE_UI_IDLE,       "MSG_volume"},
+    {BUTTON_LONG_RELEASE,   MSG_VOLUME_UP_BUTTON,   false,  ZONE_UI_IDLE,       "MSG_volume_done"},
+    {BUTTON_PRESS,          MSG_VOLUME_DOWN_BUTTON, false,  ZONE_UI_IDLE,       "MSG_volume"},
+    {BUTTON_RELEASE,        MSG_VOLUME_DOWN_BUTTON, false,  ZONE_UI_IDLE,       "MSG_volume_done"},
+
+    // PREV / NEXT: long press enters setting only when free
+    {BUTTON_PRESS,          MSG_NEXT_BUTTON,        false,  ZONE_UI_IDLE,       "MSG_prev_next_press"},
+    {BUTTON_LONG_PRESS,     MSG_NEXT_BUTTON,        true,   ZONE_UI_IDLE,       NULL},
+    {BUTTON_LONG_RELEASE,   MSG_NEXT_BUTTON,        false,  ZONE_UI_IDLE,       "MSG_prev_next_release"},
+    {BUTTON_PRESS,          MSG_PREV_BUTTON,        false,  ZONE_UI_IDLE,       "MSG_prev_next_press"},
+    {BUTTON_LONG_PRESS,     MSG_PREV_BUTTON,        false,  ZONE_UI_SETTING,    "MSG_setting_enter"},
+
+    // setting
+    {0,                     MSG_ALIVE,              false,  ZONE_UI_SETTING,    "MSG_alive_batt"},
+    {BUTTON_LONG_RELEASE,   MSG_PREV_BUTTON,        false,  ZONE_UI_SETTING,    NULL},
+    {BUTTON_PRESS,          MSG_NEXT_BUTTON,        false,  ZONE_UI_SETTING,    "MSG_setting_step"},
+    {BUTTON_PRESS,          MSG_PREV_BUTTON,        false,  ZONE_UI_SETTING,    "MSG_setting_step"},
+    {BUTTON_PRESS,          MSG_VOLUME_UP_BUTTON,   false,  ZONE_UI_SETTING,    "MSG_setting_adjust"},
+    {BUTTON_RELEASE,        MSG_VOLUME_UP_BUTTON,   false,  ZONE_UI_SETTING,    NULL},
+    {BUTTON_PRESS,          MSG_TOP_BUTTON,         false,  ZONE_UI_SETTING,    "MSG_setting_dismiss"},
+    {BUTTON_PRESS,          MSG_POWER_BUTTON,       false,  ZONE_UI_IDLE,       "MSG_setting_done"},
+
+    {BUTTON_PRESS,          MSG_NEXT_BUTTON,        false,  ZONE_UI_IDLE,       "MSG_prev_next_press"},
+    {BUTTON_LONG_PRESS,     MSG_NEXT_BUTTON,        false,  ZONE_UI_SETTING,    "MSG_setting_enter"},
+    {0,                     MSG_SETTING_TIMEOUT,    false,  ZONE_UI_IDLE,       "MSG_setting_timeout"},
+
+    // POWER: long press powers down, only POWER press wakes up
+    {BUTTON_PRESS,          MSG_POWER_BUTTON,       false,  ZONE_UI_IDLE,       "MSG_power_press"},
+    {BUTTON_RELEASE,        MSG_POWER_BUTTON,       false,  ZONE_UI_IDLE,       "MSG_power_mynoise"},
+    {BUTTON_PRESS,          MSG_POWER_BUTTON,       false,  ZONE_UI_IDLE,       "MSG_power_press"},
+    {BUTTON_LONG_PRESS,     MSG_POWER_BUTTON,       false,  ZONE_UI_POWER_DOWN, "MSG_power_down"},
+    {BUTTON_LONG_RELEASE,   MSG_POWER_BUTTON,       false,  ZONE_UI_POWER_DOWN, NULL},
+    {0,                     MSG_ALIVE,              false,  ZONE_UI_POWER_DOWN, NULL},
+    {BUTTON_PRESS,          MSG_TOP_BUTTON,         false,  ZONE_UI_POWER_DOWN, NULL},
+    {BUTTON_PRESS,          MSG_POWER_BUTTON,       false,  ZONE_UI_IDLE,       "MSG_power_wakeup"},
+};
+
+int main(int argc, char **argv)
+{
+    if (2 == argc)
+        return UI_HARNESS_replay(argv[1], zone_ui, lengthof(zone_ui), ZONE_UI_IDLE);
+    else
+        return UI_HARNESS_run("zone_ui", zone_ui, lengthof(zone_ui), ZONE_UI_IDLE, steps, lengthof(steps)) ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+/***************************************************************************
+ *  ws2812b_driver.c encoder & bit timing
+ *
+ *      test_ws2812b
+ *      PWM slot timing of WS2812B_TIMER_CLOCK against the datasheet windows,
+ *      every byte value in every GRB position, then random frames against bit by bit encoding
+***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ws2812b_driver.h"
+
+#define TOLERANCE_NS                    (150)
+
+static unsigned failed;
+
+static void check_ns(char const *name, unsigned ticks, unsigned expect_ns)
+{
+    double ns = (double)ticks * 1e9 / WS2812B_TIMER_CLOCK;
+
+    if (ns < expect_ns - TOLERANCE_NS || ns > expect_ns + TOLERANCE_NS)
+    {
+        printf("FAIL %s: %u ticks = %.0f ns, expect %u +-%u ns\n", name, ticks, ns, expect_ns, TOLERANCE_NS);
+        failed ++;
+    }
+}
+
+// GRB, MSB first: one compare value per bit
+static void ref_encode(uint8_t *slots, uint32_t const *rgb, unsigned count)
+{
+    for (unsigned i = 0; i < count; i ++)
+    {
+        uint32_t grb = (rgb[i] & 0x00FF00) << 8 | (rgb[i] & 0xFF0000) >> 8 | (rgb[i] & 0x0000FF);
+
+        for (unsigned bit = 0; bit < 24; bit ++)
+            *slots ++ = (uint8_t)(grb & (1UL << (23 - bit)) ? WS2812B_T1H : WS2812B_T0H);
+    }
+    *slots = 0;
+}
+
+static void check_frame(uint32_t const *rgb, unsigned count)
+{
+    static uint8_t slots[WS2812B_ENCODED_SIZE(WS2812B_MAX_LEDS) + 1];
+    static uint8_t expect[WS2812B_ENCODED_SIZE(WS2812B_MAX_LEDS)];
+
+    // guard slot: encoder writes exactly its size
+    slots[WS2812B_ENCODED_SIZE(count)] = 0xA5;
+
+    size_t size = WS2812B_encode(slots, rgb, count);
+    ref_encode(expect, rgb, count);
+
+    if (WS2812B_ENCODED_SIZE(count) != size || 0xA5 != slots[size])
+    {
+        if (10 > failed ++)
+            printf("FAIL encode %u LEDs: size %zu\n", count, size);
+        return;
+    }
+    for (size_t i = 0; i < size; i ++)
+    {
+        if (expect[i] != slots[i])
+        {
+            if (10 > failed ++)
+                printf("FAIL encode %u LEDs %06x: slot %zu = %u, expect %u\n",
+                    count, rgb[i / 24 < count ? i / 24 : 0], i, slots[i], expect[i]);
+            return;
+        }
+    }
+}
+
+int main(void)
+{
+    unsigned frames = 0;
+
+    // datasheet: T0H 400 / T0L 850, T1H 800 / T1L 450
+    check_ns("T0H", WS2812B_T0H, WS2812B_T0H_NS);
+    check_ns("T1H", WS2812B_T1H, WS2812B_T1H_NS);
+    check_ns("T0L", WS2812B_PERIOD - WS2812B_T0H, WS2812B_PERIOD_NS - WS2812B_T0H_NS);
+    check_ns("T1L", WS2812B_PERIOD - WS2812B_T1H, WS2812B_PERIOD_NS - WS2812B_T1H_NS);
+
+    if (256 <= WS2812B_PERIOD || WS2812B_T1H <= WS2812B_T0H || 0 == WS2812B_T0H)
+    {
+        printf("FAIL slots: period %u, T0H %u, T1H %u\n", WS2812B_PERIOD, WS2812B_T0H, WS2812B_T1H);
+        failed ++;
+    }
+    // reset latch: the trailing 0 slot holds the line low, driver waits WS2812B_RESET_US after it
+    if (280 > WS2812B_RESET_US)
+    {
+        printf("FAIL reset %u us\n", WS2812B_RESET_US);
+        failed ++;
+    }
+
+    for (unsigned shift = 0; shift < 24; shift += 8)
+    {
+        for (uint32_t val = 0; val < 256; val ++)
+        {
+            uint32_t rgb = val << shift;
+            check_frame(&rgb, 1);
+            frames ++;
+        }
+    }
+
+    srand(1);
+    for (unsigned i = 0; i < 10000; i ++)
+    {
+        uint32_t rgb[WS2812B_MAX_LEDS];
+        unsigned count = 1 + (unsigned)rand() % WS2812B_MAX_LEDS;
+
+        for (unsigned n = 0; n < count; n ++)
+            rgb[n] = ((uint32_t)rand() << 8 ^ (uint32_t)rand()) & 0xFFFFFF;
+
+        check_frame(rgb, count);
+        frames ++;
+    }
+
+    printf("%s ws2812b @%u Hz: T0H %u / T1H %u of %u ticks, %u frames, transfer %u us\n",
+        failed ? "FAIL" : "PASS", (unsigned)WS2812B_TIMER_CLOCK,
+        WS2812B_T0H, WS2812B_T1H, WS2812B_PERIOD, frames, (unsigned)WS2812B_TRANSFER_US);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,126 @@
+#ifndef __UI_HARNESS_H
+#define __UI_HARNESS_H                  1
+
+/***************************************************************************
+ *  ui_fsm.c against product tables of zone_ui.h, zinc_ui.h, talking_button_ui.h
+ *
+ *      test_ui_<product>
+ *          run the built-in script: every step is a message, expected state & action after it
+ *      test_ui_<product> <session.txt>
+ *          replay a recorded button session, one "event id" message per line,
+ *          a "!" suffix makes the guards false for that message.
+ *          prints state / action / ticks per message, then dispatched / unhandled / ticks totals
+***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ui_fsm.h"
+
+    struct UI_step_t
+    {
+        uint8_t event;
+        uint8_t id;
+        bool guard_false;
+
+        uint8_t state;
+        char const *action;             // NULL: no action runs
+    };
+
+static char const *ui_action;
+static bool ui_guard_false;
+
+    /**
+     *  actions record their name, guards return what the step says
+     */
+    #define UI_STUB_ACTION(NAME)        \
+        static void NAME(void *ctx, uint8_t event, uint8_t id) \
+        {                               \
+            (void)ctx;                  \
+            (void)event;                \
+            (void)id;                   \
+            ui_action = #NAME;          \
+        }
+
+    #define UI_STUB_GUARD(NAME)         \
+        static bool NAME(void *ctx, uint8_t event, uint8_t id) \
+        {                               \
+            (void)ctx;                  \
+            (void)event;                \
+            (void)id;                   \
+            return ! ui_guard_false;    \
+        }
+
+static
+    int UI_HARNESS_run(char const *name, struct UI_transition_t const *tbl, uint8_t count,
+        uint8_t initial_state, struct UI_step_t const *steps, unsigned step_count)
+    {
+        struct UI_fsm_t fsm;
+        int failed = 0;
+
+        UI_FSM_init(&fsm, tbl, count, initial_state, NULL);
+
+        for (unsigned idx = 0; idx < step_count; idx ++)
+        {
+            struct UI_step_t const *step = &steps[idx];
+
+            ui_action = NULL;
+            ui_guard_false = step->guard_false;
+            UI_FSM_dispatch(&fsm, (unsigned)step->event << 8 | step->id);
+
+            bool action_ok = step->action ? (ui_action && 0 == strcmp(step->action, ui_action)) : ! ui_action;
+            if (step->state != UI_FSM_state(&fsm) || ! action_ok)
+            {
+                printf("FAIL %s step %u: event %u id 0x%02x => state %u %s, expect %u %s\n", name, idx,
+                    step->event, step->id, UI_FSM_state(&fsm), ui_action ? ui_action : "-",
+                    step->state, step->action ? step->action : "-");
+                failed ++;
+            }
+        }
+
+        printf("%s %s: %u steps, %u dispatched, %u unhandled\n", failed ? "FAIL" : "PASS", name,
+            step_count, (unsigned)fsm.dispatched, (unsigned)fsm.unhandled);
+        return failed;
+    }
+
+static
+    int UI_HARNESS_replay(char const *path, struct UI_transition_t const *tbl, uint8_t count,
+        uint8_t initial_state)
+    {
+        FILE *fp = fopen(path, "r");
+        if (! fp)
+        {
+            perror(path);
+            return 2;
+        }
+
+        struct UI_fsm_t fsm;
+        char line[64];
+
+        UI_FSM_init(&fsm, tbl, count, initial_state, NULL);
+
+        while (fgets(line, sizeof(line), fp))
+        {
+            char *p;
+            unsigned event = (unsigned)strtoul(line, &p, 0);
+            if (p == line)
+                continue;   // blank / comment
+            unsigned id = (unsigned)strtoul(p, &p, 0);
+
+            ui_action = NULL;
+            ui_guard_false = (NULL != strchr(p, '!'));
+
+            clock_t ticks = fsm.ticks_total;
+            UI_FSM_dispatch(&fsm, event << 8 | (id & 0xFF));
+
+            printf("%u 0x%02x => state %u %s %lu\n", event, id, UI_FSM_state(&fsm),
+                ui_action ? ui_action : "-", (unsigned long)(fsm.ticks_total - ticks));
+        }
+        fclose(fp);
+
+        printf("%u dispatched, %u unhandled, ticks %lu total %lu max\n", (unsigned)fsm.dispatched,
+            (unsigned)fsm.unhandled, (unsigned long)fsm.ticks_total, (unsigned long)fsm.ticks_max);
+        return 0;
+    }
+
+#endif
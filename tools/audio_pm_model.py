@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""
+    host model of audio_pm.c: break-even tuning of AUDIO_PM_BREAK_EVEN_MS / AUDIO_PM_PREPOWER_MS
+
+    storage stays powered at --idle-ua between utterances, or is powered down (--off-ua) and
+    re-initialized ahead of the next one, costing --init-ua for --init-ms. powering down pays
+    off when the gap exceeds
+
+        break_even = init_ua * init_ms / (idle_ua - off_ua)
+
+    the schedule replay compares charge per day of "always powered" against the policy
+    (settle, power down, pre-power) for reminder intervals, zero hour announcements and
+    an utterance length, and prints #defines for PERIPHERAL_config.h.
+"""
+import argparse
+import math
+
+
+def break_even_ms(args) -> float:
+    saving_ua = args.idle_ua - args.off_ua
+    if saving_ua <= 0:
+        return float('inf')
+    return args.init_ua * args.init_ms / saving_ua
+
+
+def schedule(args) -> list:
+    """ playback start seconds within a day """
+    starts = set()
+    if args.zero_hour:
+        starts.update(h * 3600 for h in range(24))
+    for begin, seconds in args.reminder:
+        t = begin
+        while t < begin + seconds:
+            starts.add(t % 86400)
+            t += args.intv
+    return sorted(starts)
+
+
+def day_charge_uah(starts: list, args, threshold_ms: float) -> tuple:
+    """ returns (uAh, power cycles) of storage for one day with given break-even threshold """
+    uas = 0.0
+    cycles = 0
+    utter = args.utter_ms / 1000
+
+    for i, start in enumerate(starts):
+        nxt = starts[(i + 1) % len(starts)] + (86400 if i + 1 == len(starts) else 0)
+        gap = nxt - start - utter
+        uas += args.play_ua * utter
+
+        if gap * 1000 <= threshold_ms:
+            uas += args.idle_ua * gap
+        else:
+            on = (args.settle_ms + args.prepower_ms) / 1000
+            uas += args.idle_ua * on + args.off_ua * (gap - on) + args.init_ua * args.init_ms / 1000
+            cycles += 1
+
+    return uas / 3600, cycles
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--idle-ua', type=float, default=300, help='storage & codec powered, not playing')
+    parser.add_argument('--off-ua', type=float, default=5, help='storage powered down')
+    parser.add_argument('--play-ua', type=float, default=45000, help='while playing')
+    parser.add_argument('--init-ua', type=float, default=20000, help='SD card initialization current')
+    parser.add_argument('--init-ms', type=float, default=120, help='SD card initialization time')
+    parser.add_argument('--utter-ms', type=float, default=3000, help='utterance length')
+    parser.add_argument('--settle-ms', type=float, default=500, help='AUDIO_PM_SETTLE_MS')
+    parser.add_argument('--prepower-ms', type=float, default=400, help='AUDIO_PM_PREPOWER_MS')
+    parser.add_argument('--intv', type=int, default=60, help='reminder_intv_seconds')
+    parser.add_argument('--reminder', type=lambda v: tuple(int(x) for x in v.split(':')), action='append',
+        default=[], help='start_second:duration_seconds of a reminder, repeatable')
+    parser.add_argument('--zero-hour', action='store_true', help='hourly time announcement')
+    args = parser.parse_args()
+
+    if not args.reminder and not args.zero_hour:
+        args.reminder = [(7 * 3600, 1200)]
+    if args.prepower_ms < args.init_ms:
+        print(f'WARNING: pre-power {args.prepower_ms} ms is shorter than card init {args.init_ms} ms')
+
+    be = break_even_ms(args)
+    starts = schedule(args)
+    always, _ = day_charge_uah(starts, args, float('inf'))
+
+    print(f'break-even gap: {be:.0f} ms, playbacks/day: {len(starts)}')
+    print(f'{"threshold":>12} {"uAh/day":>10} {"saved":>8} {"cycles":>7}')
+    for threshold in sorted({be, 2000, 5000, 10000, 30000, 60000}):
+        uah, cycles = day_charge_uah(starts, args, threshold)
+        print(f'{threshold:>10.0f}ms {uah:>10.1f} {always - uah:>8.1f} {cycles:>7}')
+
+    print()
+    print(f'    #define AUDIO_PM_BREAK_EVEN_MS      ({max(math.ceil(be), int(args.settle_ms + args.prepower_ms) + 1)})')
+    print(f'    #define AUDIO_PM_PREPOWER_MS        ({int(args.prepower_ms)})')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""
+    fit battery load model from discharge traces logged by PERIPHERAL_batt_schedule()
+
+        batt: ts=<seconds> mv=<mV> loads=0x<BATT_load_t> led=<0~100> level=<0~100>
+
+    charge drawn between two trace points separated by at least --window seconds is taken
+    from the voltage curve (BATT_mv_level), and is solved by least squares against the time
+    spent in each load: idle, voice, noise, LED (brightness scaled) and BLE.
+    prints #defines for PERIPHERAL_config.h, then replays the estimator (battery.c) with the
+    fitted model and reports the runtime prediction error against the trace.
+"""
+import argparse
+import re
+import sys
+
+LOAD_VOICE = 0x01
+LOAD_NOISE = 0x02
+LOAD_LED = 0x04
+LOAD_BLE = 0x08
+
+NAMES = ['BATT_IDLE_UA', 'BATT_VOICE_UA', 'BATT_NOISE_UA', 'BATT_LED_FULL_UA', 'BATT_BLE_UA']
+DEFAULTS = [1500, 60000, 45000, 120000, 3000]
+
+TRACE = re.compile(r'batt: ts=(\d+) mv=(\d+) loads=0x([0-9a-fA-F]+) led=(\d+)')
+
+
+def mv_level(mv: int, full: int, low: int, empty: int) -> float:
+    """ mirror of BATT_mv_level() """
+    if mv < low:
+        return 0.0 if mv < empty else (mv - empty) * 10 / (low - empty)
+    else:
+        return 100.0 if mv >= full else 10 + (mv - low) * 90 / (full - low)
+
+
+def features(loads: int, led: int) -> list:
+    return [
+        1.0,
+        1.0 if loads & LOAD_VOICE else 0.0,
+        1.0 if loads & LOAD_NOISE else 0.0,
+        led / 100 if loads & LOAD_LED else 0.0,
+        1.0 if loads & LOAD_BLE else 0.0,
+    ]
+
+
+def load_ua(model: list, loads: int, led: int) -> float:
+    return sum(m * f for m, f in zip(model, features(loads, led)))
+
+
+def parse(files: list) -> list:
+    points = []
+    for name in files:
+        with open(name, errors='replace') as f:
+            for line in f:
+                m = TRACE.search(line)
+                if m:
+                    points.append((int(m[1]), int(m[2]), int(m[3], 16), int(m[4])))
+    points.sort()
+    return points
+
+
+def solve(ata: list, atb: list) -> list:
+    """ gaussian elimination, unknowns without observations are left 0 """
+    n = len(atb)
+    a = [row[:] + [atb[i]] for i, row in enumerate(ata)]
+
+    for col in range(n):
+        pivot = max(range(col, n), key=lambda r: abs(a[r][col]))
+        if abs(a[pivot][col]) < 1e-9:
+            continue
+        a[col], a[pivot] = a[pivot], a[col]
+        for r in range(n):
+            if r != col and a[r][col] != 0:
+                k = a[r][col] / a[col][col]
+                a[r] = [x - k * y for x, y in zip(a[r], a[col])]
+
+    return [a[i][n] / a[i][i] if abs(a[i][i]) >= 1e-9 else 0.0 for i in range(n)]
+
+
+def fit(points: list, args) -> list:
+    rows = []
+    start = 0
+    hours = [0.0] * 5
+
+    for i in range(1, len(points)):
+        ts, _, loads, led = points[i - 1]
+        dt = (points[i][0] - ts) / 3600
+        hours = [h + f * dt for h, f in zip(hours, features(loads, led))]
+
+        if args.window <= points[i][0] - points[start][0]:
+            drop = mv_level(points[start][1], args.full, args.low, args.empty) - \
+                mv_level(points[i][1], args.full, args.low, args.empty)
+            rows.append((hours, drop / 100 * args.capacity * 1000))
+            start = i
+            hours = [0.0] * 5
+
+    if not rows:
+        sys.exit('batt_fit: trace is shorter than --window')
+
+    n = len(DEFAULTS)
+    ata = [[sum(r[0][i] * r[0][j] for r in rows) for j in range(n)] for i in range(n)]
+    atb = [sum(r[0][i] * r[1] for r in rows) for i in range(n)]
+
+    # unobserved loads keep firmware defaults
+    observed = [any(r[0][i] > 0 for r in rows) for i in range(n)]
+    model = solve(ata, atb)
+    return [max(0, round(m)) if o else d for m, o, d in zip(model, observed, DEFAULTS)]
+
+
+def replay(points: list, model: list, args):
+    """ mirror of BATT_estimator_*(), prints predicted runtime against the real end of trace """
+    capacity = args.capacity * 1000
+    charge = capacity * mv_level(points[0][1], args.full, args.low, args.empty) / 100
+    avg = model[0]
+    end = next((p[0] for p in points if p[1] < args.empty), points[-1][0])
+
+    for i in range(1, len(points)):
+        ts, mv, loads, led = points[i - 1]
+        dt = points[i][0] - ts
+        ua = load_ua(model, loads, led)
+
+        charge = max(0.0, charge - ua * dt / 3600)
+        avg += (ua - avg) * dt / (dt + args.avg_seconds)
+        charge += (capacity * mv_level(points[i][1], args.full, args.low, args.empty) / 100 - charge) / 8
+
+        if 0 == i % args.every:
+            predicted = charge / avg if avg else 0
+            actual = (end - points[i][0]) / 3600
+            print(f'ts={points[i][0]} mv={points[i][1]} predicted={predicted:.1f}h actual={actual:.1f}h')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('trace', nargs='+', help='log files containing "batt: ts=..." lines')
+    parser.add_argument('--capacity', type=int, default=2000, help='BATT_CAPACITY_MAH')
+    parser.add_argument('--full', type=int, default=4150, help='BATT_FULL_MV')
+    parser.add_argument('--low', type=int, default=3150, help='BATT_LOW_MV')
+    parser.add_argument('--empty', type=int, default=3000, help='BATT_EMPTY_MV')
+    parser.add_argument('--window', type=int, default=4 * 3600, help='min seconds per fitted segment')
+    parser.add_argument('--avg-seconds', type=int, default=24 * 3600, help='BATT_EST_AVG_SECONDS')
+    parser.add_argument('--every', type=int, default=20, help='replay report interval in trace points')
+    args = parser.parse_args()
+
+    points = parse(args.trace)
+    if 2 > len(points):
+        sys.exit('batt_fit: no trace')
+
+    model = fit(points, args)
+    for name, value in zip(NAMES, model):
+        print(f'    #define {name:<27} ({value})')
+    print()
+    replay(points, model, args)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,198 @@
+#!/usr/bin/env python3
+"""
+    host replay of "dtrace dump" against a simulated DISKIO sector cache
+
+    every trace line "lba count hit us tag" is a sector read requested by FAT, the simulator
+    replays the requests of each tag (voice / noise / usb / other) against LRU, FIFO and CLOCK
+    caches of --sizes sectors with --readahead sectors fetched after every miss, and reports
+    hit rates and card reads. the best read-ahead per tag goes to PERIPHERAL_config.h:
+
+        DISKIO_CACHE_COUNT / DISKIO_READAHEAD_DEFAULT / DISKIO_READAHEAD_VOICE / DISKIO_READAHEAD_NOISE
+
+    card reads are weighted by --miss-us + --sector-us per sector, so that read-ahead is not
+    free: a read-ahead that is never hit costs transfer time and evicts useful sectors.
+"""
+import argparse
+import collections
+import sys
+
+
+class Cache:
+    def __init__(self, size: int):
+        self.size = size
+
+    def lookup(self, lba: int) -> bool:
+        raise NotImplementedError
+
+    def insert(self, lba: int):
+        raise NotImplementedError
+
+
+class LRU(Cache):
+    def __init__(self, size: int):
+        super().__init__(size)
+        self.sectors = collections.OrderedDict()
+
+    def lookup(self, lba: int) -> bool:
+        if lba in self.sectors:
+            self.sectors.move_to_end(lba)
+            return True
+        return False
+
+    def insert(self, lba: int):
+        if lba in self.sectors:
+            return
+        if len(self.sectors) >= self.size:
+            self.sectors.popitem(last=False)
+        self.sectors[lba] = None
+
+
+class FIFO(Cache):
+    def __init__(self, size: int):
+        super().__init__(size)
+        self.sectors = collections.OrderedDict()
+
+    def lookup(self, lba: int) -> bool:
+        return lba in self.sectors
+
+    def insert(self, lba: int):
+        if lba in self.sectors:
+            return
+        if len(self.sectors) >= self.size:
+            self.sectors.popitem(last=False)
+        self.sectors[lba] = None
+
+
+class CLOCK(Cache):
+    def __init__(self, size: int):
+        super().__init__(size)
+        self.slots = [None] * size
+        self.ref = [False] * size
+        self.index = {}
+        self.hand = 0
+
+    def lookup(self, lba: int) -> bool:
+        slot = self.index.get(lba)
+        if slot is None:
+            return False
+        self.ref[slot] = True
+        return True
+
+    def insert(self, lba: int):
+        if lba in self.index:
+            return
+        while self.ref[self.hand]:
+            self.ref[self.hand] = False
+            self.hand = (self.hand + 1) % self.size
+        victim = self.slots[self.hand]
+        if victim is not None:
+            del self.index[victim]
+        self.slots[self.hand] = lba
+        self.index[lba] = self.hand
+        self.hand = (self.hand + 1) % self.size
+
+
+POLICIES = {'lru': LRU, 'fifo': FIFO, 'clock': CLOCK}
+
+
+def parse(lines) -> list:
+    """ returns [(lba, count, hit, us, tag)] """
+    trace = []
+    for line in lines:
+        line = line.strip()
+        if not line or line.startswith('#'):
+            continue
+        fields = line.split()
+        if len(fields) != 5:
+            continue
+        try:
+            trace.append((int(fields[0]), int(fields[1]), int(fields[2]), int(fields[3]), fields[4]))
+        except ValueError:
+            continue
+    return trace
+
+
+def replay(trace: list, policy: str, size: int, readahead: int, args) -> tuple:
+    """ returns (hit rate, card reads, card sectors, estimated us) """
+    cache = POLICIES[policy](size)
+    hits = sectors = reads = read_sectors = 0
+
+    for lba, count, _hit, _us, _tag in trace:
+        for sector in range(lba, lba + max(count, 1)):
+            sectors += 1
+            if cache.lookup(sector):
+                hits += 1
+                continue
+
+            # miss: one card read of the sector plus read-ahead
+            reads += 1
+            read_sectors += 1 + readahead
+            for ahead in range(sector, sector + 1 + readahead):
+                cache.insert(ahead)
+
+    us = reads * args.miss_us + read_sectors * args.sector_us
+    return (hits / sectors if sectors else 0.0), reads, read_sectors, us
+
+
+def measured(trace: list) -> str:
+    sectors = sum(max(e[1], 1) for e in trace)
+    hits = sum(max(e[1], 1) for e in trace if e[2])
+    us = sum(e[3] for e in trace)
+    return f'{len(trace)} reads, {sectors} sectors, measured hit {hits / sectors:.1%}, {us} us'
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('trace', nargs='?', type=argparse.FileType('r'), default=sys.stdin,
+        help='output of "dtrace dump", stdin by default')
+    parser.add_argument('--sizes', type=lambda v: [int(x) for x in v.split(',')], default=[16, 32, 48, 64, 96],
+        help='cache sizes in sectors, comma separated')
+    parser.add_argument('--readahead', type=lambda v: [int(x) for x in v.split(',')], default=[0, 1, 2, 4, 8, 16],
+        help='read-ahead sectors, comma separated')
+    parser.add_argument('--policy', choices=sorted(POLICIES), action='append', help='repeatable, all by default')
+    parser.add_argument('--miss-us', type=float, default=900, help='card command overhead per read')
+    parser.add_argument('--sector-us', type=float, default=60, help='transfer time per sector')
+    args = parser.parse_args()
+
+    policies = args.policy or sorted(POLICIES)
+    trace = parse(args.trace)
+    if not trace:
+        sys.exit('empty trace')
+
+    tags = sorted({e[4] for e in trace})
+    best = {}
+
+    for tag in tags:
+        sub = [e for e in trace if e[4] == tag]
+        print(f'== {tag}: {measured(sub)}')
+        print(f'{"policy":>6} {"size":>5} {"ahead":>5} {"hit":>7} {"reads":>7} {"sectors":>8} {"est ms":>9}')
+
+        for policy in policies:
+            for size in args.sizes:
+                for readahead in args.readahead:
+                    if readahead >= size:
+                        continue
+                    rate, reads, read_sectors, us = replay(sub, policy, size, readahead, args)
+                    print(f'{policy:>6} {size:>5} {readahead:>5} {rate:>7.1%} {reads:>7} {read_sectors:>8} {us / 1000:>9.1f}')
+
+                    key = (us, size, readahead)
+                    if tag not in best or key < best[tag][0]:
+                        best[tag] = (key, policy)
+        print()
+
+    print('best by estimated card time:')
+    for tag in tags:
+        (us, size, readahead), policy = best[tag]
+        print(f'    {tag:<6} {policy:<6} size {size:<4} read-ahead {readahead:<3} {us / 1000:.1f} ms')
+
+    print()
+    print(f'    #define DISKIO_CACHE_COUNT          ({max(best[t][0][1] for t in tags)})')
+    # idle profile serves both USB mass storage and shell file I/O
+    idle = 'usb' if 'usb' in best else 'other'
+    for name, tag in (('DEFAULT', idle), ('VOICE', 'voice'), ('NOISE', 'noise')):
+        if tag in best:
+            print(f'    #define DISKIO_READAHEAD_{name:<9}  ({best[tag][0][2]})')
+
+
+if __name__ == '__main__':
+    main()
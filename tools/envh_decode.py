@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+"""
+    decode "envh samples|hours|days [from] [to]" output of the shell (env_history.c)
+
+        envh <kind> <record size> <count>\n
+        <count> records as is, little endian
+
+    samples are delta decoded blocks, printed as "<ts> <tmpr °C> <humidity %>",
+    hours / days as "<ts> <tmpr min> <max> <avg> <humidity min> <max> <avg>", --csv for charts.
+    block size depends on ENVH_BLOCK_SAMPLES, it is taken from the record size.
+"""
+import argparse
+import struct
+import sys
+
+SAMPLE_INTV = 300
+ROLLUP = struct.Struct('<IhhhBBB3x')
+BLOCK_HEADER = struct.Struct('<IhBB')
+
+
+def decode_blocks(payload, size, count):
+    for i in range(count):
+        rec = payload[i * size:(i + 1) * size]
+        ts, tmpr, humidity, samples = BLOCK_HEADER.unpack_from(rec)
+        deltas = struct.unpack_from('<%db' % (size - BLOCK_HEADER.size), rec, BLOCK_HEADER.size)
+
+        for n in range(samples):
+            if n:
+                tmpr += deltas[(n - 1) * 2]
+                humidity += deltas[(n - 1) * 2 + 1]
+            yield (ts + n * args.sample_intv, tmpr / 10, humidity)
+
+
+def decode_rollups(payload, size, count):
+    for i in range(count):
+        ts, tmin, tmax, tavg, hmin, hmax, havg = ROLLUP.unpack_from(payload, i * size)
+        yield (ts, tmin / 10, tmax / 10, tavg / 10, hmin, hmax, havg)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('file', nargs='?', help='captured output, default stdin')
+    parser.add_argument('--sample-intv', type=int, default=SAMPLE_INTV, help='ENVH_SAMPLE_INTV, seconds')
+    parser.add_argument('--csv', action='store_true')
+    args = parser.parse_args()
+
+    data = open(args.file, 'rb').read() if args.file else sys.stdin.buffer.read()
+    header, _, payload = data.partition(b'\n')
+    _, kind, size, count = header.decode().split()
+    size, count = int(size), int(count)
+
+    if len(payload) < size * count:
+        sys.exit('truncated: %d of %d bytes' % (len(payload), size * count))
+
+    if 'samples' == kind:
+        rows = decode_blocks(payload, size, count)
+    else:
+        if size != ROLLUP.size:
+            sys.exit('unexpected rollup size %d' % size)
+        rows = decode_rollups(payload, size, count)
+
+    sep = ',' if args.csv else ' '
+    for row in rows:
+        print(sep.join(str(v) for v in row))
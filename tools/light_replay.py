@@ -0,0 +1,292 @@
+#!/usr/bin/env python3
+"""
+    host replay of light sensor traces against the zinc auto-dim filter (sensors/light_sensor.c)
+
+    traces are either logs of a debug build printing every LIGHT_sensor_ad_callback() sample:
+
+        light: ts=<ms> raw=<AD value>
+
+    or recorded lux meter traces "<seconds>,<lux>" with --lux, converted by --raw-per-lux and
+    sample-and-hold at --sample-intv. --synth generates a trace of daylight, lamp flicker & shadows.
+
+    every configuration reports posted band changes (each one is a display fade) and tracking
+    error: time weighted |posted band - band of the --ref-seconds centered mean|. the legacy
+    filter (single sample every 2.5s, LIGHT_SENSITIVE threshold) is replayed for reference.
+    with --sweep the best configuration by posts + --error-weight * error is printed as #defines.
+"""
+import argparse
+import itertools
+import math
+import random
+import re
+import sys
+
+LOG_LINE = re.compile(r'light: ts=(\d+) raw=(-?\d+)')
+
+MAX_AD_VALUE = 4096 * 2 // 3
+CLOCK_DIM_AUTO_RANGE = 96
+ALIVE_INTV = 2500
+
+
+class LightSensor:
+    """ mirror of LIGHT_SENSOR_feed() """
+    def __init__(self, max_value: int, decimate: int, bands: int, hyst_up: int, hyst_down: int, dwell_ms: int):
+        self.max_value = max_value
+        self.decimate = decimate
+        self.bands = bands
+        self.hyst_up = hyst_up
+        self.hyst_down = hyst_down
+        self.dwell_ms = dwell_ms
+
+        self.acc = 0
+        self.cnt = 0
+        self.band = -1
+        self.pending = -1
+        self.pending_ts = 0
+
+    def _band(self, value: int) -> int:
+        value = max(0, min(self.max_value, value))
+        return min(self.bands - 1, value * self.bands // (self.max_value + 1))
+
+    def _target(self, value: int) -> int:
+        width = (self.max_value + 1) // self.bands
+
+        band = self._band(value - width * self.hyst_up // 100)
+        if band > self.band:
+            return band
+        band = self._band(value + width * self.hyst_down // 100)
+        if band < self.band:
+            return band
+        return self.band
+
+    def feed(self, raw: int, ts: int) -> int:
+        self.acc += max(0, min(self.max_value, raw))
+        self.cnt += 1
+        if self.cnt < self.decimate:
+            return -1
+
+        value = (self.acc + self.decimate // 2) // self.decimate
+        self.acc = 0
+        self.cnt = 0
+
+        if -1 == self.band:
+            self.band = self._band(value)
+            return self.band
+
+        band = self._target(value)
+        if band == self.band:
+            self.pending = -1
+            return -1
+
+        if -1 == self.pending or (band > self.band) != (self.pending > self.band):
+            self.pending_ts = ts
+        self.pending = band
+
+        if ts - self.pending_ts < self.dwell_ms:
+            return -1
+
+        self.band = self.pending
+        self.pending = -1
+        return self.band
+
+
+def load_log(lines) -> list:
+    samples = []
+    for line in lines:
+        m = LOG_LINE.search(line)
+        if m:
+            samples.append((int(m.group(1)), int(m.group(2))))
+    return samples
+
+
+def load_lux(lines, raw_per_lux: float, intv: int) -> list:
+    points = []
+    for line in lines:
+        fields = line.replace(',', ' ').split()
+        if 2 > len(fields):
+            continue
+        try:
+            points.append((float(fields[0]) * 1000, float(fields[1])))
+        except ValueError:
+            continue
+    if not points:
+        return []
+
+    samples = []
+    idx = 0
+    ts = points[0][0]
+    while ts <= points[-1][0]:
+        while idx + 1 < len(points) and points[idx + 1][0] <= ts:
+            idx += 1
+        samples.append((int(ts), min(MAX_AD_VALUE, int(points[idx][1] * raw_per_lux))))
+        ts += intv
+    return samples
+
+
+def synth(intv: int, seconds: int, seed: int) -> list:
+    rnd = random.Random(seed)
+    samples = []
+    shadow_end = -1
+    lamp = False
+
+    for ts in range(0, seconds * 1000, intv):
+        t = ts / 1000
+        # slow daylight ramp and a lamp toggled every ~10 minutes
+        level = 0.15 + 0.5 * math.sin(math.pi * t / seconds) ** 2
+        if 0 == int(t) % 600 and 0 == ts % 1000:
+            lamp = not lamp
+        if lamp:
+            level += 0.25
+
+        # aliased mains / PWM flicker
+        level *= 1 + 0.12 * math.sin(2 * math.pi * t * 0.37) + rnd.gauss(0, 0.03)
+
+        # somebody walks by
+        if shadow_end < t and 0.002 > rnd.random():
+            shadow_end = t + rnd.uniform(1, 6)
+        if t < shadow_end:
+            level *= 0.55
+
+        samples.append((ts, max(0, min(MAX_AD_VALUE, int(level * MAX_AD_VALUE)))))
+    return samples
+
+
+def reference_bands(samples: list, bands: int, ref_ms: int) -> list:
+    """ band of the centered mean, the "true" ambient level """
+    out = []
+    lo = hi = 0
+    acc = 0
+    for ts, _ in samples:
+        while hi < len(samples) and samples[hi][0] <= ts + ref_ms // 2:
+            acc += samples[hi][1]
+            hi += 1
+        while samples[lo][0] < ts - ref_ms // 2:
+            acc -= samples[lo][1]
+            lo += 1
+        mean = acc / (hi - lo)
+        out.append(min(bands - 1, int(mean * bands // (MAX_AD_VALUE + 1))))
+    return out
+
+
+def replay(samples: list, ref: list, cfg: dict) -> tuple:
+    ls = LightSensor(MAX_AD_VALUE, cfg['decimate'], cfg['bands'], cfg['hyst_up'], cfg['hyst_down'], cfg['dwell'])
+    posts = 0
+    error = 0.0
+    last_ts = samples[0][0]
+    band = -1
+
+    # sampled every cfg['intv'], a trace of a different rate is decimated by time
+    next_ts = samples[0][0]
+    for (ts, raw), ref_band in zip(samples, ref):
+        if -1 != band:
+            error += abs(band - ref_band) * (ts - last_ts)
+        last_ts = ts
+
+        if ts < next_ts:
+            continue
+        next_ts = ts + cfg['intv']
+
+        posted = ls.feed(raw, ts)
+        if -1 != posted:
+            band = posted
+            posts += 1
+
+    span = max(1, samples[-1][0] - samples[0][0])
+    return posts - 1, error / span
+
+
+def replay_legacy(samples: list, ref: list, bands: int) -> tuple:
+    sensitive = MAX_AD_VALUE // CLOCK_DIM_AUTO_RANGE
+    value = 0
+    posts = 0
+    error = 0.0
+    next_ts = samples[0][0]
+    last_ts = samples[0][0]
+    band = -1
+
+    for (ts, raw), ref_band in zip(samples, ref):
+        if -1 != band:
+            error += abs(band - ref_band) * (ts - last_ts)
+        last_ts = ts
+
+        if ts < next_ts:
+            continue
+        next_ts = ts + ALIVE_INTV
+
+        raw = min(MAX_AD_VALUE, raw)
+        if sensitive < abs(raw - value):
+            value = raw
+            band = min(bands - 1, raw * bands // (MAX_AD_VALUE + 1))
+            posts += 1
+
+    span = max(1, samples[-1][0] - samples[0][0])
+    return posts - 1, error / span
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('trace', nargs='?', type=argparse.FileType('r'), help='log or lux trace, omit with --synth')
+    parser.add_argument('--lux', action='store_true', help='trace is "<seconds>,<lux>"')
+    parser.add_argument('--raw-per-lux', type=float, default=4.0, help='AD value per lux')
+    parser.add_argument('--synth', type=int, metavar='SECONDS', help='generate a trace instead')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--sample-intv', type=int, default=2000, help='LIGHT_SENSOR_SAMPLE_INTV')
+    parser.add_argument('--decimate', type=int, default=4, help='LIGHT_SENSOR_DECIMATE')
+    parser.add_argument('--bands', type=int, default=16, help='LIGHT_SENSOR_BANDS')
+    parser.add_argument('--hyst-up', type=int, default=25, help='LIGHT_SENSOR_HYST_UP')
+    parser.add_argument('--hyst-down', type=int, default=50, help='LIGHT_SENSOR_HYST_DOWN')
+    parser.add_argument('--dwell', type=int, default=4000, help='LIGHT_SENSOR_DWELL_MS')
+    parser.add_argument('--ref-seconds', type=int, default=30, help='centered mean window of the reference level')
+    parser.add_argument('--sweep', action='store_true', help='grid search hysteresis, dwell and decimation')
+    parser.add_argument('--error-weight', type=float, default=200, help='posts per band of mean tracking error')
+    args = parser.parse_args()
+
+    if args.synth:
+        samples = synth(args.sample_intv, args.synth, args.seed)
+    elif args.trace:
+        lines = args.trace.readlines()
+        samples = load_lux(lines, args.raw_per_lux, args.sample_intv) if args.lux else load_log(lines)
+    else:
+        parser.error('trace or --synth is required')
+
+    if 2 > len(samples):
+        sys.exit('no samples')
+
+    ref = reference_bands(samples, args.bands, args.ref_seconds * 1000)
+    hours = max(1, samples[-1][0] - samples[0][0]) / 3600000
+    print(f'{len(samples)} samples, {hours:.2f} hours')
+
+    posts, error = replay_legacy(samples, ref, args.bands)
+    print(f'{"legacy":>40}: {posts:5d} posts {posts / hours:7.1f}/h  error {error:.2f} bands')
+
+    cfg = {'intv': args.sample_intv, 'decimate': args.decimate, 'bands': args.bands,
+           'hyst_up': args.hyst_up, 'hyst_down': args.hyst_down, 'dwell': args.dwell}
+    configs = [cfg]
+
+    if args.sweep:
+        configs = [dict(cfg, decimate=d, hyst_up=u, hyst_down=w, dwell=t)
+                   for d, u, w, t in itertools.product([1, 2, 4, 8], [0, 10, 25, 40], [10, 25, 50, 75],
+                                                       [0, 2000, 4000, 8000])]
+
+    results = []
+    for c in configs:
+        posts, error = replay(samples, ref, c)
+        results.append((posts + args.error_weight * error, posts, error, c))
+
+    results.sort(key=lambda r: r[0])
+    for score, posts, error, c in results[:10]:
+        name = f'dec {c["decimate"]} up {c["hyst_up"]}% down {c["hyst_down"]}% dwell {c["dwell"]}'
+        print(f'{name:>40}: {posts:5d} posts {posts / hours:7.1f}/h  error {error:.2f} bands')
+
+    best = results[0][3]
+    print()
+    print(f'    #define LIGHT_SENSOR_SAMPLE_INTV    ({best["intv"]})')
+    print(f'    #define LIGHT_SENSOR_DECIMATE       ({best["decimate"]})')
+    print(f'    #define LIGHT_SENSOR_BANDS          ({best["bands"]})')
+    print(f'    #define LIGHT_SENSOR_HYST_UP        ({best["hyst_up"]})')
+    print(f'    #define LIGHT_SENSOR_HYST_DOWN      ({best["hyst_down"]})')
+    print(f'    #define LIGHT_SENSOR_DWELL_MS       ({best["dwell"]})')
+
+
+if __name__ == '__main__':
+    main()
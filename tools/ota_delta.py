@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+    generate delta patch old.bin -> new.bin for "ota ... d=<patch size>"
+
+    patch layout (little endian), see delta.h
+        header:     magic "SCD1", old_size, new_size, md5(old)
+        repeat:     diff_len, extra_len, seek (int32)
+                    diff bytes (new - old), extra bytes
+
+    every generated patch is applied back against old.bin before written,
+    the decoder here mirrors DELTA_feed() byte by byte.
+"""
+import argparse
+import gzip
+import hashlib
+import struct
+import sys
+
+MAGIC = 0x31444353
+SEED = 8
+MIN_MATCH = 24
+MAX_CANDIDATES = 16
+
+
+def crc16_xmodem(data: bytes) -> int:
+    crc = 0
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def match_len(old: bytes, opos: int, new: bytes, npos: int) -> int:
+    n = 0
+    limit = min(len(old) - opos, len(new) - npos)
+    while n + 64 <= limit and old[opos + n:opos + n + 64] == new[npos + n:npos + n + 64]:
+        n += 64
+    while n < limit and old[opos + n] == new[npos + n]:
+        n += 1
+    return n
+
+
+def similar(old: bytes, opos: int, new: bytes, npos: int, length: int) -> int:
+    limit = min(length, len(old) - opos, len(new) - npos)
+    if opos < 0 or limit <= 0:
+        return 0
+    return sum(1 for i in range(limit) if old[opos + i] == new[npos + i])
+
+
+def forward_extent(old: bytes, opos: int, new: bytes, npos: int, length: int) -> int:
+    # bsdiff: longest prefix where more than half of bytes match
+    limit = min(length, len(old) - opos)
+    s = sf = lenf = 0
+    for i in range(limit):
+        if old[opos + i] == new[npos + i]:
+            s += 1
+        if s * 2 - (i + 1) > sf * 2 - lenf:
+            sf = s
+            lenf = i + 1
+    return lenf
+
+
+def diff(old: bytes, new: bytes) -> bytes:
+    index = {}
+    for i in range(len(old) - SEED + 1):
+        lst = index.setdefault(old[i:i + SEED], [])
+        if len(lst) < MAX_CANDIDATES:
+            lst.append(i)
+
+    # regions: (new start, old alignment)
+    regions = [(0, 0)]
+    pos = 0
+    while pos < len(new):
+        scan, align = regions[-1]
+        aligned = align + (pos - scan)
+
+        best = best_len = 0
+        for cand in index.get(new[pos:pos + SEED], ()):
+            n = match_len(old, cand, new, pos)
+            if n > best_len:
+                best, best_len = cand, n
+
+        if best_len >= MIN_MATCH:
+            if best != aligned and best_len - similar(old, aligned, new, pos, best_len) > 8:
+                regions.append((pos, best))
+            pos += best_len
+        else:
+            pos += 1
+    regions.append((len(new), None))
+
+    records = []
+    for (scan, align), (scan_next, _) in zip(regions, regions[1:]):
+        lenf = forward_extent(old, align, new, scan, scan_next - scan)
+        records.append([align, lenf, scan, scan_next])
+
+    out = bytearray(struct.pack('<III', MAGIC, len(old), len(new)))
+    out += hashlib.md5(old).digest()
+
+    for i, (align, lenf, scan, scan_next) in enumerate(records):
+        if i + 1 < len(records):
+            seek = records[i + 1][0] - (align + lenf)
+        else:
+            seek = 0
+        extra = new[scan + lenf:scan_next]
+
+        out += struct.pack('<IIi', lenf, len(extra), seek)
+        out += bytes((new[scan + k] - old[align + k]) & 0xFF for k in range(lenf))
+        out += extra
+
+    return bytes(out)
+
+
+def apply(old: bytes, patch: bytes) -> bytes:
+    magic, old_size, new_size = struct.unpack_from('<III', patch, 0)
+    if magic != MAGIC or old_size != len(old) or patch[12:28] != hashlib.md5(old).digest():
+        raise ValueError('source image mismatch')
+
+    pos = 28
+    opos = 0
+    new = bytearray()
+    while pos < len(patch):
+        diff_len, extra_len, seek = struct.unpack_from('<IIi', patch, pos)
+        pos += 12
+        if opos + diff_len > old_size:
+            raise ValueError('diff out of source image')
+
+        new += bytes((patch[pos + k] + old[opos + k]) & 0xFF for k in range(diff_len))
+        pos += diff_len
+        opos += diff_len
+        new += patch[pos:pos + extra_len]
+        pos += extra_len
+
+        opos += seek
+        if not 0 <= opos <= old_size:
+            raise ValueError('seek out of source image')
+
+    if len(new) != new_size:
+        raise ValueError('size mismatch')
+    return bytes(new)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('old', help='running image (.bin)')
+    parser.add_argument('new', help='new image (.bin)')
+    parser.add_argument('patch', help='output patch')
+    parser.add_argument('-z', '--gzip', action='store_true', help='gzip compress the patch')
+    args = parser.parse_args()
+
+    old = open(args.old, 'rb').read()
+    new = open(args.new, 'rb').read()
+
+    patch = diff(old, new)
+    if apply(old, patch) != new:
+        sys.exit('self-check failed: patch does not reproduce new image')
+
+    cmd = f'ota s={len(new)} c=0x{crc16_xmodem(new):04X} d={len(patch)}'
+    if args.gzip:
+        blob = gzip.compress(patch, 9)
+        if gzip.decompress(blob) != patch:
+            sys.exit('self-check failed: gzip')
+        cmd += f' z={len(blob)}'
+    else:
+        blob = patch
+
+    open(args.patch, 'wb').write(blob)
+    print(f'{args.patch}: {len(blob)} bytes, {100 * len(blob) / max(len(new), 1):.1f}% of new image')
+    print(cmd)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,56 @@
+#include <string.h>
+
+#include "ui_fsm.h"
+
+/****************************************************************************
+ *  @implements
+ ****************************************************************************/
+void UI_FSM_init(struct UI_fsm_t *fsm, struct UI_transition_t const *tbl, uint8_t count,
+    uint8_t initial_state, void *ctx)
+{
+    memset(fsm, 0, sizeof(*fsm));
+
+    fsm->tbl = tbl;
+    fsm->count = count;
+    fsm->state = initial_state;
+    fsm->ctx = ctx;
+}
+
+bool UI_FSM_dispatch(struct UI_fsm_t *fsm, unsigned msgid)
+{
+    uint8_t event = UI_MSG_EVENT(msgid);
+    uint8_t id = UI_MSG_ID(msgid);
+
+    for (unsigned idx = 0; idx < fsm->count; idx ++)
+    {
+        struct UI_transition_t const *row = &fsm->tbl[idx];
+
+        if (UI_STATE_ANY != row->state && fsm->state != row->state)
+            continue;
+        if (UI_EVENT_ANY != row->event && event != row->event)
+            continue;
+        if (UI_ID_ANY != row->id && id != row->id)
+            continue;
+
+        clock_t ts = clock();
+
+        if (row->guard && ! row->guard(fsm->ctx, event, id))
+            continue;
+
+        if (UI_STATE_SAME != row->next)
+            fsm->state = row->next;
+        if (row->action)
+            row->action(fsm->ctx, event, id);
+
+        ts = clock() - ts;
+        fsm->ticks_total += ts;
+        if (ts > fsm->ticks_max)
+            fsm->ticks_max = ts;
+
+        fsm->dispatched ++;
+        return true;
+    }
+
+    fsm->unhandled ++;
+    return false;
+}
@@ -0,0 +1,99 @@
+#ifndef __UI_FSM_H
+#define __UI_FSM_H                      1
+
+#include <features.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+    #define UI_STATE_ANY                (0xFFU)
+    #define UI_STATE_SAME               (0xFFU)
+    #define UI_EVENT_ANY                (0U)
+    #define UI_ID_ANY                   (0U)
+
+    /**
+     *  message id layout is shared with button engine: event << 8 | id,
+     *      messages not coming from button engine have event 0
+     */
+    #define UI_MSG_EVENT(msgid)         ((uint8_t)((unsigned)(msgid) >> 8))
+    #define UI_MSG_ID(msgid)            ((uint8_t)(msgid))
+
+    /**
+     *  action / guard: ctx is UI_FSM_init() ctx, event / id are decoded message id
+     */
+    typedef void (* UI_action_t)(void *ctx, uint8_t event, uint8_t id);
+    typedef bool (* UI_guard_t)(void *ctx, uint8_t event, uint8_t id);
+
+    /**
+     *  one row of states x events => action table, first matching row wins
+     *      a row with guard matches only when the guard returns true, otherwise matching goes on
+     *      next state is entered before action runs: action sees the state it leads to,
+     *      UI_STATE_SAME to keep the state
+     */
+    struct UI_transition_t
+    {
+        uint8_t state;
+        uint8_t event;
+        uint8_t id;
+        uint8_t next;
+        UI_guard_t guard;
+        UI_action_t action;
+    };
+
+    #define UI_ON(STATE, EVENT, ID, ACTION, NEXT)   \
+        {.state = (STATE), .event = (EVENT), .id = (ID), .next = (NEXT), .guard = NULL, .action = (ACTION)}
+    #define UI_ON_IF(STATE, EVENT, ID, GUARD, ACTION, NEXT) \
+        {.state = (STATE), .event = (EVENT), .id = (ID), .next = (NEXT), .guard = (GUARD), .action = (ACTION)}
+
+    struct UI_fsm_t
+    {
+        struct UI_transition_t const *tbl;
+        uint8_t count;
+        uint8_t state;
+        void *ctx;
+
+        uint32_t dispatched;
+        uint32_t unhandled;
+        clock_t ticks_total;
+        clock_t ticks_max;
+    };
+
+__BEGIN_DECLS
+    /**
+     *  UI_FSM_init()
+     */
+extern __attribute__((nothrow, nonnull(1, 2)))
+    void UI_FSM_init(struct UI_fsm_t *fsm, struct UI_transition_t const *tbl, uint8_t count,
+        uint8_t initial_state, void *ctx);
+
+    /**
+     *  UI_FSM_dispatch()
+     *      enter the next state & run the action of the first row matching current state & message id
+     *
+     *  @returns
+     *      false if no row matches, message is ignored
+     */
+extern __attribute__((nothrow, nonnull))
+    bool UI_FSM_dispatch(struct UI_fsm_t *fsm, unsigned msgid);
+
+    /**
+     *  UI_FSM_state()
+     */
+static inline
+    uint8_t UI_FSM_state(struct UI_fsm_t const *fsm)
+    {
+        return fsm->state;
+    }
+
+    /**
+     *  UI_FSM_is_state()
+     */
+static inline
+    bool UI_FSM_is_state(struct UI_fsm_t const *fsm, uint8_t state)
+    {
+        return state == fsm->state;
+    }
+
+__END_DECLS
+#endif
@@ -0,0 +1,123 @@
+#include "smartcuckoo.h"
+#include "ui_setting.h"
+
+/****************************************************************************
+ *  @implements
+ ****************************************************************************/
+void UI_setting_load(enum VOICE_setting_t part, struct CLOCK_moment_t const *alarm, struct tm *dt)
+{
+    time_t ts;
+
+    if (VOICE_SETTING_ALARM_HOUR == part ||
+        VOICE_SETTING_ALARM_MIN == part ||
+        VOICE_SETTING_ALARM_RINGTONE == part)
+    {
+        ts = mtime2time(alarm->mtime);
+    }
+    else
+        ts = time(NULL);
+
+    localtime_r(&ts, dt);
+    dt->tm_sec = 0;
+}
+
+unsigned UI_setting_adjust(enum VOICE_setting_t part, struct tm *dt, struct CLOCK_moment_t *alarm, bool up)
+{
+    int16_t old_voice_id;
+
+    switch (part)
+    {
+    case VOICE_SETTING_EXT_LOW_BATT:
+    case VOICE_SETTING_EXT_ALARM_ON:
+    case VOICE_SETTING_EXT_ALARM_OFF:
+    case VOICE_SETTING_COUNT:
+        break;
+
+    case VOICE_SETTING_LANG:
+    case VOICE_SETTING_VOICE:
+        old_voice_id = smartcuckoo.voice_sel_id;
+
+        if (VOICE_SETTING_LANG == part)
+            smartcuckoo.voice_sel_id = up ? VOICE_next_locale() : VOICE_prev_locale();
+        else
+            smartcuckoo.voice_sel_id = up ? VOICE_next_voice() : VOICE_prev_voice();
+
+        if (old_voice_id != smartcuckoo.voice_sel_id)
+        {
+            smartcuckoo.locale.dfmt = DFMT_DEFAULT;
+            smartcuckoo.locale.hfmt = HFMT_DEFAULT;
+            return UI_SETTING_MODIFIED;
+        }
+        break;
+
+    case VOICE_SETTING_HOUR:
+        dt->tm_hour = (dt->tm_hour + (up ? 1 : 23)) % 24;
+        goto setting_rtc_set_time;
+
+    case VOICE_SETTING_MINUTE:
+        dt->tm_min = (dt->tm_min + (up ? 1 : 59)) % 60;
+        goto setting_rtc_set_time;
+
+    case VOICE_SETTING_YEAR:
+        TM_year_add(dt, up ? 1 : -1);
+        goto setting_rtc_set_date;
+
+    case VOICE_SETTING_MONTH:
+        TM_month_add(dt, up ? 1 : -1);
+        goto setting_rtc_set_date;
+
+    case VOICE_SETTING_MDAY:
+        TM_mday_add(dt, up ? 1 : -1);
+        goto setting_rtc_set_date;
+
+    case VOICE_SETTING_ALARM_HOUR:
+        dt->tm_hour = (dt->tm_hour + (up ? 1 : 23)) % 24;
+        goto setting_modify_alarm;
+
+    case VOICE_SETTING_ALARM_MIN:
+        dt->tm_min = (dt->tm_min + (up ? 1 : 59)) % 60;
+        goto setting_modify_alarm;
+
+    case VOICE_SETTING_ALARM_RINGTONE:
+        if (up)
+            alarm->ringtone_id = (uint8_t)VOICE_next_ringtone(alarm->ringtone_id);
+        else
+            alarm->ringtone_id = (uint8_t)VOICE_prev_ringtone(alarm->ringtone_id);
+        goto setting_modify_alarm;
+    }
+
+    if (false)
+    {
+    setting_rtc_set_time:
+        dt->tm_sec = 0;
+        RTC_set_epoch_time(mktime(dt) - get_dst_offset(dt));
+
+        LOG_info("%02d:%02d:%02d", dt->tm_hour, dt->tm_min, dt->tm_sec);
+    }
+
+    if (false)
+    {
+        struct tm date;
+
+    setting_rtc_set_date:
+        date = *dt;
+        date.tm_hour = 0;
+        date.tm_min = 0;
+        date.tm_sec = 0;
+        RTC_set_epoch_time(time(NULL) % 86400 + mktime(&date));
+
+        LOG_info("%04d/%02d/%02d", dt->tm_year + 1900, dt->tm_mon + 1, dt->tm_mday);
+    }
+
+    if (false)
+    {
+    setting_modify_alarm:
+        alarm->enabled = true;
+        alarm->mtime = time2mtime(mktime(dt));
+        alarm->mdate = 0;
+        alarm->wdays = 0x7F;
+
+        return UI_SETTING_ALARM_MODIFIED;
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef __UI_SETTING_H
+#define __UI_SETTING_H                  1
+
+#include <features.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "clock.h"
+#include "voice.h"
+
+    /**
+     *  UI_setting_adjust() flags
+     */
+    #define UI_SETTING_MODIFIED         (0x01U)
+    #define UI_SETTING_ALARM_MODIFIED   (0x02U)
+
+__BEGIN_DECLS
+    /**
+     *  UI_setting_load()
+     *      load dt of setting part to adjust: alarm time for alarm parts, or current time
+     *      alarm is only referenced by alarm parts
+     */
+extern __attribute__((nothrow, nonnull(3)))
+    void UI_setting_load(enum VOICE_setting_t part, struct CLOCK_moment_t const *alarm, struct tm *dt);
+
+    /**
+     *  UI_setting_adjust()
+     *      step setting part up / down, time & date are written to RTC immediately,
+     *      alarm parts are written back to alarm, alarm is only referenced by alarm parts
+     *
+     *  @returns
+     *      UI_SETTING_MODIFIED / UI_SETTING_ALARM_MODIFIED
+     */
+extern __attribute__((nothrow, nonnull(2)))
+    unsigned UI_setting_adjust(enum VOICE_setting_t part, struct tm *dt, struct CLOCK_moment_t *alarm, bool up);
+
+__END_DECLS
+#endif
@@ -12,6 +12,7 @@
 #include "limits.h"
 #include "audio/mplayer.h"
 #include "voice.h"
+#include "audio_pm.h"
 
 /***************************************************************************
  * @def
@@ -146,6 +147,7 @@ static int VOICE_play(int idx)
     else
         return ENOENT;
 
+    AUDIO_PM_busy(AUDIO_PM_STREAM_VOICE);
     int err = mplayer_play(filename);
 
     if (0 != err)
@@ -159,6 +161,7 @@ static int VOICE_queue(int idx)
     char filename[32];
     sprintf(filename, "%s%02X" EXT_VOICE, voice_sel->folder, idx);
 
+    AUDIO_PM_busy(AUDIO_PM_STREAM_VOICE);
     int err = mplayer_playlist_queue(filename);
 
     // if (0 == err)
@@ -1,7 +1,267 @@
+#include <ultracore/kernel.h>
+#include <ultracore/log.h>
+#include <hw/smart_led.h>
+#include <gpio.h>
+
+#include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "N32X45X_config.h"
+#include "PERIPHERAL_config.h"
+#include "ws2812b_driver.h"
+
+#if WS2812B_DMA
+    #include <n32g45x_rcc.h>
+    #include <n32g45x_dma.h>
+#endif
+
+/****************************************************************************
+ *  @def
+ ****************************************************************************/
+#if 256 <= WS2812B_PERIOD
+    #pragma GCC error "WS2812B_TIMER_CLOCK too high for 8-bit compare slots"
+#endif
+
+#ifndef WS2812B_POLL_US
+    #define WS2812B_POLL_US             (50)    // previous transfer polling
+#endif
+
+#define WS2812B_BIT(b, n)               ((uint64_t)((b) >> (n) & 1 ? WS2812B_T1H : WS2812B_T0H))
+
+// MSB first: bit 7 is the first slot
+#define WS2812B_BYTE(b)                 \
+    (WS2812B_BIT(b, 7)       | WS2812B_BIT(b, 6) << 8  | WS2812B_BIT(b, 5) << 16 | WS2812B_BIT(b, 4) << 24 | \
+     WS2812B_BIT(b, 3) << 32 | WS2812B_BIT(b, 2) << 40 | WS2812B_BIT(b, 1) << 48 | WS2812B_BIT(b, 0) << 56)
+
+#define WS2812B_BYTE4(b)                WS2812B_BYTE(b), WS2812B_BYTE(b + 1), WS2812B_BYTE(b + 2), WS2812B_BYTE(b + 3)
+#define WS2812B_BYTE16(b)               WS2812B_BYTE4(b), WS2812B_BYTE4(b + 4), WS2812B_BYTE4(b + 8), WS2812B_BYTE4(b + 12)
+#define WS2812B_BYTE64(b)               WS2812B_BYTE16(b), WS2812B_BYTE16(b + 16), WS2812B_BYTE16(b + 32), WS2812B_BYTE16(b + 48)
+
+// 8 compare slots of every byte value, little endian
+static uint64_t const WS2812B_byte_slots[256] =
+{
+    WS2812B_BYTE64(0), WS2812B_BYTE64(64), WS2812B_BYTE64(128), WS2812B_BYTE64(192),
+};
+
+/****************************************************************************
+ *  @implements
+ ****************************************************************************/
+size_t WS2812B_encode(uint8_t *slots, uint32_t const *rgb, unsigned count)
+{
+    uint8_t *ptr = slots;
+
+    for (unsigned i = 0; i < count; i ++)
+    {
+        // NOTE: WS2812B is GRB not RGB
+        memcpy(ptr,      &WS2812B_byte_slots[(0x00FF00 & rgb[i]) >> 8], 8);
+        memcpy(ptr + 8,  &WS2812B_byte_slots[(0xFF0000 & rgb[i]) >> 16], 8);
+        memcpy(ptr + 16, &WS2812B_byte_slots[0x0000FF & rgb[i]], 8);
+        ptr += 24;
+    }
+    *ptr ++ = 0;
+
+    return (size_t)(ptr - slots);
+}
+
+#if ! WS2812B_DMA
 
 uint32_t SMART_LED_HAL_color_xform(uint32_t rgb)
 {
     // NOTE: WS2812B is GRB not RGB
     return ((0xFF0000 & rgb) >> 8) | ((0x00FF00 & rgb) << 8) | (0x0000FF & rgb);
 }
+
+#else
+
+/****************************************************************************
+ *  @def: channels
+ *      TIM8_CH2 PC07 => DMA2_CH5, TIM8_CH3 PC08 => DMA2_CH1, TIM3_CH1 PA06 => DMA1_CH6
+ *      none of the LED data pins is a SPI MOSI, so the waveform is generated by timer PWM
+ ****************************************************************************/
+struct WS2812B_channel_t
+{
+    uint32_t pin;
+    TIM_Module *tim;
+    uint32_t tim_clock;         // timer kernel clock: APB x2
+    uint8_t cc;                 // 1 ~ 4
+
+    DMA_Module *dma;
+    DMA_ChannelType *dma_ch;
+    uint8_t dma_ch_idx;         // 1 ~ 8
+    uint32_t dma_remap;
+    IRQn_Type irqn;
+};
+
+static struct WS2812B_channel_t const ws2812b_channels[] =
+{
+    {LED_TIME_DAT,  TIM8, SYSCLK_FREQ,     2, DMA2, DMA2_CH5, 5, DMA2_REMAP_TIM8_CH2, DMA2_Channel5_IRQn},
+    {LED_WDAYS_DAT, TIM8, SYSCLK_FREQ,     3, DMA2, DMA2_CH1, 1, DMA2_REMAP_TIM8_CH3, DMA2_Channel1_IRQn},
+    {LED_LAMP_DAT,  TIM3, SYSCLK_FREQ / 2, 1, DMA1, DMA1_CH6, 6, DMA1_REMAP_TIM3_CH1, DMA1_Channel6_IRQn},
+};
+
+struct WS2812B_runtime_t
+{
+    struct WS2812B_channel_t const *volatile active;    // transfer in progress, cleared by DMA interrupt
+    clock_t done_ts[lengthof(ws2812b_channels)];
+
+    unsigned next;                              // ping-pong: encode into one while the other is sent
+    uint8_t slots[2][WS2812B_ENCODED_SIZE(WS2812B_MAX_LEDS)] __attribute__((aligned(4)));
+};
+
+/****************************************************************************
+ *  @internal
+ ****************************************************************************/
+static void WS2812B_dma_done(void);
+static void WS2812B_abort(void);
+static void WS2812B_start(struct WS2812B_channel_t const *ch, uint8_t const *slots, size_t size);
+
+// var
+static struct WS2812B_runtime_t ws2812b;
+
+/****************************************************************************
+ *  @implements: ultracore smart_led HAL
+ ****************************************************************************/
+uint32_t SMART_LED_HAL_color_xform(uint32_t rgb)
+{
+    // GRB reordering is done by WS2812B_encode()
+    return rgb;
+}
+
+void SMART_LED_HAL_write(struct SMART_LED_attr_t const *attr, uint32_t const *rgb, unsigned count)
+{
+    struct WS2812B_channel_t const *ch = NULL;
+    unsigned idx;
+
+    for (idx = 0; idx < lengthof(ws2812b_channels); idx ++)
+    {
+        if (attr->pin_alias == ws2812b_channels[idx].pin)
+        {
+            ch = &ws2812b_channels[idx];
+            break;
+        }
+    }
+    if (NULL == ch)
+        return;
+
+    uint8_t *slots = ws2812b.slots[ws2812b.next];
+    ws2812b.next ^= 1;
+
+    // encoding overlaps the previous transfer
+    size_t size = WS2812B_encode(slots, rgb, MIN(count, WS2812B_MAX_LEDS));
+
+    // previous chain is still sent: bounded by twice of its transfer, a lost DMA interrupt aborts it
+    for (unsigned us = 0; NULL != ws2812b.active; us += WS2812B_POLL_US)
+    {
+        if (2 * WS2812B_TRANSFER_US < us)
+        {
+            WS2812B_abort();
+            break;
+        }
+        usleep(WS2812B_POLL_US);
+    }
+
+    // reset latch: >= WS2812B_RESET_US low since the previous transfer on this line, clock() is in ms
+    if (2 > clock() - ws2812b.done_ts[idx])
+        usleep(WS2812B_RESET_US);
+
+    WS2812B_start(ch, slots, size);
+}
+
+void DMA2_Channel5_IRQHandler(void)
+{
+    WS2812B_dma_done();
+}
+
+void DMA2_Channel1_IRQHandler(void)
+{
+    WS2812B_dma_done();
+}
+
+void DMA1_Channel6_IRQHandler(void)
+{
+    WS2812B_dma_done();
+}
+
+/****************************************************************************
+ *  @internal
+ ****************************************************************************/
+static void WS2812B_start(struct WS2812B_channel_t const *ch, uint8_t const *slots, size_t size)
+{
+    TIM_Module *tim = ch->tim;
+    DMA_ChannelType *dma_ch = ch->dma_ch;
+    __IO uint32_t *ccdat = &tim->CCDAT1 + (ch->cc - 1);
+
+    if (TIM8 == tim)
+        RCC_EnableAPB2PeriphClk(RCC_APB2_PERIPH_TIM8, ENABLE);
+    else
+        RCC_EnableAPB1PeriphClk(RCC_APB1_PERIPH_TIM3, ENABLE);
+    RCC_EnableAHBPeriphClk(DMA1 == ch->dma ? RCC_AHB_PERIPH_DMA1 : RCC_AHB_PERIPH_DMA2, ENABLE);
+
+    GPIO_config_np(ch->pin, GPIO_ALT_PUSH_PULL);
+    ws2812b.active = ch;
+
+    // timer: PWM mode 1 with preload, compare 0 keeps the line low until first DMA reload
+    tim->CTRL1 = 0;
+    tim->PSC = ch->tim_clock / WS2812B_TIMER_CLOCK - 1;
+    tim->AR = WS2812B_PERIOD - 1;
+    tim->CNT = 0;
+    *ccdat = 0;
+
+    __IO uint32_t *ccmod = 3 > ch->cc ? &tim->CCMOD1 : &tim->CCMOD2;
+    unsigned shift = 0 == (ch->cc & 1) ? 8 : 0;
+    *ccmod = (*ccmod & ~(0xFFUL << shift)) | (0x6UL << 4 | 1UL << 3) << shift;
+
+    tim->CCEN |= 1UL << (4 * (ch->cc - 1));
+    tim->DINTEN = 1UL << (8 + ch->cc);          // CCxDEN
+    if (TIM8 == tim)
+        tim->BKDT |= 1UL << 15;                 // MOEN
+
+    // DMA: memory byte => peripheral half word, transfer complete interrupt
+    DMA_RequestRemap(ch->dma_remap, ch->dma, dma_ch, ENABLE);
+
+    dma_ch->CHCFG = 0;
+    dma_ch->PADDR = (uint32_t)ccdat;
+    dma_ch->MADDR = (uint32_t)slots;
+    dma_ch->TXNUM = size;
+    dma_ch->CHCFG = 1UL << 12 | 1UL << 8 | 1UL << 7 | 1UL << 4 | 1UL << 1 | 1UL << 0;
+
+    NVIC_EnableIRQ(ch->irqn);
+
+    tim->EVTGEN = 1;                            // load preload registers
+    tim->CTRL1 = 1UL << 7 | 1UL << 0;           // ARPEN | CNTEN
+}
+
+static void WS2812B_dma_done(void)
+{
+    struct WS2812B_channel_t const *ch = ws2812b.active;
+    if (NULL == ch)
+        return;
+
+    ch->dma->INTCLR = 0xFUL << (4 * (ch->dma_ch_idx - 1));
+    ch->dma_ch->CHCFG = 0;
+
+    // trailing 0 slot was loaded: line stays low
+    ch->tim->DINTEN = 0;
+    ch->tim->CTRL1 = 0;
+
+    ws2812b.done_ts[ch - ws2812b_channels] = clock();
+    ws2812b.active = NULL;
+}
+
+static void WS2812B_abort(void)
+{
+    struct WS2812B_channel_t const *ch = ws2812b.active;
+    if (NULL == ch)
+        return;
+
+    LOG_warning("ws2812b: transfer timeout, pin %lu", (unsigned long)ch->pin);
+
+    // next WS2812B_start() enables it again
+    NVIC_DisableIRQ(ch->irqn);
+    WS2812B_dma_done();
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef __WS2812B_DRIVER_H
+#define __WS2812B_DRIVER_H              1
+
+#include <features.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/***************************************************************************
+ *  WS2812B timer PWM / DMA output
+ *
+ *      every data bit is one PWM period of WS2812B_PERIOD_NS, its compare value sets the high time:
+ *      T0H / T1H, DMA reloads the compare register from the encoded buffer by every period
+ *
+ *      datasheet: T0H 400ns, T1H 800ns, period 1250ns, each +-150ns, reset >= 280us low
+***************************************************************************/
+#ifndef WS2812B_DMA
+    #define WS2812B_DMA                 (1)     // 0: CPU bit-banging by ultracore smart_led
+#endif
+#ifndef WS2812B_TIMER_CLOCK
+    #define WS2812B_TIMER_CLOCK         (72000000)  // counter clock after prescaler
+#endif
+#ifndef WS2812B_MAX_LEDS
+    #define WS2812B_MAX_LEDS            (30)
+#endif
+
+    #define WS2812B_PERIOD_NS           (1250)
+    #define WS2812B_T0H_NS              (400)
+    #define WS2812B_T1H_NS              (800)
+    #define WS2812B_RESET_US            (280)
+
+    #define WS2812B_PERIOD              ((WS2812B_TIMER_CLOCK / 1000000 * WS2812B_PERIOD_NS + 500) / 1000)
+    #define WS2812B_T0H                 ((WS2812B_TIMER_CLOCK / 1000000 * WS2812B_T0H_NS + 500) / 1000)
+    #define WS2812B_T1H                 ((WS2812B_TIMER_CLOCK / 1000000 * WS2812B_T1H_NS + 500) / 1000)
+
+    // encoded slots of count LEDs: 24 bits each, and a trailing 0 keeps the line low after transfer
+    #define WS2812B_ENCODED_SIZE(count) (24 * (count) + 1)
+    // one full chain on the wire
+    #define WS2812B_TRANSFER_US         ((WS2812B_ENCODED_SIZE(WS2812B_MAX_LEDS) * WS2812B_PERIOD_NS + 999) / 1000)
+
+__BEGIN_DECLS
+    /**
+     *  WS2812B_encode()
+     *      pack RGB colors into GRB compare values, 8 slots per table lookup
+     *
+     *  @returns
+     *      encoded size, WS2812B_ENCODED_SIZE(count)
+     */
+extern __attribute__((nothrow, nonnull))
+    size_t WS2812B_encode(uint8_t *slots, uint32_t const *rgb, unsigned count);
+
+__END_DECLS
+#endif
@@ -63,7 +63,7 @@
     #define LIGHT_SENSOR_MAX_AD_VALUE   (4096 * 2 / 3)
     #define CLOCK_DIM_AUTO_RANGE        (96)
     #define CLOCK_DIM_MAX_VALUE         (CLOCK_DIM_AUTO_RANGE + 32)
-    #define LIGHT_SENSITIVE             (LIGHT_SENSOR_MAX_AD_VALUE / CLOCK_DIM_AUTO_RANGE)
+    // sample interval / filter: sensors/light_sensor.h
 
     #define CLOCK_DIM_TBL               {20, 35, 50, 75, 100}
 
@@ -79,6 +79,8 @@
     #define KPAD_COL_3_PIN              PD00
 
     #define GPIO_FILTER_INTV            (50)
+    #define KPAD_SCAN_INTV              (5)
+    #define KPAD_DEBOUNCE_COUNT         (3)
     #define SETTING_VOLUME_ADJ_INTV     (100)
     #define SETTING_LAMP_DIM_INTV       (50)
     #define SETTING_BLINKY_INTV         (500)
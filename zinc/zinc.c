@@ -1,7 +1,17 @@
 #include "smartcuckoo.h"
+#include "button.h"
+#include "ui_fsm.h"
+#include "ui_setting.h"
+#include "power.h"
+#include "audio_pm.h"
 
 #include "smart_led/led_time.h"
 #include "smart_led/led_flags.h"
+#include "smart_led/led_frame.h"
+#include "smart_led/led_fade.h"
+#include "sensors/light_sensor.h"
+
+#include "zinc_ui.h"
 
 /****************************************************************************
  *  @def
@@ -11,64 +21,71 @@
 
 #define MQUEUE_ALIVE_INTV               (2500)
 
-enum zinc_message_t
-{
-    MSG_NOISE_BUTTON            = 0x11,
-    MSG_VOLUME_UP_BUTTON,
-    MSG_VOLUME_DOWN_BUTTON,
-    MSG_SNOOZE_BUTTON           = 0x21,
-    MSG_PREV_BUTTON,
-    MSG_NEXT_BUTTON,
-    MSG_TIMER_BUTTON            = 0x31,
-    MSG_COLOR_BUTTON,
-    MSG_LAMP_BUTTON,
-
-    MSG_EARPHONE_DET            = 0x80,
-    MSG_LAMP_LONG_PRESS,
-    MSG_LAMP_LONG_PRESS_OFF,
-
-    MSG_LAMP_DIM_UP = MSG_COLOR_BUTTON,
-    MSG_LAMP_DIM_DOWN = MSG_LAMP_BUTTON,
-    MSG_SETTING_DIM = MSG_LAMP_BUTTON
-};
+#define KPAD_ROWS                       (3)
+#define KPAD_COLS                       (3)
+
+#ifndef CLOCK_DIM_FADE_MS
+    #define CLOCK_DIM_FADE_MS           (1500)  // auto dim by light sensor
+#endif
+// lamp dim speed: same as stepping 2 every SETTING_LAMP_DIM_INTV
+#define LAMP_FADE_MS(from, to)          ((unsigned)abs((int)(to) - (int)(from)) * SETTING_LAMP_DIM_INTV / 2)
+
+#ifndef WAKE_LIGHT_DAWN_COLOR
+    #define WAKE_LIGHT_DAWN_COLOR       LED_ORANGE  // warm start of the sunrise, ends in lamp color
+#endif
 
 struct light_sensor_ad_t
 {
     struct ADC_attr_t attr;
-    int value;
+    timeout_t sample_intv;
+    struct LIGHT_SENSOR_t filter;
+};
+
+struct zinc_kpad_t
+{
+    timeout_t scan_timeo;
+
+    uint8_t row;
+    uint8_t integrator[KPAD_ROWS * KPAD_COLS];
+    uint32_t mask;
+    uint32_t settling;
 };
 
 struct zinc_runtime_t
 {
     int mqd;
 
+    struct zinc_kpad_t kpad;
+    struct BUTTON_engine_t buttons;
+    struct UI_fsm_t ui;
     timeout_t gpio_filter_timeo;
     timeout_t setting_timeo;
     timeout_t setting_blinky_intv;
-    timeout_t setting_volume_intv;
-    timeout_t setting_dim_intv;
 
     struct light_sensor_ad_t light_sensor;
 
     struct tm setting_dt;
     enum VOICE_setting_t setting_part;
 
-    bytebool_t setting;
     bytebool_t setting_is_modified;
     bytebool_t setting_alarm_is_modified;
     bytebool_t setting_blinky;
     int8_t setting_alarm_idx;
 
     bytebool_t earphone_en;
+    bytebool_t usb_en;              // NOISE held at power on
+    bytebool_t lamp_turned_on;
+    bytebool_t wake_light;          // lamp_fade is a sunrise ramp started by alarm
     uint8_t clock_dim_value;
+    uint8_t lamp_dim_value;         // on the chain, smartcuckoo.lamp.dim_value is the user's setting
+
+    struct LED_FADE_t clock_fade;   // owns clock_dim_value
+    struct LED_FADE_t lamp_fade;    // owns lamp_dim_value
 
-    uint16_t display_mtime;
+    uint32_t display_mask;          // time segments on display, never has bit 30 & 31
     uint32_t display_flags;
 
     clock_t voice_last_tick;
-    clock_t timer_button_stick;
-    clock_t dim_stick;
-    time_t batt_last_ts;
 };
 
 uint8_t const dim_tbl[] = CLOCK_DIM_TBL;
@@ -79,27 +96,62 @@ uint8_t const dim_tbl[] = CLOCK_DIM_TBL;
 static __attribute__((noreturn)) void *MSG_dispatch_thread(struct zinc_runtime_t *runtime);
 
 static void GPIO_button_callback(uint32_t pins, struct zinc_runtime_t *runtime);
-static void GPIO_filter_callback(enum zinc_message_t msg_button);
+static void KPAD_scan_callback(struct zinc_runtime_t *runtime);
+static uint32_t KPAD_columns(void);
+static bool KPAD_scan(struct zinc_kpad_t *kpad);
+static void KPAD_boot_scan(struct zinc_kpad_t *kpad);
+static bool KPAD_is_down(struct zinc_kpad_t const *kpad, enum zinc_message_t msg_button);
+static void GPIO_filter_callback(enum zinc_message_t msg);
 static void GPIO_earphone_det_callback(uint32_t pins, struct zinc_runtime_t *runtime);
-static bool GPIO_button_is_down(enum zinc_message_t msg_button);
 
 static void PANEL_update(struct zinc_runtime_t *runtime, bool blinky);
 static void PANEL_setting_blinky(struct zinc_runtime_t *runtime);
 
 static void SETTING_timeout_callback(struct zinc_runtime_t *runtime);
-static void SETTING_volume_intv_callback(enum zinc_message_t msg_button);
-static void SETTING_dim_intv_callback(enum zinc_message_t msg_button);
 
+static void MSG_lamp_toggle(struct zinc_runtime_t *runtime);
+
+static void LIGHT_sensor_sample_callback(struct light_sensor_ad_t *light_sensor);
 static void LIGHT_sensor_ad_callback(int volt, int raw, struct light_sensor_ad_t *light_sensor);
+static void CLOCK_dim_fade_apply(struct LED_FADE_t *fade, uint8_t dim);
+static void LAMP_dim_fade_apply(struct LED_FADE_t *fade, uint8_t dim);
+static void LAMP_frame_update(uint8_t dim);
 static void MYNOISE_power_off_tickdown_callback(uint32_t power_off_seconds_remain, bool stopping);
 
 static struct zinc_runtime_t zinc = {0};
+
+static struct BUTTON_t const zinc_buttons[] =
+{
+    {.id = MSG_NOISE_BUTTON},
+    {.id = MSG_VOLUME_UP_BUTTON,    .long_press = SETTING_VOLUME_ADJ_INTV, .repeat_intv = SETTING_VOLUME_ADJ_INTV},
+    {.id = MSG_VOLUME_DOWN_BUTTON,  .long_press = SETTING_VOLUME_ADJ_INTV, .repeat_intv = SETTING_VOLUME_ADJ_INTV},
+    {.id = MSG_SNOOZE_BUTTON},
+    {.id = MSG_PREV_BUTTON},
+    {.id = MSG_NEXT_BUTTON},
+    {.id = MSG_TIMER_BUTTON},
+    // lamp dims by LED_FADE_t from long press to long release, no REPEAT
+    {.id = MSG_COLOR_BUTTON,        .long_press = LONG_PRESS_DIM},
+    {.id = MSG_LAMP_BUTTON,         .long_press = LONG_PRESS_DIM},
+};
+
 __THREAD_STACK static uint32_t zinc_stack[1280 / sizeof(uint32_t)];
 
 struct SMART_LED_attr_t const LED_time = SMART_LED_INITIALIZER(&GPIO_PORT(LED_TIME_DAT)->POD, LED_TIME_DAT, 30);
 struct SMART_LED_attr_t const LED_flags = SMART_LED_INITIALIZER(&GPIO_PORT(LED_WDAYS_DAT)->POD, LED_WDAYS_DAT, 14);
 struct SMART_LED_attr_t const LED_lamp = SMART_LED_INITIALIZER(&GPIO_PORT(LED_LAMP_DAT)->POD, LED_LAMP_DAT, 7);
 
+static uint32_t LED_time_sent[30];
+static uint32_t LED_flags_sent[14];
+static uint32_t LED_lamp_sent[7];
+static enum SMART_LED_color_t LED_lamp_colors[7];
+
+static struct LED_FRAME_t LED_time_frame = LED_FRAME_INITIALIZER(&LED_time, LED_time_sent);
+static struct LED_FRAME_t LED_flags_frame = LED_FRAME_INITIALIZER(&LED_flags, LED_flags_sent);
+static struct LED_FRAME_t LED_lamp_frame = LED_FRAME_INITIALIZER(&LED_lamp, LED_lamp_sent);
+
+// all chains are refreshed together
+static struct LED_FRAME_t *const LED_frames[] = {&LED_time_frame, &LED_flags_frame, &LED_lamp_frame};
+
 /****************************************************************************
  *  @implements
  ****************************************************************************/
@@ -126,6 +178,9 @@ void PERIPHERAL_gpio_init(void)
     GPIO_setdir_input_pp(PULL_DOWN, KPAD_COL_3_PIN, true);
 
     GPIO_setdir_input_pp(PULL_UP, EARPHONE_DET_PIN, true);
+
+    KPAD_boot_scan(&zinc.kpad);
+    zinc.usb_en = KPAD_is_down(&zinc.kpad, MSG_NOISE_BUTTON);
 }
 
 void PERIPHERAL_kpad_gpio_intr_enable(void)
@@ -140,10 +195,19 @@ bool PERIPHERAL_is_enable_usb(void)
 #ifdef DEBUG
     return true;
 #else
-    return GPIO_button_is_down(MSG_NOISE_BUTTON);
+    return zinc.usb_en;
 #endif
 }
 
+uint8_t PERIPHERAL_batt_led_percent(void)
+{
+    // lamp is enabled by low LED_LAMP_DIS_PIN
+    if (GPIO_peek_output(LED_LAMP_DIS_PIN))
+        return 0;
+    else
+        return (uint8_t)(zinc.lamp_dim_value * 100U / LAMP_MAX_BRIGHTRESS);
+}
+
 void PERIPHERAL_ota_init(void)
 {
 }
@@ -151,14 +215,12 @@ void PERIPHERAL_ota_init(void)
 void PERIPHERAL_init(void)
 {
     timeout_init(&zinc.gpio_filter_timeo, GPIO_FILTER_INTV, (void *)GPIO_filter_callback, 0);
+    timeout_init(&zinc.kpad.scan_timeo, KPAD_SCAN_INTV, (void *)KPAD_scan_callback, TIMEOUT_FLAG_REPEAT);
     timeout_init(&zinc.setting_timeo, SETTING_TIMEOUT, (void *)SETTING_timeout_callback, 0);
-    timeout_init(&zinc.setting_volume_intv, SETTING_VOLUME_ADJ_INTV, (void *)SETTING_volume_intv_callback, TIMEOUT_FLAG_REPEAT);
     timeout_init(&zinc.setting_blinky_intv, SETTING_BLINKY_INTV, (void *)PANEL_setting_blinky, TIMEOUT_FLAG_REPEAT);
-    timeout_init(&zinc.setting_dim_intv, SETTING_LAMP_DIM_INTV, (void *)SETTING_dim_intv_callback, TIMEOUT_FLAG_REPEAT);
 
-    zinc.display_mtime = 0xFFFFU;
+    zinc.display_mask = (uint32_t)-1;
     zinc.voice_last_tick = (clock_t)-SETTING_TIMEOUT;
-    zinc.batt_last_ts = time(NULL);
 
     // load settings
     if (0 != NVM_get(NVM_SETTING, sizeof(smartcuckoo), &smartcuckoo))
@@ -182,9 +244,17 @@ void PERIPHERAL_init(void)
 
     smartcuckoo.voice_sel_id = VOICE_init(smartcuckoo.voice_sel_id, &smartcuckoo.locale);
     zinc.clock_dim_value = SMART_LED_CENTER_DIM;
+    LED_FADE_init(&zinc.clock_fade, zinc.clock_dim_value, CLOCK_dim_fade_apply);
+    zinc.lamp_dim_value = smartcuckoo.lamp.dim_value;
+    LED_FADE_init(&zinc.lamp_fade, zinc.lamp_dim_value, LAMP_dim_fade_apply);
     PANEL_update(&zinc, false);
 
     MQUEUE_INIT(&zinc.mqd, MQUEUE_PAYLOAD_SIZE, MQUEUE_LENGTH);
+    UI_FSM_init(&zinc.ui, zinc_ui, lengthof(zinc_ui), ZINC_UI_IDLE, &zinc);
+
+    // keypad scanner feeds BUTTON_scan_update() directly
+    BUTTON_engine_init(&zinc.buttons, zinc.mqd, zinc_buttons, lengthof(zinc_buttons), KPAD_SCAN_INTV,
+        NULL, NULL, &zinc);
     PERIPHERAL_kpad_gpio_intr_enable();
 
     if (true)
@@ -235,6 +305,10 @@ void PERIPHERAL_init(void)
     {
         ADC_attr_init(&zinc.light_sensor.attr, ADC_MAX_SPS, (void *)LIGHT_sensor_ad_callback);
         ADC_attr_positive_input(&zinc.light_sensor.attr, LIGHT_SENSOR_AD);
+
+        LIGHT_SENSOR_init(&zinc.light_sensor.filter, LIGHT_SENSOR_MAX_AD_VALUE);
+        timeout_init(&zinc.light_sensor.sample_intv, LIGHT_SENSOR_SAMPLE_INTV, (void *)LIGHT_sensor_sample_callback, TIMEOUT_FLAG_REPEAT);
+        timeout_start(&zinc.light_sensor.sample_intv, &zinc.light_sensor);
     }
 
     MYNOISE_init();
@@ -275,12 +349,45 @@ void CLOCK_shell_set_dim_percent(uint8_t dim)
     }
 }
 
+void CLOCK_start_wake_light_cb(uint8_t alarm_idx, uint32_t ms)
+{
+    (void)alarm_idx;
+
+    // lamp is already on by user
+    if (! GPIO_peek_output(LED_LAMP_DIS_PIN))
+        return;
+
+    // NOTE: immediate fade applies before wake_light is set, a finished fade clears it
+    LED_FADE_to(&zinc.lamp_fade, LAMP_MIN_BRIGHTRESS, 0);
+    zinc.wake_light = true;
+
+    GPIO_clear(LED_LAMP_DIS_PIN);
+    msleep(5);
+
+    LED_FRAME_invalidate(&LED_lamp_frame);
+    LAMP_frame_update(LAMP_MIN_BRIGHTRESS);
+    LED_FRAME_commit(LED_frames, lengthof(LED_frames));
+
+    LED_FADE_to(&zinc.lamp_fade, LAMP_MAX_BRIGHTRESS, ms);
+}
+
+void CLOCK_stop_wake_light_cb(uint8_t alarm_idx)
+{
+    (void)alarm_idx;
+
+    // lamp still belongs to sunrise: turn off, also cancels the fade
+    if (zinc.wake_light)
+        MSG_lamp_toggle(&zinc);
+}
+
 void mplayer_idle_callback(void)
 {
-    if (zinc.setting)
+    if (UI_FSM_is_state(&zinc.ui, ZINC_UI_SETTING))
         timeout_start(&zinc.setting_timeo, &zinc);
     else
         CLOCK_schedule();
+
+    AUDIO_PM_idle();
 }
 
 static void MYNOISE_power_off_tickdown_callback(uint32_t power_off_seconds_remain, bool stopping)
@@ -293,10 +400,11 @@ void CLOCK_update_display_callback(struct tm const *dt)
 {
     static uint8_t old_dim = 0;
 
-    if (! zinc.setting)
+    if (! UI_FSM_is_state(&zinc.ui, ZINC_UI_SETTING))
     {
+        POWER_enter(POWER_CAUSE_LED);
         uint8_t dim = (uint8_t)(zinc.clock_dim_value * smartcuckoo.dim_percent / 100);
-        uint16_t mtime;
+        unsigned hour = (unsigned)dt->tm_hour;
         uint32_t flags;
 
         enum LOCALE_hfmt_t fmt = smartcuckoo.locale.hfmt;
@@ -305,20 +413,17 @@ void CLOCK_update_display_callback(struct tm const *dt)
 
         if (HFMT_12 == fmt)
         {
-            int hour = dt->tm_hour % 12;
+            hour = hour % 12;
             if (12 == dt->tm_hour) hour = 12;
-
-            mtime = (uint16_t)(hour * 100 + dt->tm_min);
         }
-        else
-            mtime =  (uint16_t)(dt->tm_hour * 100 + dt->tm_min);
 
-        if (zinc.display_mtime != mtime || old_dim != dim)
-        {
-            zinc.display_mtime = mtime;
+        uint32_t mask = SMART_LED_time_mask_hm(hour, (unsigned)dt->tm_min, true) | SMART_LED_TIME_MASK_IND;
+        uint32_t diff = mask ^ zinc.display_mask;
 
-            uint32_t mask = SMART_LED_time_mask_digit(mtime, true) | SMART_LED_TIME_MASK_IND;
-            SMART_LED_update(&LED_time, dim, smartcuckoo.led_color.time, mask);
+        if (0 != diff || old_dim != dim)
+        {
+            zinc.display_mask = mask;
+            LED_FRAME_update(&LED_time_frame, dim, smartcuckoo.led_color.time, mask);
         }
 
         if (1)
@@ -339,10 +444,12 @@ void CLOCK_update_display_callback(struct tm const *dt)
         if (flags != zinc.display_flags || old_dim != dim)
         {
             zinc.display_flags = flags;
-            SMART_LED_update_color(&LED_flags, dim, &smartcuckoo.led_color.time + 1, flags);
+            LED_FRAME_update_color(&LED_flags_frame, dim, &smartcuckoo.led_color.time + 1, flags);
         }
 
+        LED_FRAME_commit(LED_frames, lengthof(LED_frames));
         old_dim = dim;
+        POWER_leave(POWER_CAUSE_LED);
     }
 }
 
@@ -351,7 +458,7 @@ void CLOCK_update_display_callback(struct tm const *dt)
  ****************************************************************************/
 static void PANEL_setting_blinky(struct zinc_runtime_t *runtime)
 {
-    if (runtime->setting)
+    if (UI_FSM_is_state(&runtime->ui, ZINC_UI_SETTING))
     {
         uint32_t mask = 0;
         uint8_t alarms = 0;
@@ -424,8 +531,9 @@ static void PANEL_setting_blinky(struct zinc_runtime_t *runtime)
         if (update)
         {
             uint8_t dim = (uint8_t)(zinc.clock_dim_value * smartcuckoo.dim_percent / 100);
+            POWER_enter(POWER_CAUSE_LED);
 
-            SMART_LED_update(&LED_time, dim, smartcuckoo.led_color.time, mask);
+            LED_FRAME_update(&LED_time_frame, dim, smartcuckoo.led_color.time, mask);
             runtime->setting_blinky ++;
 
             if (1)
@@ -436,16 +544,19 @@ static void PANEL_setting_blinky(struct zinc_runtime_t *runtime)
                 if (flags != zinc.display_flags)
                 {
                     zinc.display_flags = flags;
-                    SMART_LED_update_color(&LED_flags, dim, &smartcuckoo.led_color.time + 1, flags);
+                    LED_FRAME_update_color(&LED_flags_frame, dim, &smartcuckoo.led_color.time + 1, flags);
                 }
             }
+
+            LED_FRAME_commit(LED_frames, lengthof(LED_frames));
+            POWER_leave(POWER_CAUSE_LED);
         }
     }
 }
 
 static void PANEL_update(struct zinc_runtime_t *runtime, bool blinky)
 {
-    if (zinc.setting)
+    if (UI_FSM_is_state(&zinc.ui, ZINC_UI_SETTING))
     {
         runtime->setting_blinky = blinky;
         PANEL_setting_blinky(runtime);
@@ -454,7 +565,7 @@ static void PANEL_update(struct zinc_runtime_t *runtime, bool blinky)
     }
     else
     {
-        runtime->display_mtime = (uint16_t)-1;
+        runtime->display_mask = (uint32_t)-1;
         runtime->display_flags = (uint16_t)-1;
 
         time_t ts = time(NULL);
@@ -462,646 +573,343 @@ static void PANEL_update(struct zinc_runtime_t *runtime, bool blinky)
     }
 }
 
+static void LIGHT_sensor_sample_callback(struct light_sensor_ad_t *light_sensor)
+{
+    POWER_track(POWER_CAUSE_SENSOR, true);
+    ADC_start_convert(&light_sensor->attr, light_sensor);
+}
+
 static void LIGHT_sensor_ad_callback(int volt, int raw, struct light_sensor_ad_t *light_sensor)
 {
     (void)volt;
-    raw = MIN(LIGHT_SENSOR_MAX_AD_VALUE, raw);
+    ADC_stop_convert(&light_sensor->attr);
+    POWER_track(POWER_CAUSE_SENSOR, false);
 
-    if (LIGHT_SENSITIVE < abs(raw - light_sensor->value))
+    // dim is changed by band only, flicker & shadows never reach the display
+    int band = LIGHT_SENSOR_feed(&light_sensor->filter, raw, clock());
+    if (-1 != band)
     {
-        light_sensor->value = raw;
+        raw = LIGHT_SENSOR_band_value(&light_sensor->filter, band);
         raw = CLOCK_DIM_AUTO_RANGE - raw * CLOCK_DIM_AUTO_RANGE / LIGHT_SENSOR_MAX_AD_VALUE + (CLOCK_DIM_MAX_VALUE - CLOCK_DIM_AUTO_RANGE);
 
-        if (raw != zinc.clock_dim_value)
-        {
-            zinc.display_flags = 0;
-            zinc.clock_dim_value = (uint8_t)raw;
-
-            PANEL_update(&zinc, false);
-        }
-        LOG_debug("%d%%: %d => %d", smartcuckoo.dim_percent, raw, raw *smartcuckoo.dim_percent / 100);
+        if (raw != zinc.clock_fade.target)
+            LED_FADE_to(&zinc.clock_fade, (uint8_t)raw, CLOCK_DIM_FADE_MS);
+        LOG_debug("%d%%: band %d => %d", smartcuckoo.dim_percent, band, raw *smartcuckoo.dim_percent / 100);
     }
-    ADC_stop_convert(&light_sensor->attr);
 }
 
-/****************************************************************************
- *  @private: buttons
- ****************************************************************************/
-static void GPIO_button_callback(uint32_t pins, struct zinc_runtime_t *runtime)
+static void CLOCK_dim_fade_apply(struct LED_FADE_t *fade, uint8_t dim)
 {
-    enum zinc_message_t msg_button;
+    (void)fade;
 
-    GPIO_intr_disable(KPAD_COL_1_PIN);
-    GPIO_intr_disable(KPAD_COL_2_PIN);
-    GPIO_intr_disable(KPAD_COL_3_PIN);
+    zinc.display_flags = 0;
+    zinc.clock_dim_value = dim;
 
-    if (KPAD_COL_1_PIN == (KPAD_COL_1_PIN & pins))
-    {
-        GPIO_clear(KPAD_ROW_1_PIN);  usleep(1);
-        if (0 == GPIO_peek(KPAD_COL_1_PIN))
-        {
-            msg_button = MSG_NOISE_BUTTON;
-            goto gpio_send_filter;
-        }
+    PANEL_update(&zinc, false);
+}
 
-        GPIO_clear(KPAD_ROW_2_PIN);  usleep(1);
-        if (0 == GPIO_peek(KPAD_COL_1_PIN))
-        {
-            msg_button = MSG_VOLUME_UP_BUTTON;
-            goto gpio_send_filter;
-        }
+static void LAMP_dim_fade_apply(struct LED_FADE_t *fade, uint8_t dim)
+{
+    // NOTE: also the sunrise ramp, user's setting is saved by MSG_lamp_dim_stop() only
+    zinc.lamp_dim_value = dim;
 
-        GPIO_clear(KPAD_ROW_3_PIN);  usleep(1);
-        if (0 == GPIO_peek(KPAD_COL_1_PIN))
-        {
-            msg_button = MSG_VOLUME_DOWN_BUTTON;
-            goto gpio_send_filter;
-        }
-    }
+    // sunrise is completed: all LEDs are in lamp color
+    if (! LED_FADE_is_running(fade))
+        zinc.wake_light = false;
 
-    if (KPAD_COL_2_PIN == (KPAD_COL_2_PIN & pins))
+    if (0 == GPIO_peek(LED_LAMP_DIS_PIN))
     {
-        GPIO_clear(KPAD_ROW_1_PIN);  usleep(1);
-        if (0 == GPIO_peek(KPAD_COL_2_PIN))
-        {
-            msg_button = MSG_SNOOZE_BUTTON;
-            goto gpio_send_filter;
-        }
-
-        GPIO_clear(KPAD_ROW_2_PIN);  usleep(1);
-        if (0 == GPIO_peek(KPAD_COL_2_PIN))
-        {
-            msg_button = MSG_PREV_BUTTON;
-            goto gpio_send_filter;
-        }
-
-        GPIO_clear(KPAD_ROW_3_PIN);  usleep(1);
-        if (0 == GPIO_peek(KPAD_COL_2_PIN))
-        {
-            msg_button = MSG_NEXT_BUTTON;
-            goto gpio_send_filter;
-        }
+        LAMP_frame_update(dim);
+        LED_FRAME_commit(LED_frames, lengthof(LED_frames));
     }
+}
 
-    if (KPAD_COL_3_PIN == (KPAD_COL_3_PIN & pins))
+static void LAMP_frame_update(uint8_t dim)
+{
+    if (zinc.wake_light)
     {
-        GPIO_clear(KPAD_ROW_1_PIN);  usleep(1);
-        if (0 == GPIO_peek(KPAD_COL_3_PIN))
-        {
-            runtime->timer_button_stick = 0;
+        // color temperature rises by the LEDs turning from dawn color into lamp color along with dim
+        unsigned day = (unsigned)(MAX(dim, LAMP_MIN_BRIGHTRESS) - LAMP_MIN_BRIGHTRESS) * (lengthof(LED_lamp_colors) + 1) /
+            (LAMP_MAX_BRIGHTRESS - LAMP_MIN_BRIGHTRESS + 1);
 
-            msg_button = MSG_TIMER_BUTTON;
-            goto gpio_send_filter;
-        }
-
-        GPIO_clear(KPAD_ROW_2_PIN);  usleep(1);
-        if (0 == GPIO_peek(KPAD_COL_3_PIN))
+        // center LED first
+        for (unsigned i = 0; i < lengthof(LED_lamp_colors); i ++)
         {
-            runtime->dim_stick = 0;
-
-            msg_button = MSG_COLOR_BUTTON;
-            goto gpio_send_filter;
+            unsigned dist = (unsigned)abs((int)i - (int)lengthof(LED_lamp_colors) / 2);
+            LED_lamp_colors[i] = 2 * dist < day ? smartcuckoo.lamp.color : WAKE_LIGHT_DAWN_COLOR;
         }
-
-        GPIO_clear(KPAD_ROW_3_PIN);  usleep(1);
-        if (0 == GPIO_peek(KPAD_COL_3_PIN))
-        {
-            runtime->dim_stick = 0;
-
-            msg_button = MSG_LAMP_BUTTON;
-            goto gpio_send_filter;
-        }
-    }
-
-    if (0)
-    {
-    gpio_send_filter:
-        timeout_start(&runtime->gpio_filter_timeo, (void *)msg_button);
+        LED_FRAME_update_color(&LED_lamp_frame, dim, LED_lamp_colors, 0xFFFFFFFFUL);
     }
     else
-        PERIPHERAL_kpad_gpio_intr_enable();
-
-    GPIO_set(KPAD_ROW_1_PIN);
-    GPIO_set(KPAD_ROW_2_PIN);
-    GPIO_set(KPAD_ROW_3_PIN);
+        LED_FRAME_update(&LED_lamp_frame, dim, smartcuckoo.lamp.color, 0xFFFFFFFFUL);
 }
 
-static void GPIO_earphone_det_callback(uint32_t pins, struct zinc_runtime_t *runtime)
+/****************************************************************************
+ *  @private: buttons
+ ****************************************************************************/
+static void GPIO_button_callback(uint32_t pins, struct zinc_runtime_t *runtime)
 {
     (void)pins;
-    timeout_start(&runtime->gpio_filter_timeo, (void *)MSG_EARPHONE_DET);
-}
 
-static void GPIO_filter_callback(enum zinc_message_t msg_button)
-{
-    if (MSG_EARPHONE_DET == msg_button)
+    // column interrupts are re-enabled by KPAD_scan_callback() when all keys are released
+    GPIO_intr_disable(KPAD_COL_1_PIN);
+    GPIO_intr_disable(KPAD_COL_2_PIN);
+    GPIO_intr_disable(KPAD_COL_3_PIN);
+
+    if (! timeout_is_running(&runtime->kpad.scan_timeo))
     {
-        bool det = 0 == GPIO_peek(EARPHONE_DET_PIN);
+        // drive first row only, columns are sampled on next tick when the row is settled
+        GPIO_clear(KPAD_ROW_2_PIN);
+        GPIO_clear(KPAD_ROW_3_PIN);
 
-        if (det != zinc.earphone_en)
-        {
-            zinc.earphone_en = det;
-            mqueue_postv(zinc.mqd, msg_button, 0, 0);
-        }
+        runtime->kpad.row = 0;
+        timeout_start(&runtime->kpad.scan_timeo, runtime);
     }
-    else if (GPIO_button_is_down(msg_button))
-        mqueue_postv(zinc.mqd, msg_button, 0, 0);
 }
 
-static bool GPIO_button_is_down(enum zinc_message_t msg_button)
+static void KPAD_scan_callback(struct zinc_runtime_t *runtime)
 {
-    uint32_t pin_column;
-    bool is_down;
+    struct zinc_kpad_t *kpad = &runtime->kpad;
 
-    switch ((int)(msg_button >> 4))
+    // full matrix is sampled once every KPAD_ROWS ticks
+    if (KPAD_scan(kpad))
     {
-    default:
-        // __BREAK_IFDBG();
-        return false;
-
-    case 1:
-        pin_column = KPAD_COL_1_PIN;
-        break;
-    case 2:
-        pin_column = KPAD_COL_2_PIN;
-        break;
-    case 3:
-        pin_column = KPAD_COL_3_PIN;
-        break;
-    }
-
-    if (0 != GPIO_peek(pin_column))
-    {
-        GPIO_intr_disable(pin_column);
-
-        switch (0x0F & msg_button)
+        if (! BUTTON_scan_update(&runtime->buttons, kpad->mask) && 0 == kpad->settling)
         {
-        default:
-            is_down = false;
-            break;
-
-        case 1:
-            GPIO_clear(KPAD_ROW_1_PIN);  usleep(1);
-            is_down = 0 == GPIO_peek(pin_column);
-            GPIO_set(KPAD_ROW_1_PIN);    usleep(1);
-            break;
-
-        case 2:
-            GPIO_clear(KPAD_ROW_2_PIN);  usleep(1);
-            is_down = 0 == GPIO_peek(pin_column);
-            GPIO_set(KPAD_ROW_2_PIN);    usleep(1);
-            break;
-
-        case 3:
-            GPIO_clear(KPAD_ROW_3_PIN);  usleep(1);
-            is_down = 0 == GPIO_peek(pin_column);
-            GPIO_set(KPAD_ROW_3_PIN);    usleep(1);
-            break;
+            timeout_stop(&kpad->scan_timeo);
+
+            GPIO_set(KPAD_ROW_1_PIN);
+            GPIO_set(KPAD_ROW_2_PIN);
+            GPIO_set(KPAD_ROW_3_PIN);
+            PERIPHERAL_kpad_gpio_intr_enable();
         }
     }
-    else
-        is_down = false;
-
-    PERIPHERAL_kpad_gpio_intr_enable();
-    return is_down;
 }
 
-static void SETTING_timeout_callback(struct zinc_runtime_t *runtime)
+static uint32_t KPAD_columns(void)
 {
-    timeout_stop(&runtime->setting_timeo);
-    timeout_stop(&runtime->setting_blinky_intv);
-
-    if (runtime->setting_alarm_is_modified)
-        CLOCK_update_alarms();
-
-    if (runtime->setting_is_modified)
-        NVM_set(NVM_SETTING, sizeof(smartcuckoo), &smartcuckoo);
-
-    if (runtime->setting)   //  REVIEW: exit from setting
-    {
-        runtime->setting = false;
-
-        VOICE_say_setting(VOICE_SETTING_DONE);
-        PANEL_update(runtime, false);
-    }
+    return (0 != GPIO_peek(KPAD_COL_1_PIN) ? 1U : 0) |
+        (0 != GPIO_peek(KPAD_COL_2_PIN) ? 2U : 0) |
+        (0 != GPIO_peek(KPAD_COL_3_PIN) ? 4U : 0);
 }
 
-static void SETTING_volume_intv_callback(enum zinc_message_t msg_button)
+static bool KPAD_scan(struct zinc_kpad_t *kpad)
 {
-    static clock_t tick = 0;
+    uint32_t const rows[KPAD_ROWS] = {KPAD_ROW_1_PIN, KPAD_ROW_2_PIN, KPAD_ROW_3_PIN};
+    unsigned row = kpad->row;
+    uint32_t cols = KPAD_columns();
 
-    zinc.setting_is_modified = true;
-    timeout_start(&zinc.setting_timeo, &zinc);
+    // pipelined: drive next row now, it is sampled on next tick
+    GPIO_clear(rows[row]);
+    kpad->row = (uint8_t)((row + 1) % KPAD_ROWS);
+    GPIO_set(rows[kpad->row]);
 
-    if (GPIO_button_is_down(msg_button))
+    // integrator debounce: counts up while closed, down while open, every key independently
+    for (unsigned col = 0; col < KPAD_COLS; col ++)
     {
-        mqueue_postv(zinc.mqd, msg_button, 0, 0);
-
-        if (0 == tick)
-            tick = clock();
+        unsigned key = col * KPAD_ROWS + row;   // same order as zinc_buttons[]
+        uint32_t bit = 1UL << key;
+        uint8_t integrator = kpad->integrator[key];
 
-        if (500 < clock() - tick)
+        if ((1U << col) & cols)
         {
-            tick = clock();
-    volume_notification_2:
-            char buf[16];
-            SHELL_notification(buf, (unsigned)sprintf(buf, "volume: %d\n", AUDIO_get_volume_percent()));
+            if (KPAD_DEBOUNCE_COUNT > integrator)
+                integrator ++;
+            if (KPAD_DEBOUNCE_COUNT == integrator)
+                kpad->mask |= bit;
+        }
+        else
+        {
+            if (0 < integrator)
+                integrator --;
+            if (0 == integrator)
+                kpad->mask &= ~bit;
         }
-    }
-    else
-    {
-        tick = 0;
-        timeout_stop(&zinc.setting_volume_intv);
 
-        smartcuckoo.volume = AUDIO_get_volume_percent();
-        goto volume_notification_2;
+        kpad->integrator[key] = integrator;
+        if (0 != integrator)
+            kpad->settling |= bit;
+        else
+            kpad->settling &= ~bit;
     }
+    return 0 == kpad->row;
 }
 
-static void SETTING_dim_intv_callback(enum zinc_message_t msg_button)
+static void KPAD_boot_scan(struct zinc_kpad_t *kpad)
 {
-    if (0 == GPIO_peek(LED_LAMP_DIS_PIN) && GPIO_button_is_down(msg_button))
-    {
-        if (MSG_LAMP_DIM_UP == msg_button)
-            smartcuckoo.lamp.dim_value = MIN(LAMP_MAX_BRIGHTRESS, smartcuckoo.lamp.dim_value + 2);
-        else
-            smartcuckoo.lamp.dim_value = MAX(LAMP_MIN_BRIGHTRESS, smartcuckoo.lamp.dim_value - 2);
+    // keys held at power on make no edge: same debounce passes by sleeping ticks, before timer scan
+    if (0 == KPAD_columns())
+        return;
 
-        SMART_LED_update(&LED_lamp, smartcuckoo.lamp.dim_value, smartcuckoo.lamp.color, 0xFFFFFFFFUL);
+    GPIO_clear(KPAD_ROW_2_PIN);
+    GPIO_clear(KPAD_ROW_3_PIN);
+    kpad->row = 0;
+
+    for (unsigned tick = 0; tick < KPAD_ROWS * KPAD_DEBOUNCE_COUNT; tick ++)
+    {
+        msleep(KPAD_SCAN_INTV);
+        KPAD_scan(kpad);
     }
-    else
-        timeout_stop(&zinc.setting_dim_intv);
+
+    GPIO_set(KPAD_ROW_1_PIN);
+    GPIO_set(KPAD_ROW_2_PIN);
+    GPIO_set(KPAD_ROW_3_PIN);
 }
 
-/****************************************************************************
- *  @private: message thread & loops
- ****************************************************************************/
-static void MSG_alive(struct zinc_runtime_t *runtime)
+static bool KPAD_is_down(struct zinc_kpad_t const *kpad, enum zinc_message_t msg_button)
 {
-    ADC_start_convert(&zinc.light_sensor.attr, &zinc.light_sensor);
+    // message id is column << 4 | row, keys are ordered as zinc_buttons[]
+    unsigned key = (((unsigned)msg_button >> 4) - 1U) * KPAD_ROWS + (0x0FU & msg_button) - 1U;
+    return 0 != (kpad->mask & (1UL << key));
+}
 
-    /*
-    if (BATT_HINT_MV > PERIPHERAL_batt_volt())
-    {
-        runtime->batt_last_ts = time(NULL);
-        PERIPHERAL_batt_ad_sync();
+static void GPIO_earphone_det_callback(uint32_t pins, struct zinc_runtime_t *runtime)
+{
+    (void)pins;
+    timeout_start(&runtime->gpio_filter_timeo, (void *)MSG_EARPHONE_DET);
+}
 
-        if (BATT_HINT_MV > PERIPHERAL_batt_volt())
-        {
-            if (MYNOISE_is_running())
-            {
-                MYNOISE_stop();
-                VOICE_say_setting(VOICE_SETTING_EXT_LOW_BATT);
-            }
-        }
-    }
-    else
-    */
+static void GPIO_filter_callback(enum zinc_message_t msg)
+{
+    if (MSG_EARPHONE_DET == msg)
     {
-        if (! runtime->setting)
-            CLOCK_schedule();
+        bool det = 0 == GPIO_peek(EARPHONE_DET_PIN);
 
-        if (BATT_AD_INTV_SECONDS < CLOCK_get_timestamp() - runtime->batt_last_ts)
+        if (det != zinc.earphone_en)
         {
-            runtime->batt_last_ts = CLOCK_get_timestamp();
-            PERIPHERAL_batt_ad_start();
+            zinc.earphone_en = det;
+            mqueue_postv(zinc.mqd, msg, 0, 0);
         }
     }
 }
 
-static void MSG_setting(struct zinc_runtime_t *runtime, enum zinc_message_t msg_button)
+static void SETTING_timeout_callback(struct zinc_runtime_t *runtime)
 {
-    enum VOICE_setting_t old_setting_part = runtime->setting_part;
-    PMU_power_lock();
+    // saving & leaving setting are transitions of dispatch thread
+    mqueue_postv(runtime->mqd, MSG_SETTING_TIMEOUT, 0, 0);
+}
 
-    // SETTING_timeout_release();
+/****************************************************************************
+ *  @private: setting
+ ****************************************************************************/
+static void SETTING_begin(void)
+{
+    POWER_lock(POWER_CAUSE_BUTTON);
 
     MYNOISE_stop();
     mplayer_playlist_clear();
 
     // any button will stop alarming & reminders
     CLOCK_dismiss();
+}
 
-    if (MSG_TIMER_BUTTON == msg_button)
+static void SETTING_end(struct zinc_runtime_t *runtime)
+{
+    if (VOICE_SETTING_ALARM_RINGTONE == runtime->setting_part)
     {
-        if (! runtime->setting)
-        {
-            runtime->setting_part = VOICE_first_setting();
-            runtime->setting = true;
-            runtime->setting_is_modified = false;
-            runtime->setting_alarm_is_modified = false;
-            runtime->setting_alarm_idx = -1;
-
-            time_t ts = time(NULL);
-            localtime_r(&ts, &runtime->setting_dt);
-
-            timeout_start(&runtime->setting_blinky_intv, runtime);
-            PANEL_setting_blinky(runtime);
-
-            goto say_setting_part;
-        }
-        else
-        {
-            timeout_stop(&zinc.setting_blinky_intv);
-
-            runtime->setting = false;
-            VOICE_say_setting(VOICE_SETTING_DONE);
-
-            PANEL_update(runtime, false);
-        }
+        struct CLOCK_moment_t *alarm = CLOCK_get_alarm((uint8_t)runtime->setting_alarm_idx);
+        VOICE_play_ringtone(alarm->ringtone_id);
     }
-    else if (MSG_PREV_BUTTON == msg_button || MSG_NEXT_BUTTON == msg_button)
-    {
-        if (MSG_PREV_BUTTON == msg_button)
-            runtime->setting_part = VOICE_prev_setting(runtime->setting_part);
-        else
-            runtime->setting_part = VOICE_next_setting(runtime->setting_part);
-
-    say_setting_part:
-        if (! smartcuckoo.voice_enabled)
-        {
-            if (VOICE_SETTING_LANG == runtime->setting_part || VOICE_SETTING_VOICE == runtime->setting_part)
-            {
-                if (MSG_NEXT_BUTTON == msg_button || MSG_TIMER_BUTTON == msg_button)
-                    runtime->setting_part = VOICE_SETTING_HOUR;
-                else
-                    runtime->setting_part = VOICE_SETTING_ALARM_RINGTONE;
-            }
-        }
-        struct CLOCK_moment_t *alarm = NULL;
-
-        if (MSG_NEXT_BUTTON == msg_button)
-        {
-            if (VOICE_SETTING_ALARM_RINGTONE == old_setting_part)
-            {
-                runtime->setting_alarm_idx ++;
-
-                if (2 > runtime->setting_alarm_idx)
-                    runtime->setting_part = VOICE_SETTING_ALARM_HOUR;
-            }
-        }
-        else
-        {
-            if (VOICE_SETTING_ALARM_HOUR == old_setting_part)
-            {
-                runtime->setting_alarm_idx --;
 
-                if (0 <= runtime->setting_alarm_idx)
-                    runtime->setting_part = VOICE_SETTING_ALARM_RINGTONE;
-            }
-        }
+    timeout_start(&runtime->setting_timeo, runtime);
+    POWER_unlock(POWER_CAUSE_BUTTON);
+}
 
-        if (VOICE_SETTING_ALARM_HOUR == runtime->setting_part ||
-            VOICE_SETTING_ALARM_MIN == runtime->setting_part ||
-            VOICE_SETTING_ALARM_RINGTONE == runtime->setting_part)
+static void SETTING_part_changed(struct zinc_runtime_t *runtime, uint8_t msg_button,
+    enum VOICE_setting_t old_setting_part)
+{
+    if (! smartcuckoo.voice_enabled)
+    {
+        if (VOICE_SETTING_LANG == runtime->setting_part || VOICE_SETTING_VOICE == runtime->setting_part)
         {
-            if (MSG_NEXT_BUTTON == msg_button)
-            {
-                if (0 > runtime->setting_alarm_idx)
-                    runtime->setting_alarm_idx = 0;
-            }
+            if (MSG_NEXT_BUTTON == msg_button || MSG_TIMER_BUTTON == msg_button)
+                runtime->setting_part = VOICE_SETTING_HOUR;
             else
-            {
-                if (0 > runtime->setting_alarm_idx)
-                    runtime->setting_alarm_idx = 1;
-            }
-
-            alarm = CLOCK_get_alarm((uint8_t)runtime->setting_alarm_idx);
-            time_t ts = mtime2time(alarm->mtime);
-
-            localtime_r(&ts, &runtime->setting_dt);
-            runtime->setting_dt.tm_sec = 0;
-        }
-        else
-        {
-            time_t ts = time(NULL);
-            localtime_r(&ts, &runtime->setting_dt);
-
-            runtime->setting_dt.tm_sec = 0;
-            runtime->setting_alarm_idx = -1;
+                runtime->setting_part = VOICE_SETTING_ALARM_RINGTONE;
         }
+    }
+    struct CLOCK_moment_t *alarm = NULL;
 
-        if (smartcuckoo.voice_enabled)
+    if (MSG_NEXT_BUTTON == msg_button)
+    {
+        if (VOICE_SETTING_ALARM_RINGTONE == old_setting_part)
         {
-            VOICE_say_setting(runtime->setting_part);
-            VOICE_say_setting_part(runtime->setting_part, &runtime->setting_dt, alarm->ringtone_id);
-        }
+            runtime->setting_alarm_idx ++;
 
-        switch (runtime->setting_part)
-        {
-        case VOICE_SETTING_YEAR:
-        case VOICE_SETTING_MONTH:
-        case VOICE_SETTING_MDAY:
-        case VOICE_SETTING_ALARM_RINGTONE:
-            PANEL_update(runtime, false);
-            break;
-
-        case VOICE_SETTING_ALARM_HOUR:
-            PANEL_update(runtime, MSG_NEXT_BUTTON != msg_button);
-            break;
-
-        default:
-            PANEL_update(runtime, true);
-            break;
+            if (2 > runtime->setting_alarm_idx)
+                runtime->setting_part = VOICE_SETTING_ALARM_HOUR;
         }
     }
-    else if (MSG_VOLUME_UP_BUTTON == msg_button || MSG_VOLUME_DOWN_BUTTON == msg_button)
+    else
     {
-        int16_t old_voice_id;
-        struct CLOCK_moment_t *alarm = CLOCK_get_alarm((uint8_t)runtime->setting_alarm_idx);
-
-        switch (runtime->setting_part)
-        {
-        case VOICE_SETTING_EXT_LOW_BATT:
-        case VOICE_SETTING_EXT_ALARM_ON:
-        case VOICE_SETTING_EXT_ALARM_OFF:
-            break;
-
-        case VOICE_SETTING_LANG:
-            old_voice_id = smartcuckoo.voice_sel_id;
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                smartcuckoo.voice_sel_id = VOICE_next_locale();
-            else
-                smartcuckoo.voice_sel_id = VOICE_prev_locale();
-
-            if (old_voice_id != smartcuckoo.voice_sel_id)
-            {
-                smartcuckoo.locale.dfmt = DFMT_DEFAULT;
-                smartcuckoo.locale.hfmt = HFMT_DEFAULT;
-                runtime->setting_is_modified = true;
-            }
-            break;
-
-        case VOICE_SETTING_VOICE:
-            old_voice_id = smartcuckoo.voice_sel_id;
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                smartcuckoo.voice_sel_id = VOICE_next_voice();
-            else
-                smartcuckoo.voice_sel_id = VOICE_prev_voice();
-
-            if (old_voice_id != smartcuckoo.voice_sel_id)
-            {
-                smartcuckoo.locale.dfmt = DFMT_DEFAULT;
-                smartcuckoo.locale.hfmt = HFMT_DEFAULT;
-                runtime->setting_is_modified = true;
-            }
-            break;
-
-        case VOICE_SETTING_HOUR:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                runtime->setting_dt.tm_hour = (runtime->setting_dt.tm_hour + 1) % 24;
-            else
-                runtime->setting_dt.tm_hour = (runtime->setting_dt.tm_hour + 23) % 24;
-            goto setting_rtc_set_time;
-
-        case VOICE_SETTING_MINUTE:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                runtime->setting_dt.tm_min = (runtime->setting_dt.tm_min + 1) % 60;
-            else
-                runtime->setting_dt.tm_min = (runtime->setting_dt.tm_min + 59) % 60;
-            goto setting_rtc_set_time;
-
-        case VOICE_SETTING_YEAR:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                TM_year_add(&runtime->setting_dt, 1);
-            else
-                TM_year_add(&runtime->setting_dt, -1);
-            goto setting_rtc_set_date;
-
-        case VOICE_SETTING_MONTH:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                TM_month_add(&runtime->setting_dt, 1);
-            else
-                TM_month_add(&runtime->setting_dt, -1);
-            goto setting_rtc_set_date;
-
-        case VOICE_SETTING_MDAY:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                TM_mday_add(&runtime->setting_dt, 1);
-            else
-                TM_mday_add(&runtime->setting_dt, -1);
-            goto setting_rtc_set_date;
-
-        case VOICE_SETTING_ALARM_HOUR:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                runtime->setting_dt.tm_hour = (runtime->setting_dt.tm_hour + 1) % 24;
-            else
-                runtime->setting_dt.tm_hour = (runtime->setting_dt.tm_hour + 23) % 24;
-            goto setting_modify_alarm;
-
-        case VOICE_SETTING_ALARM_MIN:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                runtime->setting_dt.tm_min = (runtime->setting_dt.tm_min + 1) % 60;
-            else
-                runtime->setting_dt.tm_min = (runtime->setting_dt.tm_min + 59) % 60;
-            goto setting_modify_alarm;
-
-        case VOICE_SETTING_ALARM_RINGTONE:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                alarm->ringtone_id = (uint8_t)VOICE_next_ringtone(alarm->ringtone_id);
-            else
-                alarm->ringtone_id = (uint8_t)VOICE_prev_ringtone(alarm->ringtone_id);
-            goto setting_modify_alarm;
-
-        case VOICE_SETTING_COUNT:
-            break;
-        };
-
-        if (false)
+        if (VOICE_SETTING_ALARM_HOUR == old_setting_part)
         {
-        setting_rtc_set_time:
-            runtime->setting_dt.tm_sec = 0;
-            RTC_set_epoch_time(mktime(&runtime->setting_dt) - get_dst_offset(&runtime->setting_dt));
-
-            LOG_info("%02d:%02d:%02d", runtime->setting_dt.tm_hour,
-                runtime->setting_dt.tm_min,
-                runtime->setting_dt.tm_sec);
-        }
+            runtime->setting_alarm_idx --;
 
-        if (false)
-        {
-            struct tm date;
-
-        setting_rtc_set_date:
-            date = runtime->setting_dt;
-            date.tm_hour = 0;
-            date.tm_min = 0;
-            date.tm_sec = 0;
-            RTC_set_epoch_time(time(NULL) % 86400 + mktime(&date));
-
-            LOG_info("%04d/%02d/%02d", runtime->setting_dt.tm_year + 1900,
-                runtime->setting_dt.tm_mon + 1,
-                runtime->setting_dt.tm_mday);
+            if (0 <= runtime->setting_alarm_idx)
+                runtime->setting_part = VOICE_SETTING_ALARM_RINGTONE;
         }
+    }
 
-        if (false)
+    if (VOICE_SETTING_ALARM_HOUR == runtime->setting_part ||
+        VOICE_SETTING_ALARM_MIN == runtime->setting_part ||
+        VOICE_SETTING_ALARM_RINGTONE == runtime->setting_part)
+    {
+        if (MSG_NEXT_BUTTON == msg_button)
         {
-        setting_modify_alarm:
-            runtime->setting_alarm_is_modified = true;
-            alarm->enabled = true;
-            alarm->mtime = time2mtime(mktime(&runtime->setting_dt));
-            alarm->mdate = 0;
-            alarm->wdays = 0x7F;
+            if (0 > runtime->setting_alarm_idx)
+                runtime->setting_alarm_idx = 0;
         }
-
-        mplayer_playlist_clear();
-
-        if (smartcuckoo.voice_enabled)
-            VOICE_say_setting_part(runtime->setting_part, &runtime->setting_dt, alarm->ringtone_id);
-
-        PANEL_update(runtime, false);
-    }
-    else if (MSG_SETTING_DIM == msg_button)
-    {
-        if (smartcuckoo.dim_percent >= dim_tbl[lengthof(dim_tbl) - 1])
-            smartcuckoo.dim_percent = dim_tbl[0];
-        else if (smartcuckoo.dim_percent < dim_tbl[0])
-            smartcuckoo.dim_percent = dim_tbl[lengthof(dim_tbl) - 1];
         else
         {
-            for (int i = lengthof(dim_tbl) - 2; i >= 0; i --)
-            {
-                if (smartcuckoo.dim_percent >= dim_tbl[i])
-                {
-                    smartcuckoo.dim_percent = dim_tbl[i + 1];
-                    break;
-                }
-            }
+            if (0 > runtime->setting_alarm_idx)
+                runtime->setting_alarm_idx = 1;
         }
 
-        runtime->setting_is_modified = true;
+        alarm = CLOCK_get_alarm((uint8_t)runtime->setting_alarm_idx);
+        time_t ts = mtime2time(alarm->mtime);
 
-        zinc.display_flags = 0;
-        PANEL_update(runtime, false);
+        localtime_r(&ts, &runtime->setting_dt);
+        runtime->setting_dt.tm_sec = 0;
     }
-    else if (MSG_COLOR_BUTTON == msg_button)
+    else
     {
-        smartcuckoo.led_color.wdays[0] = smartcuckoo.led_color.wdays[1] = smartcuckoo.led_color.wdays[2] =
-            smartcuckoo.led_color.wdays[3] = smartcuckoo.led_color.wdays[4] = smartcuckoo.led_color.wdays[5] =
-            smartcuckoo.led_color.wdays[6] =
-            smartcuckoo.led_color.time = SMART_LED_next_color(smartcuckoo.led_color.time);
-
-        runtime->setting_is_modified = true;
-        runtime->display_flags = 0;
+        time_t ts = time(NULL);
+        localtime_r(&ts, &runtime->setting_dt);
 
-        zinc.display_flags = 0;
-        PANEL_update(runtime, false);
+        runtime->setting_dt.tm_sec = 0;
+        runtime->setting_alarm_idx = -1;
     }
 
-    if (VOICE_SETTING_ALARM_RINGTONE == runtime->setting_part)
+    if (smartcuckoo.voice_enabled)
     {
-        struct CLOCK_moment_t *alarm = CLOCK_get_alarm((uint8_t)runtime->setting_alarm_idx);
-        VOICE_play_ringtone(alarm->ringtone_id);
+        VOICE_say_setting(runtime->setting_part);
+        VOICE_say_setting_part(runtime->setting_part, &runtime->setting_dt, alarm->ringtone_id);
     }
 
-    timeout_start(&runtime->setting_timeo, runtime);
-    PMU_power_unlock();
+    switch (runtime->setting_part)
+    {
+    case VOICE_SETTING_YEAR:
+    case VOICE_SETTING_MONTH:
+    case VOICE_SETTING_MDAY:
+    case VOICE_SETTING_ALARM_RINGTONE:
+        PANEL_update(runtime, false);
+        break;
+
+    case VOICE_SETTING_ALARM_HOUR:
+        PANEL_update(runtime, MSG_NEXT_BUTTON != msg_button);
+        break;
+
+    default:
+        PANEL_update(runtime, true);
+        break;
+    }
 }
 
 /*
 static void MSG_voice_button(struct zinc_runtime_t *runtime)
 {
-    PMU_power_lock();
+    POWER_lock(POWER_CAUSE_BUTTON);
     mplayer_playlist_clear();
     CLOCK_dismiss();
 
@@ -1109,7 +917,7 @@ static void MSG_voice_button(struct zinc_runtime_t *runtime)
     if (BATT_HINT_MV > PERIPHERAL_batt_volt())
         VOICE_say_setting(VOICE_SETTING_EXT_LOW_BATT);
 
-    if (! runtime->setting)
+    if (! UI_FSM_is_state(&runtime->ui, ZINC_UI_SETTING))
     {
         struct tm const *dt = CLOCK_update_timestamp(NULL);
 
@@ -1127,17 +935,109 @@ static void MSG_voice_button(struct zinc_runtime_t *runtime)
         }
     }
 
-    PMU_power_unlock();
+    POWER_unlock(POWER_CAUSE_BUTTON);
 }
 */
 
-static void MSG_mynoise(enum zinc_message_t msg_button)
+static void MSG_lamp_toggle(struct zinc_runtime_t *runtime)
+{
+    (void)runtime;
+
+    if (GPIO_peek_output(LED_LAMP_DIS_PIN))
+    {
+        // back to user's dim, a sunrise may have left the lamp elsewhere
+        LED_FADE_to(&zinc.lamp_fade, smartcuckoo.lamp.dim_value, 0);
+
+        GPIO_clear(LED_LAMP_DIS_PIN);
+        msleep(5);
+
+        // lamp chain was unpowered: latched colors are lost
+        LED_FRAME_invalidate(&LED_lamp_frame);
+        LED_FRAME_update(&LED_lamp_frame, zinc.lamp_dim_value, smartcuckoo.lamp.color, 0xFFFFFFFFUL);
+        LED_FRAME_commit(LED_frames, lengthof(LED_frames));
+    }
+    else
+    {
+        // turning off also cancels sunrise
+        zinc.wake_light = false;
+        LED_FADE_stop(&zinc.lamp_fade);
+
+        LED_FRAME_update(&LED_lamp_frame, zinc.lamp_dim_value, smartcuckoo.lamp.color, 0);
+        LED_FRAME_commit(LED_frames, lengthof(LED_frames));
+        GPIO_set(LED_LAMP_DIS_PIN);
+    }
+}
+
+/****************************************************************************
+ *  @private: zinc_ui[] guards & actions
+ ****************************************************************************/
+static bool MSG_lamp_is_on(void *ctx, uint8_t event, uint8_t id)
+{
+    (void)ctx;
+    (void)event;
+    (void)id;
+
+    // lamp is enabled by low LED_LAMP_DIS_PIN
+    return ! GPIO_peek_output(LED_LAMP_DIS_PIN);
+}
+
+static bool MSG_lamp_was_on(void *ctx, uint8_t event, uint8_t id)
 {
+    struct zinc_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    // lamp is turned on by press, a following short release must not turn it off again
+    return ! runtime->lamp_turned_on;
+}
+
+static void MSG_earphone_det(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zinc_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    LOG_verbose("%d", runtime->earphone_en);
+}
+
+static void MSG_alive_batt(void *ctx, uint8_t event, uint8_t id)
+{
+    (void)ctx;
+    (void)event;
+    (void)id;
+
+    PERIPHERAL_batt_schedule();
+}
+
+static void MSG_alive(void *ctx, uint8_t event, uint8_t id)
+{
+    MSG_alive_batt(ctx, event, id);
+
+    /*
+    if (BATT_HINT_MV > PERIPHERAL_batt_volt())
+    {
+        if (MYNOISE_is_running())
+        {
+            MYNOISE_stop();
+            VOICE_say_setting(VOICE_SETTING_EXT_LOW_BATT);
+        }
+    }
+    else
+    */
+    CLOCK_schedule();
+}
+
+static void MSG_mynoise(void *ctx, uint8_t event, uint8_t id)
+{
+    (void)ctx;
+    (void)event;
+
     int err = 0;
     mplayer_stop();
+    AUDIO_PM_busy(AUDIO_PM_STREAM_NOISE);
 
     /*
-    switch (msg_button)
+    switch (id)
     {
     default:
         break;
@@ -1158,7 +1058,7 @@ static void MSG_mynoise(enum zinc_message_t msg_button)
         break;
     }
     */
-    switch (msg_button)
+    switch (id)
     {
     default:
         break;
@@ -1180,42 +1080,273 @@ static void MSG_mynoise(enum zinc_message_t msg_button)
         LOG_error("%s", AUDIO_strerror(err));
 }
 
-static void MSG_timer_button(struct zinc_runtime_t *runtime)
+static void MSG_volume(void *ctx, uint8_t event, uint8_t id)
 {
-    MSG_setting(runtime, MSG_TIMER_BUTTON);
-}
+    struct zinc_runtime_t *runtime = ctx;
+    (void)event;
+
+    timeout_stop(&runtime->setting_timeo);
 
-static void MSG_volume(struct zinc_runtime_t *runtime, enum zinc_message_t msg_button)
-{
     if (AUDIO_renderer_is_idle())
         VOICE_play_ringtone(CLOCK_get_ringtone_id());
 
-    if (MSG_VOLUME_UP_BUTTON == msg_button)
+    if (MSG_VOLUME_UP_BUTTON == id)
         AUDIO_inc_volume(VOLUME_MAX_PERCENT);
     else
         AUDIO_dec_volume(VOLUME_MIN_PERCENT);
 
     LOG_info("volume: %d", AUDIO_get_volume_percent());
-    timeout_start(&runtime->setting_volume_intv, (void *)msg_button);
+
+    char buf[16];
+    SHELL_notification(buf, (unsigned)sprintf(buf, "volume: %d\n", AUDIO_get_volume_percent()));
 }
 
-static void MSG_lamp_toggle(struct zinc_runtime_t *runtime)
+static void MSG_volume_done(void *ctx, uint8_t event, uint8_t id)
 {
-    if (GPIO_peek_output(LED_LAMP_DIS_PIN))
+    struct zinc_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    runtime->setting_is_modified = true;
+    smartcuckoo.volume = AUDIO_get_volume_percent();
+    timeout_start(&runtime->setting_timeo, runtime);
+}
+
+static void MSG_lamp_press(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zinc_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    runtime->lamp_turned_on = GPIO_peek_output(LED_LAMP_DIS_PIN);
+    if (runtime->lamp_turned_on)
+        MSG_lamp_toggle(runtime);
+}
+
+static void MSG_lamp_off(void *ctx, uint8_t event, uint8_t id)
+{
+    (void)event;
+    (void)id;
+
+    GPIO_clear(LED_LAMP_DIS_PIN);   // force to toggle off
+    MSG_lamp_toggle(ctx);
+}
+
+static void MSG_lamp_dim(void *ctx, uint8_t event, uint8_t id)
+{
+    (void)ctx;
+    (void)event;
+
+    // COLOR brightens, LAMP dims
+    if (0 == GPIO_peek(LED_LAMP_DIS_PIN))
     {
-        GPIO_clear(LED_LAMP_DIS_PIN);
-        msleep(5);
-        SMART_LED_update(&LED_lamp, smartcuckoo.lamp.dim_value, smartcuckoo.lamp.color, 0xFFFFFFFFUL);
+        zinc.wake_light = false;
+        uint8_t target = MSG_COLOR_BUTTON == id ? LAMP_MAX_BRIGHTRESS : LAMP_MIN_BRIGHTRESS;
+        LED_FADE_to(&zinc.lamp_fade, target, LAMP_FADE_MS(zinc.lamp_fade.current, target));
     }
-    else
+}
+
+static void MSG_lamp_dim_stop(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zinc_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    LED_FADE_stop(&runtime->lamp_fade);
+
+    // dimmed by user: the only writer of lamp dim setting
+    if (0 == GPIO_peek(LED_LAMP_DIS_PIN) && smartcuckoo.lamp.dim_value != runtime->lamp_dim_value)
     {
-        timeout_stop(&runtime->setting_dim_intv);
+        smartcuckoo.lamp.dim_value = runtime->lamp_dim_value;
 
-        SMART_LED_update(&LED_lamp, smartcuckoo.lamp.dim_value, smartcuckoo.lamp.color, 0);
-        GPIO_set(LED_LAMP_DIS_PIN);
+        runtime->setting_is_modified = true;
+        timeout_start(&runtime->setting_timeo, runtime);
+    }
+}
+
+static void MSG_lamp_color(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zinc_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    zinc.wake_light = false;
+    smartcuckoo.lamp.color = SMART_LED_next_color(smartcuckoo.lamp.color);
+    LED_FRAME_update(&LED_lamp_frame, zinc.lamp_dim_value, smartcuckoo.lamp.color, 0xFFFFFFFFUL);
+    LED_FRAME_commit(LED_frames, lengthof(LED_frames));
+
+    runtime->setting_is_modified = true;
+    timeout_start(&runtime->setting_timeo, runtime);
+}
+
+static void MSG_setting_enter(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zinc_runtime_t *runtime = ctx;
+    enum VOICE_setting_t old_setting_part = runtime->setting_part;
+    (void)event;
+
+    SETTING_begin();
+
+    runtime->setting_part = VOICE_first_setting();
+    runtime->setting_is_modified = false;
+    runtime->setting_alarm_is_modified = false;
+    runtime->setting_alarm_idx = -1;
+
+    time_t ts = time(NULL);
+    localtime_r(&ts, &runtime->setting_dt);
+
+    timeout_start(&runtime->setting_blinky_intv, runtime);
+    PANEL_setting_blinky(runtime);
+
+    SETTING_part_changed(runtime, id, old_setting_part);
+    SETTING_end(runtime);
+}
+
+static void MSG_setting_done(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zinc_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    SETTING_begin();
+
+    timeout_stop(&runtime->setting_blinky_intv);
+    VOICE_say_setting(VOICE_SETTING_DONE);
+    PANEL_update(runtime, false);
+
+    SETTING_end(runtime);
+}
+
+static void MSG_setting_step(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zinc_runtime_t *runtime = ctx;
+    enum VOICE_setting_t old_setting_part = runtime->setting_part;
+    (void)event;
+
+    SETTING_begin();
+
+    if (MSG_PREV_BUTTON == id)
+        runtime->setting_part = VOICE_prev_setting(runtime->setting_part);
+    else
+        runtime->setting_part = VOICE_next_setting(runtime->setting_part);
+
+    SETTING_part_changed(runtime, id, old_setting_part);
+    SETTING_end(runtime);
+}
+
+static void MSG_setting_adjust(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zinc_runtime_t *runtime = ctx;
+    (void)event;
+
+    SETTING_begin();
+
+    struct CLOCK_moment_t *alarm = CLOCK_get_alarm((uint8_t)runtime->setting_alarm_idx);
+    unsigned modified = UI_setting_adjust(runtime->setting_part, &runtime->setting_dt, alarm,
+        MSG_VOLUME_UP_BUTTON == id);
+
+    if (UI_SETTING_MODIFIED & modified)
+        runtime->setting_is_modified = true;
+    if (UI_SETTING_ALARM_MODIFIED & modified)
+        runtime->setting_alarm_is_modified = true;
+
+    mplayer_playlist_clear();
+
+    if (smartcuckoo.voice_enabled)
+        VOICE_say_setting_part(runtime->setting_part, &runtime->setting_dt, alarm->ringtone_id);
+
+    PANEL_update(runtime, false);
+    SETTING_end(runtime);
+}
+
+static void MSG_setting_dim(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zinc_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    SETTING_begin();
+
+    if (smartcuckoo.dim_percent >= dim_tbl[lengthof(dim_tbl) - 1])
+        smartcuckoo.dim_percent = dim_tbl[0];
+    else if (smartcuckoo.dim_percent < dim_tbl[0])
+        smartcuckoo.dim_percent = dim_tbl[lengthof(dim_tbl) - 1];
+    else
+    {
+        for (int i = lengthof(dim_tbl) - 2; i >= 0; i --)
+        {
+            if (smartcuckoo.dim_percent >= dim_tbl[i])
+            {
+                smartcuckoo.dim_percent = dim_tbl[i + 1];
+                break;
+            }
+        }
     }
+
+    runtime->setting_is_modified = true;
+
+    zinc.display_flags = 0;
+    PANEL_update(runtime, false);
+    SETTING_end(runtime);
+}
+
+static void MSG_setting_color(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zinc_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    SETTING_begin();
+
+    smartcuckoo.led_color.wdays[0] = smartcuckoo.led_color.wdays[1] = smartcuckoo.led_color.wdays[2] =
+        smartcuckoo.led_color.wdays[3] = smartcuckoo.led_color.wdays[4] = smartcuckoo.led_color.wdays[5] =
+        smartcuckoo.led_color.wdays[6] =
+        smartcuckoo.led_color.time = SMART_LED_next_color(smartcuckoo.led_color.time);
+
+    runtime->setting_is_modified = true;
+    runtime->display_flags = 0;
+
+    zinc.display_flags = 0;
+    PANEL_update(runtime, false);
+    SETTING_end(runtime);
 }
 
+static void MSG_setting_dismiss(void *ctx, uint8_t event, uint8_t id)
+{
+    (void)event;
+    (void)id;
+
+    SETTING_begin();
+    SETTING_end(ctx);
+}
+
+static void MSG_setting_save(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zinc_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    if (runtime->setting_alarm_is_modified)
+        CLOCK_update_alarms();
+
+    if (runtime->setting_is_modified)
+        NVM_set(NVM_SETTING, sizeof(smartcuckoo), &smartcuckoo);
+}
+
+static void MSG_setting_timeout(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zinc_runtime_t *runtime = ctx;
+
+    timeout_stop(&runtime->setting_blinky_intv);
+    MSG_setting_save(ctx, event, id);
+
+    VOICE_say_setting(VOICE_SETTING_DONE);
+    PANEL_update(runtime, false);
+}
+
+/****************************************************************************
+ *  @private: message thread
+ ****************************************************************************/
 static __attribute__((noreturn)) void *MSG_dispatch_thread(struct zinc_runtime_t *runtime)
 {
     while (true)
@@ -1225,120 +1356,17 @@ static __attribute__((noreturn)) void *MSG_dispatch_thread(struct zinc_runtime_t
 
         if (msg)
         {
-            if (MSG_EARPHONE_DET == msg->msgid)
-            {
-                LOG_verbose("%d", runtime->earphone_en);
-            }
-            else if (! runtime->setting)
-            {
-                switch ((enum zinc_message_t)msg->msgid)
-                {
-                default:
-                    break;
-
-                case MSG_SNOOZE_BUTTON:
-                    break;
-
-                case MSG_NOISE_BUTTON:
-                case MSG_PREV_BUTTON:
-                case MSG_NEXT_BUTTON:
-                    MSG_mynoise((enum zinc_message_t)msg->msgid);
-                    break;
-
-                case MSG_VOLUME_UP_BUTTON:
-                case MSG_VOLUME_DOWN_BUTTON:
-                    MSG_volume(runtime, (enum zinc_message_t)msg->msgid);
-                    break;
-
-                case MSG_TIMER_BUTTON:
-                    MSG_timer_button(runtime);
-                    /*
-                    if (GPIO_button_is_down(MSG_TIMER_BUTTON))
-                    {
-                        if (0 == runtime->timer_button_stick)
-                            runtime->timer_button_stick = clock();
-
-                        if (LONG_PRESS_SETTING > clock() - runtime->timer_button_stick)
-                        {
-                            thread_yield();
-                            mqueue_postv(runtime->mqd, MSG_TIMER_BUTTON, 0, 0);
-                        }
-                        else
-                            MSG_setting(runtime, MSG_TIMER_BUTTON);
-                    }
-                    else
-                        MSG_timer_button(runtime);
-                    */
-                    break;
-
-                case MSG_COLOR_BUTTON:
-                    if (GPIO_button_is_down(MSG_COLOR_BUTTON))
-                    {
-                        if (0 == runtime->dim_stick)
-                            runtime->dim_stick = clock();
-
-                        if (LONG_PRESS_DIM > clock() - runtime->dim_stick)
-                        {
-                            thread_yield();
-                            mqueue_postv(runtime->mqd, MSG_COLOR_BUTTON, 0, 0);
-                        }
-                        else
-                            timeout_start(&runtime->setting_dim_intv, (void *)MSG_LAMP_DIM_UP);
-                    }
-                    else
-                    {
-                        if (! GPIO_peek_output(LED_LAMP_DIS_PIN))
-                        {
-                            smartcuckoo.lamp.color = SMART_LED_next_color(smartcuckoo.lamp.color);
-                            SMART_LED_update(&LED_lamp, smartcuckoo.lamp.dim_value, smartcuckoo.lamp.color, 0xFFFFFFFFUL);
-
-                            runtime->setting_is_modified = true;
-                            timeout_start(&runtime->setting_timeo, &zinc);
-                        }
-                    }
-                    break;
-
-                case MSG_LAMP_BUTTON:
-                    if (GPIO_peek_output(LED_LAMP_DIS_PIN))
-                    {
-                        MSG_lamp_toggle(runtime);
-
-                        mqueue_flush(runtime->mqd);
-                        mqueue_postv(runtime->mqd, MSG_LAMP_LONG_PRESS, 0, 0);
-                    }
-                    else
-                        mqueue_postv(runtime->mqd, MSG_LAMP_LONG_PRESS_OFF, 0, 0);
-                    break;
-
-                case MSG_LAMP_LONG_PRESS:
-                case MSG_LAMP_LONG_PRESS_OFF:
-                    if (GPIO_button_is_down(MSG_LAMP_BUTTON))
-                    {
-                        if (0 == runtime->dim_stick)
-                            runtime->dim_stick = clock();
-
-                        if (LONG_PRESS_DIM > clock() - runtime->dim_stick)
-                        {
-                            thread_yield();
-                            mqueue_postv(runtime->mqd, msg->msgid, 0, 0);
-                        }
-                        else
-                            timeout_start(&runtime->setting_dim_intv, (void *)MSG_LAMP_DIM_DOWN);
-                    }
-                    else if (MSG_LAMP_LONG_PRESS_OFF == msg->msgid)
-                    {
-                        GPIO_clear(LED_LAMP_DIS_PIN);   // force to toggle off
-                        MSG_lamp_toggle(runtime);
-                    }
-                    break;
-                }
-            }
-            else
-                MSG_setting(runtime, (enum zinc_message_t)msg->msgid);
+            POWER_enter(POWER_CAUSE_BUTTON);
+            UI_FSM_dispatch(&runtime->ui, msg->msgid);
+            POWER_leave(POWER_CAUSE_BUTTON);
 
             mqueue_release_pool(runtime->mqd, msg);
         }
         else
-            MSG_alive(runtime);
+        {
+            POWER_enter(POWER_CAUSE_ALIVE);
+            UI_FSM_dispatch(&runtime->ui, MSG_ALIVE);
+            POWER_leave(POWER_CAUSE_ALIVE);
+        }
     }
 }
@@ -0,0 +1,108 @@
+#ifndef __ZINC_UI_H
+#define __ZINC_UI_H                     1
+
+#include "button.h"
+#include "ui_fsm.h"
+
+/***************************************************************************
+ *  zinc UI: states x events => actions
+ *
+ *      included by zinc.c implementing the actions & guards,
+ *      and by test/host/test_ui_zinc.c replaying scripts against stubs of them
+***************************************************************************/
+enum zinc_message_t
+{
+    MSG_NOISE_BUTTON            = 0x11,
+    MSG_VOLUME_UP_BUTTON,
+    MSG_VOLUME_DOWN_BUTTON,
+    MSG_SNOOZE_BUTTON           = 0x21,
+    MSG_PREV_BUTTON,
+    MSG_NEXT_BUTTON,
+    MSG_TIMER_BUTTON            = 0x31,
+    MSG_COLOR_BUTTON,
+    MSG_LAMP_BUTTON,
+
+    MSG_EARPHONE_DET            = 0x80,
+    MSG_ALIVE,
+    MSG_SETTING_TIMEOUT,
+
+    MSG_SETTING_DIM = MSG_LAMP_BUTTON
+};
+
+enum zinc_ui_state_t
+{
+    ZINC_UI_IDLE                = 0,
+    ZINC_UI_SETTING,
+};
+
+static bool MSG_lamp_is_on(void *ctx, uint8_t event, uint8_t id);
+static bool MSG_lamp_was_on(void *ctx, uint8_t event, uint8_t id);
+
+static void MSG_earphone_det(void *ctx, uint8_t event, uint8_t id);
+static void MSG_alive(void *ctx, uint8_t event, uint8_t id);
+static void MSG_alive_batt(void *ctx, uint8_t event, uint8_t id);
+static void MSG_mynoise(void *ctx, uint8_t event, uint8_t id);
+static void MSG_volume(void *ctx, uint8_t event, uint8_t id);
+static void MSG_volume_done(void *ctx, uint8_t event, uint8_t id);
+static void MSG_lamp_press(void *ctx, uint8_t event, uint8_t id);
+static void MSG_lamp_off(void *ctx, uint8_t event, uint8_t id);
+static void MSG_lamp_dim(void *ctx, uint8_t event, uint8_t id);
+static void MSG_lamp_dim_stop(void *ctx, uint8_t event, uint8_t id);
+static void MSG_lamp_color(void *ctx, uint8_t event, uint8_t id);
+
+static void MSG_setting_enter(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_done(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_step(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_adjust(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_dim(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_color(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_dismiss(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_timeout(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_save(void *ctx, uint8_t event, uint8_t id);
+
+static struct UI_transition_t const zinc_ui[] =
+{
+    UI_ON(UI_STATE_ANY,             UI_EVENT_ANY,       MSG_EARPHONE_DET,       MSG_earphone_det,       UI_STATE_SAME),
+    UI_ON(ZINC_UI_SETTING,          UI_EVENT_ANY,       MSG_SETTING_TIMEOUT,    MSG_setting_timeout,    ZINC_UI_IDLE),
+    UI_ON(UI_STATE_ANY,             UI_EVENT_ANY,       MSG_SETTING_TIMEOUT,    MSG_setting_save,       UI_STATE_SAME),
+    UI_ON(ZINC_UI_IDLE,             UI_EVENT_ANY,       MSG_ALIVE,              MSG_alive,              UI_STATE_SAME),
+    UI_ON(ZINC_UI_SETTING,          UI_EVENT_ANY,       MSG_ALIVE,              MSG_alive_batt,         UI_STATE_SAME),
+
+    UI_ON(ZINC_UI_IDLE,             BUTTON_PRESS,       MSG_NOISE_BUTTON,       MSG_mynoise,            UI_STATE_SAME),
+    UI_ON(ZINC_UI_IDLE,             BUTTON_PRESS,       MSG_PREV_BUTTON,        MSG_mynoise,            UI_STATE_SAME),
+    UI_ON(ZINC_UI_IDLE,             BUTTON_PRESS,       MSG_NEXT_BUTTON,        MSG_mynoise,            UI_STATE_SAME),
+    UI_ON(ZINC_UI_IDLE,             BUTTON_PRESS,       MSG_TIMER_BUTTON,       MSG_setting_enter,      ZINC_UI_SETTING),
+
+    // VOLUME: press & repeat adjust, release saves
+    UI_ON(ZINC_UI_IDLE,             BUTTON_RELEASE,     MSG_VOLUME_UP_BUTTON,   MSG_volume_done,        UI_STATE_SAME),
+    UI_ON(ZINC_UI_IDLE,             BUTTON_LONG_RELEASE, MSG_VOLUME_UP_BUTTON,  MSG_volume_done,        UI_STATE_SAME),
+    UI_ON(ZINC_UI_IDLE,             UI_EVENT_ANY,       MSG_VOLUME_UP_BUTTON,   MSG_volume,             UI_STATE_SAME),
+    UI_ON(ZINC_UI_IDLE,             BUTTON_RELEASE,     MSG_VOLUME_DOWN_BUTTON, MSG_volume_done,        UI_STATE_SAME),
+    UI_ON(ZINC_UI_IDLE,             BUTTON_LONG_RELEASE, MSG_VOLUME_DOWN_BUTTON, MSG_volume_done,       UI_STATE_SAME),
+    UI_ON(ZINC_UI_IDLE,             UI_EVENT_ANY,       MSG_VOLUME_DOWN_BUTTON, MSG_volume,             UI_STATE_SAME),
+
+    // COLOR: short release changes lamp color, long press brightens until released
+    UI_ON(ZINC_UI_IDLE,             BUTTON_LONG_PRESS,  MSG_COLOR_BUTTON,       MSG_lamp_dim,           UI_STATE_SAME),
+    UI_ON(ZINC_UI_IDLE,             BUTTON_LONG_RELEASE, MSG_COLOR_BUTTON,      MSG_lamp_dim_stop,      UI_STATE_SAME),
+    UI_ON_IF(ZINC_UI_IDLE,          BUTTON_RELEASE,     MSG_COLOR_BUTTON,       MSG_lamp_is_on,
+        MSG_lamp_color,             UI_STATE_SAME),
+
+    // LAMP: press turns on, short release turns off when it was on, long press dims until released
+    UI_ON(ZINC_UI_IDLE,             BUTTON_PRESS,       MSG_LAMP_BUTTON,        MSG_lamp_press,         UI_STATE_SAME),
+    UI_ON(ZINC_UI_IDLE,             BUTTON_LONG_PRESS,  MSG_LAMP_BUTTON,        MSG_lamp_dim,           UI_STATE_SAME),
+    UI_ON(ZINC_UI_IDLE,             BUTTON_LONG_RELEASE, MSG_LAMP_BUTTON,       MSG_lamp_dim_stop,      UI_STATE_SAME),
+    UI_ON_IF(ZINC_UI_IDLE,          BUTTON_RELEASE,     MSG_LAMP_BUTTON,        MSG_lamp_was_on,
+        MSG_lamp_off,               UI_STATE_SAME),
+
+    // setting: TIMER leaves, PREV / NEXT select setting part, VOLUME adjusts it
+    UI_ON(ZINC_UI_SETTING,          BUTTON_PRESS,       MSG_TIMER_BUTTON,       MSG_setting_done,       ZINC_UI_IDLE),
+    UI_ON(ZINC_UI_SETTING,          BUTTON_PRESS,       MSG_PREV_BUTTON,        MSG_setting_step,       UI_STATE_SAME),
+    UI_ON(ZINC_UI_SETTING,          BUTTON_PRESS,       MSG_NEXT_BUTTON,        MSG_setting_step,       UI_STATE_SAME),
+    UI_ON(ZINC_UI_SETTING,          BUTTON_PRESS,       MSG_VOLUME_UP_BUTTON,   MSG_setting_adjust,     UI_STATE_SAME),
+    UI_ON(ZINC_UI_SETTING,          BUTTON_PRESS,       MSG_VOLUME_DOWN_BUTTON, MSG_setting_adjust,     UI_STATE_SAME),
+    UI_ON(ZINC_UI_SETTING,          BUTTON_PRESS,       MSG_SETTING_DIM,        MSG_setting_dim,        UI_STATE_SAME),
+    UI_ON(ZINC_UI_SETTING,          BUTTON_PRESS,       MSG_COLOR_BUTTON,       MSG_setting_color,      UI_STATE_SAME),
+    UI_ON(ZINC_UI_SETTING,          BUTTON_PRESS,       UI_ID_ANY,              MSG_setting_dismiss,    UI_STATE_SAME),
+};
+
+#endif
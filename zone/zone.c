@@ -1,4 +1,11 @@
 #include "smartcuckoo.h"
+#include "button.h"
+#include "ui_fsm.h"
+#include "ui_setting.h"
+#include "power.h"
+#include "audio_pm.h"
+
+#include "zone_ui.h"
 
 /****************************************************************************
  *  @def
@@ -8,37 +15,26 @@
 
 #define MQUEUE_ALIVE_INTV               (2500)
 
-enum zone_message_t
-{
-    MSG_TOP_BUTTON              = 1,
-    MSG_POWER_BUTTON,
-    MSG_PREV_BUTTON,
-    MSG_NEXT_BUTTON,
-    MSG_VOLUME_UP_BUTTON,
-    MSG_VOLUME_DOWN_BUTTON,
-};
-
 struct zone_runtime_t
 {
     int mqd;
 
+    struct BUTTON_engine_t buttons;
+    struct UI_fsm_t ui;
     timeout_t setting_timeo;
-    timeout_t setting_volume_intv;
 
-    bytebool_t power_is_down;
-    bytebool_t setting;
     bytebool_t setting_is_modified;
     bytebool_t setting_alarm_is_modified;
 
     enum VOICE_setting_t setting_part;
     struct tm setting_dt;
 
-    clock_t voice_last_tick;
-    clock_t top_button_stick;
-    clock_t power_button_stick;
-    clock_t prev_next_button_stick;
+    bytebool_t top_snoozed;
+    bytebool_t power_dismissed;
+    bytebool_t prev_next_dismissed;
+    bytebool_t prev_next_chord;
 
-    time_t batt_last_ts;
+    clock_t voice_last_tick;
 };
 
 /****************************************************************************
@@ -47,13 +43,24 @@ struct zone_runtime_t
 static __attribute__((noreturn)) void *MSG_dispatch_thread(struct zone_runtime_t *runtime);
 
 static void GPIO_button_callback(uint32_t pins, struct zone_runtime_t *runtime);
+static uint32_t GPIO_button_scan(struct zone_runtime_t *runtime);
 static void SETTING_timeout_callback(struct zone_runtime_t *runtime);
-static void SETTING_volume_intv_callback(enum zone_message_t);
 
 static void MYNOISE_power_off_tickdown_callback(uint32_t power_off_seconds_remain, bool stopping);
 
 // var
 static struct zone_runtime_t zone = {0};
+
+static struct BUTTON_t const zone_buttons[] =
+{
+    {.id = MSG_TOP_BUTTON,          .long_press = LONG_PRESS_VOICE},
+    {.id = MSG_POWER_BUTTON,        .long_press = LONG_PRESS_POWER_DOWN},
+    {.id = MSG_PREV_BUTTON,         .long_press = LONG_PRESS_SETTING},
+    {.id = MSG_NEXT_BUTTON,         .long_press = LONG_PRESS_SETTING},
+    {.id = MSG_VOLUME_UP_BUTTON,    .long_press = SETTING_VOLUME_ADJ_INTV, .repeat_intv = SETTING_VOLUME_ADJ_INTV},
+    {.id = MSG_VOLUME_DOWN_BUTTON,  .long_press = SETTING_VOLUME_ADJ_INTV, .repeat_intv = SETTING_VOLUME_ADJ_INTV},
+};
+
 __THREAD_STACK static uint32_t zone_stack[1280 / sizeof(uint32_t)];
 
 /****************************************************************************
@@ -74,19 +81,20 @@ void PERIPHERAL_gpio_init(void)
     GPIO_setdir_input_pp(PULL_UP, PIN_VOLUME_DOWN_BUTTON, true);
 }
 
+// both edges: button engine wakes for press / release, holding is timed by LONG_PRESS / REPEAT deadlines
 void PERIPHERAL_gpio_intr_enable(void)
 {
-    GPIO_intr_enable(PIN_TOP_BUTTON, TRIG_BY_FALLING_EDGE,
+    GPIO_intr_enable(PIN_TOP_BUTTON, TRIG_BY_BOTH_EDGE,
         (void *)GPIO_button_callback, &zone);
-    GPIO_intr_enable(PIN_POWER_BUTTON, TRIG_BY_FALLING_EDGE,
+    GPIO_intr_enable(PIN_POWER_BUTTON, TRIG_BY_BOTH_EDGE,
         (void *)GPIO_button_callback, &zone);
-    GPIO_intr_enable(PIN_PREV_BUTTON, TRIG_BY_FALLING_EDGE,
+    GPIO_intr_enable(PIN_PREV_BUTTON, TRIG_BY_BOTH_EDGE,
         (void *)GPIO_button_callback, &zone);
-    GPIO_intr_enable(PIN_NEXT_BUTTON, TRIG_BY_FALLING_EDGE,
+    GPIO_intr_enable(PIN_NEXT_BUTTON, TRIG_BY_BOTH_EDGE,
         (void *)GPIO_button_callback, &zone);
-    GPIO_intr_enable(PIN_VOLUME_UP_BUTTON, TRIG_BY_FALLING_EDGE,
+    GPIO_intr_enable(PIN_VOLUME_UP_BUTTON, TRIG_BY_BOTH_EDGE,
         (void *)GPIO_button_callback, &zone);
-    GPIO_intr_enable(PIN_VOLUME_DOWN_BUTTON, TRIG_BY_FALLING_EDGE,
+    GPIO_intr_enable(PIN_VOLUME_DOWN_BUTTON, TRIG_BY_BOTH_EDGE,
         (void *)GPIO_button_callback, &zone);
 }
 
@@ -115,11 +123,9 @@ void PERIPHERAL_ota_init(void)
 
 void PERIPHERAL_init(void)
 {
-    timeout_init(&zone.setting_volume_intv, SETTING_VOLUME_ADJ_INTV, (void *)SETTING_volume_intv_callback, 0);
     timeout_init(&zone.setting_timeo, SETTING_TIMEOUT, (void *)SETTING_timeout_callback, 0);
 
     zone.voice_last_tick = (clock_t)-SETTING_TIMEOUT;
-    zone.batt_last_ts = time(NULL);
 
     // load settings
     if (0 != NVM_get(NVM_SETTING, sizeof(smartcuckoo), &smartcuckoo))
@@ -140,6 +146,10 @@ void PERIPHERAL_init(void)
     smartcuckoo.voice_sel_id = VOICE_init(smartcuckoo.voice_sel_id, &smartcuckoo.locale);
 
     MQUEUE_INIT(&zone.mqd, MQUEUE_PAYLOAD_SIZE, MQUEUE_LENGTH);
+    UI_FSM_init(&zone.ui, zone_ui, lengthof(zone_ui), ZONE_UI_IDLE, &zone);
+
+    BUTTON_engine_init(&zone.buttons, zone.mqd, zone_buttons, lengthof(zone_buttons), BUTTON_SCAN_INTV,
+        (void *)GPIO_button_scan, NULL, &zone);
     PERIPHERAL_gpio_intr_enable();
 
     if (true)
@@ -201,10 +211,12 @@ int CLOCK_alarm_switch(bool en)
 
 void mplayer_idle_callback(void)
 {
-    if (zone.setting)
+    if (UI_FSM_is_state(&zone.ui, ZONE_UI_SETTING))
         timeout_start(&zone.setting_timeo, &zone);
     else
         CLOCK_schedule();
+
+    AUDIO_PM_idle();
 }
 
 static void MYNOISE_power_off_tickdown_callback(uint32_t power_off_seconds_remain, bool stopping)
@@ -242,374 +254,58 @@ static void MYNOISE_power_off_tickdown_callback(uint32_t power_off_seconds_remai
 static void GPIO_button_callback(uint32_t pins, struct zone_runtime_t *runtime)
 {
     (void)pins;
-    timeout_stop(&runtime->setting_timeo);
-
-    if (PIN_TOP_BUTTON == (PIN_TOP_BUTTON & pins))
-    {
-        runtime->top_button_stick = 0;
-        mqueue_postv(runtime->mqd, MSG_TOP_BUTTON, 0, 0);
-    }
 
-    if (PIN_POWER_BUTTON == (PIN_POWER_BUTTON & pins))
-    {
-        runtime->power_button_stick = 0;
-        mqueue_postv(runtime->mqd, MSG_POWER_BUTTON, 0, 0);
-    }
+    // both edges: a release keeps the setting timeout running
+    if (0 != GPIO_button_scan(runtime))
+        timeout_stop(&runtime->setting_timeo);
 
-    if (PIN_PREV_BUTTON == (PIN_PREV_BUTTON & pins))
-    {
-        runtime->prev_next_button_stick = 0;
-        mqueue_postv(runtime->mqd, MSG_PREV_BUTTON, 0, 0);
-    }
-    if (PIN_NEXT_BUTTON == (PIN_NEXT_BUTTON & pins))
-    {
-        runtime->prev_next_button_stick = 0;
-        mqueue_postv(runtime->mqd, MSG_NEXT_BUTTON, 0, 0);
-    }
+    BUTTON_trigger(&runtime->buttons);
+}
 
-    if (PIN_VOLUME_UP_BUTTON == (PIN_VOLUME_UP_BUTTON & pins))
-        mqueue_postv(runtime->mqd, MSG_VOLUME_UP_BUTTON, 0, 0);
-    if (PIN_VOLUME_DOWN_BUTTON == (PIN_VOLUME_DOWN_BUTTON & pins))
-        timeout_start(&runtime->setting_volume_intv, (void *)MSG_VOLUME_DOWN_BUTTON);
+static uint32_t GPIO_button_scan(struct zone_runtime_t *runtime)
+{
+    (void)runtime;
+    uint32_t mask = 0;
+
+    // same order as zone_buttons[]
+    if (0 == GPIO_peek(PIN_TOP_BUTTON))
+        mask |= 1U << 0;
+    if (0 == GPIO_peek(PIN_POWER_BUTTON))
+        mask |= 1U << 1;
+    if (0 == GPIO_peek(PIN_PREV_BUTTON))
+        mask |= 1U << 2;
+    if (0 == GPIO_peek(PIN_NEXT_BUTTON))
+        mask |= 1U << 3;
+    if (0 == GPIO_peek(PIN_VOLUME_UP_BUTTON))
+        mask |= 1U << 4;
+    if (0 == GPIO_peek(PIN_VOLUME_DOWN_BUTTON))
+        mask |= 1U << 5;
+
+    return mask;
 }
 
 static void SETTING_timeout_callback(struct zone_runtime_t *runtime)
 {
-    if (runtime->setting_alarm_is_modified)
-        CLOCK_update_alarms();
-    if (runtime->setting_is_modified)
-        NVM_set(NVM_SETTING, sizeof(smartcuckoo), &smartcuckoo);
-
-    if (runtime->setting)   // REVIEW: exit from setting
-    {
-        runtime->setting = false;
-        VOICE_say_setting(VOICE_SETTING_DONE);
-    }
+    // saving & leaving setting are transitions of dispatch thread
+    mqueue_postv(runtime->mqd, MSG_SETTING_TIMEOUT, 0, 0);
 }
 
-static void SETTING_volume_intv_callback(enum zone_message_t msg_button)
+static void SETTING_say_part(struct zone_runtime_t *runtime)
 {
-    static clock_t tick = 0;
-    timeout_stop(&zone.setting_timeo);
+    struct CLOCK_moment_t *alarm0 = CLOCK_get_alarm(0);
+    UI_setting_load(runtime->setting_part, alarm0, &runtime->setting_dt);
 
-    if (MSG_VOLUME_UP_BUTTON == msg_button)
-    {
-        if (0 == GPIO_peek(PIN_VOLUME_UP_BUTTON))
-        {
-            mqueue_postv(zone.mqd, MSG_VOLUME_UP_BUTTON, 0, 0);
-            goto volume_notification;
-        }
-        else
-            goto volume_adj_done;
-    }
-    else if (MSG_VOLUME_DOWN_BUTTON == msg_button)
-    {
-        if (0 == GPIO_peek(PIN_VOLUME_DOWN_BUTTON))
-        {
-            mqueue_postv(zone.mqd, MSG_VOLUME_DOWN_BUTTON, 0, 0);
-            goto volume_notification;
-        }
-        else
-            goto volume_adj_done;
-    }
-    else
-    {
-    volume_adj_done:
-        tick = 0;
-        timeout_stop(&zone.setting_volume_intv);
-
-        zone.setting_is_modified = true;
-        smartcuckoo.volume = AUDIO_get_volume_percent();
-        timeout_start(&zone.setting_timeo, &zone);
-
-        goto volume_notification_2;
-    }
-
-    if (false)
-    {
-    volume_notification:
-        if (0 == tick)
-            tick = clock();
-
-        if (500 < clock() - tick)
-        {
-            tick = clock();
-    volume_notification_2:
-            char buf[16];
-            SHELL_notification(buf, (unsigned)sprintf(buf, "volume: %d\n", AUDIO_get_volume_percent()));
-        }
-    }
+    VOICE_say_setting(runtime->setting_part);
+    VOICE_say_setting_part(runtime->setting_part, &runtime->setting_dt, alarm0->ringtone_id);
 }
 
 /****************************************************************************
- *  @private: message thread & loops
+ *  @private: noise & alarm
  ****************************************************************************/
-static void MSG_alive(struct zone_runtime_t *runtime)
-{
-    // LOG_debug("alive");
-    if (BATT_HINT_MV > PERIPHERAL_batt_volt())
-    {
-        runtime->batt_last_ts = time(NULL);
-        PERIPHERAL_batt_ad_sync();
-
-        if (BATT_HINT_MV > PERIPHERAL_batt_volt())
-        {
-            if (MYNOISE_is_running())
-            {
-                MYNOISE_stop();
-                VOICE_say_setting(VOICE_SETTING_EXT_LOW_BATT);
-            }
-        }
-    }
-    else
-    {
-        if (! runtime->setting)
-            CLOCK_schedule();
-
-        if (BATT_AD_INTV_SECONDS < CLOCK_get_timestamp() - runtime->batt_last_ts)
-        {
-            runtime->batt_last_ts = CLOCK_get_timestamp();
-            PERIPHERAL_batt_ad_start();
-        }
-    }
-}
-
-static void MSG_voice_button(struct zone_runtime_t *runtime)
-{
-    PMU_power_lock();
-    mplayer_playlist_clear();
-    CLOCK_dismiss();
-
-    // insert say low battery
-    if (BATT_HINT_MV > PERIPHERAL_batt_volt())
-        VOICE_say_setting(VOICE_SETTING_EXT_LOW_BATT);
-
-    if (! runtime->setting)
-    {
-        struct tm const *dt = CLOCK_update_timestamp(NULL);
-
-        if (SETTING_TIMEOUT < clock() - runtime->voice_last_tick)
-        {
-            runtime->voice_last_tick = clock();
-
-            VOICE_say_time(dt);
-            CLOCK_say_reminders(dt, true);
-        }
-        else
-        {
-            runtime->voice_last_tick -= SETTING_TIMEOUT;
-            VOICE_say_date(dt);
-        }
-    }
-
-    PMU_power_unlock();
-}
-
-static void MSG_setting(struct zone_runtime_t *runtime, enum zone_message_t msg_button)
-{
-    PMU_power_lock();
-    mplayer_playlist_clear();
-
-    // any button will stop alarming & reminders
-    CLOCK_dismiss();
-
-    if (MSG_POWER_BUTTON == msg_button)
-    {
-        if (! runtime->setting)
-        {
-            runtime->setting_part = VOICE_first_setting();
-            runtime->setting = true;
-            runtime->setting_is_modified = false;
-            runtime->setting_alarm_is_modified = false;
-
-            goto say_setting_part;
-        }
-        else
-        {
-            runtime->setting = false;
-            VOICE_say_setting(VOICE_SETTING_DONE);
-        }
-    }
-    else if (MSG_PREV_BUTTON == msg_button || MSG_NEXT_BUTTON == msg_button)
-    {
-        if (MSG_PREV_BUTTON == msg_button)
-            runtime->setting_part = VOICE_prev_setting(runtime->setting_part);
-        else
-            runtime->setting_part = VOICE_next_setting(runtime->setting_part);
-
-        struct CLOCK_moment_t *alarm0;
-    say_setting_part:
-        alarm0 = CLOCK_get_alarm(0);
-
-        if (VOICE_SETTING_ALARM_HOUR == runtime->setting_part ||
-            VOICE_SETTING_ALARM_MIN == runtime->setting_part ||
-            VOICE_SETTING_ALARM_RINGTONE == runtime->setting_part)
-        {
-            time_t ts = mtime2time(alarm0->mtime);
-
-            localtime_r(&ts, &runtime->setting_dt);
-            runtime->setting_dt.tm_sec = 0;
-        }
-        else
-        {
-            time_t ts = time(NULL);
-
-            localtime_r(&ts, &runtime->setting_dt);
-            runtime->setting_dt.tm_sec = 0;
-        }
-
-        VOICE_say_setting(runtime->setting_part);
-        VOICE_say_setting_part(runtime->setting_part, &runtime->setting_dt, alarm0->ringtone_id);
-    }
-    else if (MSG_VOLUME_UP_BUTTON == msg_button || MSG_VOLUME_DOWN_BUTTON == msg_button)
-    {
-        int16_t old_voice_id;
-        struct CLOCK_moment_t *alarm0 = CLOCK_get_alarm(0);
-
-        switch (runtime->setting_part)
-        {
-        case VOICE_SETTING_EXT_LOW_BATT:
-        case VOICE_SETTING_EXT_ALARM_ON:
-        case VOICE_SETTING_EXT_ALARM_OFF:
-            break;
-
-        case VOICE_SETTING_LANG:
-            old_voice_id = smartcuckoo.voice_sel_id;
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                smartcuckoo.voice_sel_id = VOICE_next_locale();
-            else
-                smartcuckoo.voice_sel_id = VOICE_prev_locale();
-
-            if (old_voice_id != smartcuckoo.voice_sel_id)
-            {
-                smartcuckoo.locale.dfmt = DFMT_DEFAULT;
-                smartcuckoo.locale.hfmt = HFMT_DEFAULT;
-                runtime->setting_is_modified = true;
-            }
-            break;
-
-        case VOICE_SETTING_VOICE:
-            old_voice_id = smartcuckoo.voice_sel_id;
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                smartcuckoo.voice_sel_id = VOICE_next_voice();
-            else
-                smartcuckoo.voice_sel_id = VOICE_prev_voice();
-
-            if (old_voice_id != smartcuckoo.voice_sel_id)
-            {
-                smartcuckoo.locale.dfmt = DFMT_DEFAULT;
-                smartcuckoo.locale.hfmt = HFMT_DEFAULT;
-                runtime->setting_is_modified = true;
-            }
-            break;
-
-        case VOICE_SETTING_HOUR:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                runtime->setting_dt.tm_hour = (runtime->setting_dt.tm_hour + 1) % 24;
-            else
-                runtime->setting_dt.tm_hour = (runtime->setting_dt.tm_hour + 23) % 24;
-            goto setting_rtc_set_time;
-
-        case VOICE_SETTING_MINUTE:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                runtime->setting_dt.tm_min = (runtime->setting_dt.tm_min + 1) % 60;
-            else
-                runtime->setting_dt.tm_min = (runtime->setting_dt.tm_min + 59) % 60;
-            goto setting_rtc_set_time;
-
-        case VOICE_SETTING_YEAR:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                TM_year_add(&runtime->setting_dt, 1);
-            else
-                TM_year_add(&runtime->setting_dt, -1);
-            goto setting_rtc_set_date;
-
-        case VOICE_SETTING_MONTH:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                TM_month_add(&runtime->setting_dt, 1);
-            else
-                TM_month_add(&runtime->setting_dt, -1);
-            goto setting_rtc_set_date;
-
-        case VOICE_SETTING_MDAY:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                TM_mday_add(&runtime->setting_dt, 1);
-            else
-                TM_mday_add(&runtime->setting_dt, -1);
-            goto setting_rtc_set_date;
-
-        case VOICE_SETTING_ALARM_HOUR:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                runtime->setting_dt.tm_hour = (runtime->setting_dt.tm_hour + 1) % 24;
-            else
-                runtime->setting_dt.tm_hour = (runtime->setting_dt.tm_hour + 23) % 24;
-            goto setting_modify_alarm;
-
-        case VOICE_SETTING_ALARM_MIN:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                runtime->setting_dt.tm_min = (runtime->setting_dt.tm_min + 1) % 60;
-            else
-                runtime->setting_dt.tm_min = (runtime->setting_dt.tm_min + 59) % 60;
-            goto setting_modify_alarm;
-
-        case VOICE_SETTING_ALARM_RINGTONE:
-            if (MSG_VOLUME_UP_BUTTON == msg_button)
-                alarm0->ringtone_id = (uint8_t)VOICE_next_ringtone(alarm0->ringtone_id);
-            else
-                alarm0->ringtone_id = (uint8_t)VOICE_prev_ringtone(alarm0->ringtone_id);
-            goto setting_modify_alarm;
-
-        case VOICE_SETTING_COUNT:
-            break;
-        };
-
-        if (false)
-        {
-        setting_rtc_set_time:
-            runtime->setting_dt.tm_sec = 0;
-            RTC_set_epoch_time(mktime(&runtime->setting_dt) - get_dst_offset(&runtime->setting_dt));
-
-            LOG_info("%02d:%02d:%02d", runtime->setting_dt.tm_hour,
-                runtime->setting_dt.tm_min,
-                runtime->setting_dt.tm_sec);
-        }
-
-        if (false)
-        {
-            struct tm date;
-
-        setting_rtc_set_date:
-            date = runtime->setting_dt;
-            date.tm_hour = 0;
-            date.tm_min = 0;
-            date.tm_sec = 0;
-            RTC_set_epoch_time(time(NULL) % 86400 + mktime(&date));
-
-            LOG_info("%04d/%02d/%02d", runtime->setting_dt.tm_year + 1900,
-                runtime->setting_dt.tm_mon + 1,
-                runtime->setting_dt.tm_mday);
-        }
-
-        if (false)
-        {
-        setting_modify_alarm:
-            runtime->setting_alarm_is_modified = true;
-            alarm0->enabled = true;
-            alarm0->mtime = time2mtime(mktime(&runtime->setting_dt));
-            alarm0->mdate = 0;
-            alarm0->wdays = 0x7F;
-        }
-
-        mplayer_playlist_clear();
-        VOICE_say_setting_part(runtime->setting_part, &runtime->setting_dt, alarm0->ringtone_id);
-    }
-
-    PMU_power_unlock();
-}
-
 static void MSG_mynoise_toggle(bool step)
 {
     mplayer_stop();
+    AUDIO_PM_busy(AUDIO_PM_STREAM_NOISE);
 
     int startting = false;
     if (step)
@@ -656,7 +352,7 @@ static void MSG_mynoise_toggle(bool step)
     {
         int err;
 
-        if (BATT_HINT_MV > PERIPHERAL_batt_ad_sync())
+        if (BATT_HINT_MV > PERIPHERAL_batt_volt())
         {
             VOICE_say_setting(VOICE_SETTING_EXT_LOW_BATT);
             LOG_error("%s", strerror(EBATT));
@@ -692,59 +388,341 @@ static void MSG_alarm_toggle(struct zone_runtime_t *runtime)
         SHELL_notification("alarm: off\n", 11);
 }
 
-static void MSG_power_button(struct zone_runtime_t *runtime, bool power_down)
+static void MSG_mynoise_step(bool next)
 {
-    extern void bluetooth_go_sleep(void);
-    extern void bluetooth_wakeup(void);
+    GPIO_set(LED_POWER);
 
-    if (power_down)
-    {
-        runtime->power_is_down = true;
+    unsigned power_off_seconds = MYNOISE_get_power_off_seconds();
+    MYNOISE_power_off_set_tickdown_cb(NULL);
+    AUDIO_PM_busy(AUDIO_PM_STREAM_NOISE);
 
-        GPIO_intr_disable(PIN_TOP_BUTTON);
-        GPIO_intr_disable(PIN_PREV_BUTTON);
-        GPIO_intr_disable(PIN_NEXT_BUTTON);
-        GPIO_intr_disable(PIN_VOLUME_UP_BUTTON);
-        GPIO_intr_disable(PIN_VOLUME_DOWN_BUTTON);
+    int err = next ? MYNOISE_next() : MYNOISE_prev();
+    MYNOISE_power_off_set_tickdown_cb(MYNOISE_power_off_tickdown_callback);
+
+    if (0 == err)
+        MYNOISE_power_off_seconds(power_off_seconds);
+}
+
+/****************************************************************************
+ *  @private: zone_ui[] guards & actions
+ ****************************************************************************/
+static bool MSG_top_is_free(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zone_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    return ! runtime->top_snoozed;
+}
+
+static bool MSG_power_is_free(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zone_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    return ! runtime->power_dismissed;
+}
+
+static bool MSG_prev_next_is_free(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zone_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
 
+    return ! runtime->prev_next_chord && ! runtime->prev_next_dismissed;
+}
+
+static void MSG_alive_batt(void *ctx, uint8_t event, uint8_t id)
+{
+    (void)ctx;
+    (void)event;
+    (void)id;
+
+    // LOG_debug("alive");
+    PERIPHERAL_batt_schedule();
+
+    if (BATT_HINT_MV > PERIPHERAL_batt_volt() && MYNOISE_is_running())
+    {
         MYNOISE_stop();
-        bluetooth_go_sleep();
+        VOICE_say_setting(VOICE_SETTING_EXT_LOW_BATT);
+    }
+}
 
-        while (0 == GPIO_peek(PIN_POWER_BUTTON))
-        {
-            WDOG_feed();
+static void MSG_alive(void *ctx, uint8_t event, uint8_t id)
+{
+    MSG_alive_batt(ctx, event, id);
 
-            GPIO_clear(LED_POWER);
-            msleep(100);
-            GPIO_set(LED_POWER);
-            msleep(100);
-        }
-        GPIO_set(LED_POWER);
+    if (BATT_HINT_MV <= PERIPHERAL_batt_volt())
+        CLOCK_schedule();
+}
 
+static void MSG_top_press(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zone_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    runtime->top_snoozed = CLOCK_snooze();
+}
+
+static void MSG_top_voice(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zone_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    POWER_lock(POWER_CAUSE_BUTTON);
+    mplayer_playlist_clear();
+    CLOCK_dismiss();
+
+    // insert say low battery
+    if (BATT_HINT_MV > PERIPHERAL_batt_volt())
+        VOICE_say_setting(VOICE_SETTING_EXT_LOW_BATT);
+
+    struct tm const *dt = CLOCK_update_timestamp(NULL);
+
+    if (SETTING_TIMEOUT < clock() - runtime->voice_last_tick)
+    {
+        runtime->voice_last_tick = clock();
+
+        VOICE_say_time(dt);
+        CLOCK_say_reminders(dt, true);
+    }
+    else
+    {
+        runtime->voice_last_tick -= SETTING_TIMEOUT;
+        VOICE_say_date(dt);
+    }
+
+    POWER_unlock(POWER_CAUSE_BUTTON);
+}
+
+static void MSG_top_mynoise(void *ctx, uint8_t event, uint8_t id)
+{
+    (void)ctx;
+    (void)event;
+    (void)id;
+
+    MSG_mynoise_toggle(false);
+}
+
+static void MSG_power_press(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zone_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    runtime->power_dismissed = CLOCK_dismiss();
+}
+
+static void MSG_power_down(void *ctx, uint8_t event, uint8_t id)
+{
+    extern void bluetooth_go_sleep(void);
+    (void)ctx;
+    (void)event;
+    (void)id;
+
+    GPIO_intr_disable(PIN_TOP_BUTTON);
+    GPIO_intr_disable(PIN_PREV_BUTTON);
+    GPIO_intr_disable(PIN_NEXT_BUTTON);
+    GPIO_intr_disable(PIN_VOLUME_UP_BUTTON);
+    GPIO_intr_disable(PIN_VOLUME_DOWN_BUTTON);
+
+    MYNOISE_stop();
+    bluetooth_go_sleep();
+
+    while (0 == GPIO_peek(PIN_POWER_BUTTON))
+    {
+        WDOG_feed();
+
+        GPIO_clear(LED_POWER);
+        msleep(100);
+        GPIO_set(LED_POWER);
+        msleep(100);
     }
-    else if (runtime->power_is_down)
+    GPIO_set(LED_POWER);
+}
+
+static void MSG_power_wakeup(void *ctx, uint8_t event, uint8_t id)
+{
+    extern void bluetooth_wakeup(void);
+
+    PERIPHERAL_gpio_intr_enable();
+    bluetooth_wakeup();
+
+    MSG_power_press(ctx, event, id);
+}
+
+static void MSG_power_mynoise(void *ctx, uint8_t event, uint8_t id)
+{
+    (void)ctx;
+    (void)event;
+    (void)id;
+
+    MSG_mynoise_toggle(true);
+}
+
+static void MSG_prev_next_press(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zone_runtime_t *runtime = ctx;
+    enum zone_message_t other = MSG_PREV_BUTTON == id ? MSG_NEXT_BUTTON : MSG_PREV_BUTTON;
+    (void)event;
+
+    if (BUTTON_is_down(&runtime->buttons, other))
     {
-        PERIPHERAL_gpio_intr_enable();
-        bluetooth_wakeup();
+        // PREV + NEXT: toggle alarm, no more actions until both are released
+        if (! runtime->prev_next_chord && ! runtime->prev_next_dismissed)
+        {
+            MYNOISE_stop();
+            MSG_alarm_toggle(runtime);
+        }
+        runtime->prev_next_chord = true;
+    }
+    else
+        runtime->prev_next_dismissed = CLOCK_dismiss();
+}
 
-        runtime->power_is_down = false;
+static void MSG_prev_next_release(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zone_runtime_t *runtime = ctx;
+    bool chord = runtime->prev_next_chord;
+
+    if (! BUTTON_is_down(&runtime->buttons, MSG_PREV_BUTTON) &&
+        ! BUTTON_is_down(&runtime->buttons, MSG_NEXT_BUTTON))
+    {
+        runtime->prev_next_chord = false;
     }
+
+    if (BUTTON_RELEASE == event && ! chord && ! runtime->prev_next_dismissed && MYNOISE_is_running())
+        MSG_mynoise_step(MSG_NEXT_BUTTON == id);
 }
 
-static void MSG_volume(struct zone_runtime_t *runtime, enum zone_message_t msg_button)
+static void MSG_volume(void *ctx, uint8_t event, uint8_t id)
 {
+    struct zone_runtime_t *runtime = ctx;
+    (void)event;
+
+    timeout_stop(&runtime->setting_timeo);
+
     if (AUDIO_renderer_is_idle())
         VOICE_play_ringtone(CLOCK_get_ringtone_id());
 
-    if (MSG_VOLUME_UP_BUTTON == msg_button)
+    if (MSG_VOLUME_UP_BUTTON == id)
         AUDIO_inc_volume(VOLUME_MAX_PERCENT);
     else
         AUDIO_dec_volume(VOLUME_MIN_PERCENT);
 
     LOG_info("volume: %d", AUDIO_get_volume_percent());
-    timeout_start(&runtime->setting_volume_intv, (void *)msg_button);
+
+    char buf[16];
+    SHELL_notification(buf, (unsigned)sprintf(buf, "volume: %d\n", AUDIO_get_volume_percent()));
+}
+
+static void MSG_volume_done(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zone_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    runtime->setting_is_modified = true;
+    smartcuckoo.volume = AUDIO_get_volume_percent();
+    timeout_start(&runtime->setting_timeo, runtime);
+}
+
+static void MSG_setting_dismiss(void *ctx, uint8_t event, uint8_t id)
+{
+    (void)ctx;
+    (void)event;
+    (void)id;
+
+    // any button will stop alarming & reminders
+    mplayer_playlist_clear();
+    CLOCK_dismiss();
 }
 
+static void MSG_setting_enter(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zone_runtime_t *runtime = ctx;
+
+    MYNOISE_stop();
+    POWER_lock(POWER_CAUSE_BUTTON);
+    MSG_setting_dismiss(ctx, event, id);
+
+    runtime->setting_part = VOICE_first_setting();
+    runtime->setting_is_modified = false;
+    runtime->setting_alarm_is_modified = false;
+    SETTING_say_part(runtime);
+
+    POWER_unlock(POWER_CAUSE_BUTTON);
+}
+
+static void MSG_setting_done(void *ctx, uint8_t event, uint8_t id)
+{
+    POWER_lock(POWER_CAUSE_BUTTON);
+    MSG_setting_dismiss(ctx, event, id);
+
+    VOICE_say_setting(VOICE_SETTING_DONE);
+    POWER_unlock(POWER_CAUSE_BUTTON);
+}
+
+static void MSG_setting_step(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zone_runtime_t *runtime = ctx;
+
+    POWER_lock(POWER_CAUSE_BUTTON);
+    MSG_setting_dismiss(ctx, event, id);
+
+    if (MSG_PREV_BUTTON == id)
+        runtime->setting_part = VOICE_prev_setting(runtime->setting_part);
+    else
+        runtime->setting_part = VOICE_next_setting(runtime->setting_part);
+    SETTING_say_part(runtime);
+
+    POWER_unlock(POWER_CAUSE_BUTTON);
+}
+
+static void MSG_setting_adjust(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zone_runtime_t *runtime = ctx;
+
+    POWER_lock(POWER_CAUSE_BUTTON);
+    MSG_setting_dismiss(ctx, event, id);
+
+    struct CLOCK_moment_t *alarm0 = CLOCK_get_alarm(0);
+    unsigned modified = UI_setting_adjust(runtime->setting_part, &runtime->setting_dt, alarm0,
+        MSG_VOLUME_UP_BUTTON == id);
+
+    if (UI_SETTING_MODIFIED & modified)
+        runtime->setting_is_modified = true;
+    if (UI_SETTING_ALARM_MODIFIED & modified)
+        runtime->setting_alarm_is_modified = true;
+
+    VOICE_say_setting_part(runtime->setting_part, &runtime->setting_dt, alarm0->ringtone_id);
+    POWER_unlock(POWER_CAUSE_BUTTON);
+}
+
+static void MSG_setting_save(void *ctx, uint8_t event, uint8_t id)
+{
+    struct zone_runtime_t *runtime = ctx;
+    (void)event;
+    (void)id;
+
+    if (runtime->setting_alarm_is_modified)
+        CLOCK_update_alarms();
+    if (runtime->setting_is_modified)
+        NVM_set(NVM_SETTING, sizeof(smartcuckoo), &smartcuckoo);
+}
+
+static void MSG_setting_timeout(void *ctx, uint8_t event, uint8_t id)
+{
+    MSG_setting_save(ctx, event, id);
+    VOICE_say_setting(VOICE_SETTING_DONE);
+}
+
+/****************************************************************************
+ *  @private: message thread
+ ****************************************************************************/
 static __attribute__((noreturn)) void *MSG_dispatch_thread(struct zone_runtime_t *runtime)
 {
     while (true)
@@ -754,172 +732,18 @@ static __attribute__((noreturn)) void *MSG_dispatch_thread(struct zone_runtime_t
 
         if (msg)
         {
-            if (! runtime->setting)
-            {
-                switch ((enum zone_message_t)msg->msgid)
-                {
-                case MSG_TOP_BUTTON:
-                    if (! CLOCK_snooze())
-                    {
-                        if (0 == GPIO_peek(PIN_TOP_BUTTON))
-                        {
-                            if (0 == runtime->top_button_stick)
-                                runtime->top_button_stick = clock();
-
-                            if (LONG_PRESS_VOICE > clock() - runtime->top_button_stick)
-                            {
-                                thread_yield();
-                                mqueue_postv(runtime->mqd, MSG_TOP_BUTTON, 0, 0);
-                            }
-                            else
-                            {
-                                CLOCK_dismiss();
-                                MSG_voice_button(runtime);
-                            }
-                        }
-                        else
-                        {
-                            MSG_mynoise_toggle(false);
-                            mqueue_flush(runtime->mqd);
-                        }
-                    }
-                    break;
-
-                case MSG_POWER_BUTTON:
-                    MSG_power_button(runtime, false);
-
-                    if (! CLOCK_dismiss())
-                    {
-                        if (0 == GPIO_peek(PIN_POWER_BUTTON))
-                        {
-                            if (0 == runtime->power_button_stick)
-                                runtime->power_button_stick = clock();
-
-                            if (LONG_PRESS_POWER_DOWN > clock() - runtime->power_button_stick)
-                            {
-                                thread_yield();
-                                mqueue_postv(runtime->mqd, MSG_POWER_BUTTON, 0, 0);
-                            }
-                            else
-                                MSG_power_button(runtime, true);
-                        }
-                        else
-                        {
-                            MSG_mynoise_toggle(true);
-                            mqueue_flush(runtime->mqd);
-                        }
-                    }
-                    else
-                        mqueue_flush(runtime->mqd);
-                    break;
-
-                case MSG_PREV_BUTTON:
-                    if (! CLOCK_dismiss())
-                    {
-                        if (0 == GPIO_peek(PIN_PREV_BUTTON))
-                        {
-                            if (0 == runtime->prev_next_button_stick)
-                                runtime->prev_next_button_stick = clock();
-
-                            if (LONG_PRESS_SETTING > clock() - runtime->prev_next_button_stick && 0 != GPIO_peek(PIN_NEXT_BUTTON))
-                            {
-                                thread_yield();
-                                mqueue_postv(runtime->mqd, msg->msgid, 0, 0);
-                            }
-                            else
-                            {
-                                MYNOISE_stop();
-
-                                if (0 == GPIO_peek(PIN_PREV_BUTTON | PIN_NEXT_BUTTON))
-                                {
-                                    mqueue_flush(runtime->mqd);
-                                    MSG_alarm_toggle(runtime);
-                                }
-                                else
-                                    MSG_setting(runtime, MSG_POWER_BUTTON);
-                            }
-                        }
-                        else if (MYNOISE_is_running())
-                        {
-                            GPIO_set(LED_POWER);
-
-                            unsigned power_off_seconds = MYNOISE_get_power_off_seconds();
-                            MYNOISE_power_off_set_tickdown_cb(NULL);
-
-                            int err = MYNOISE_prev();
-                            MYNOISE_power_off_set_tickdown_cb(MYNOISE_power_off_tickdown_callback);
-
-                            if (0 == err)
-                                MYNOISE_power_off_seconds(power_off_seconds);
-
-                            mqueue_flush(runtime->mqd);
-                        }
-                    }
-                    else
-                        mqueue_flush(runtime->mqd);
-                    break;
-
-                case MSG_NEXT_BUTTON:
-                    if (! CLOCK_dismiss())
-                    {
-                        if (0 == GPIO_peek(PIN_NEXT_BUTTON))
-                        {
-                            if (0 == runtime->prev_next_button_stick)
-                                runtime->prev_next_button_stick = clock();
-
-                            if (LONG_PRESS_SETTING > clock() - runtime->prev_next_button_stick && 0 != GPIO_peek(PIN_PREV_BUTTON))
-                            {
-                                thread_yield();
-                                mqueue_postv(runtime->mqd, msg->msgid, 0, 0);
-                            }
-                            else
-                            {
-                                MYNOISE_stop();
-
-                                if (0 == GPIO_peek(PIN_PREV_BUTTON | PIN_NEXT_BUTTON))
-                                {
-                                    mqueue_flush(runtime->mqd);
-                                    MSG_alarm_toggle(runtime);
-                                }
-                                else
-                                    MSG_setting(runtime, MSG_POWER_BUTTON);
-                            }
-                        }
-                        else if (MYNOISE_is_running())
-                        {
-                            GPIO_set(LED_POWER);
-
-                            unsigned power_off_seconds = MYNOISE_get_power_off_seconds();
-                            MYNOISE_power_off_set_tickdown_cb(NULL);
-
-                            int err = MYNOISE_next();
-                            MYNOISE_power_off_set_tickdown_cb(MYNOISE_power_off_tickdown_callback);
-
-                            if (0 == err)
-                                MYNOISE_power_off_seconds(power_off_seconds);
-
-                            mqueue_flush(runtime->mqd);
-                        }
-                    }
-                    else
-                        mqueue_flush(runtime->mqd);
-                    break;
-
-                case MSG_VOLUME_UP_BUTTON:
-                case MSG_VOLUME_DOWN_BUTTON:
-                    MSG_volume(runtime, (enum zone_message_t)msg->msgid);
-                    break;
-                }
-            }
-            else
-                MSG_setting(runtime, (enum zone_message_t)msg->msgid);
+            POWER_enter(POWER_CAUSE_BUTTON);
+            UI_FSM_dispatch(&runtime->ui, msg->msgid);
+            POWER_leave(POWER_CAUSE_BUTTON);
 
             mqueue_release_pool(runtime->mqd, msg);
         }
         else
         {
-            if (! runtime->power_is_down)
-                MSG_alive(runtime);
+            // no MSG_ALIVE row when powered down
+            POWER_enter(POWER_CAUSE_ALIVE);
+            UI_FSM_dispatch(&runtime->ui, MSG_ALIVE);
+            POWER_leave(POWER_CAUSE_ALIVE);
         }
     }
 }
@@ -0,0 +1,112 @@
+#ifndef __ZONE_UI_H
+#define __ZONE_UI_H                     1
+
+#include "button.h"
+#include "ui_fsm.h"
+
+/***************************************************************************
+ *  zone UI: states x events => actions
+ *
+ *      included by zone.c implementing the actions & guards,
+ *      and by test/host/test_ui_zone.c replaying scripts against stubs of them
+***************************************************************************/
+enum zone_message_t
+{
+    MSG_TOP_BUTTON              = 1,
+    MSG_POWER_BUTTON,
+    MSG_PREV_BUTTON,
+    MSG_NEXT_BUTTON,
+    MSG_VOLUME_UP_BUTTON,
+    MSG_VOLUME_DOWN_BUTTON,
+
+    MSG_ALIVE                   = 0x80,
+    MSG_SETTING_TIMEOUT,
+};
+
+enum zone_ui_state_t
+{
+    ZONE_UI_IDLE                = 0,
+    ZONE_UI_SETTING,
+    ZONE_UI_POWER_DOWN,
+};
+
+static bool MSG_top_is_free(void *ctx, uint8_t event, uint8_t id);
+static bool MSG_power_is_free(void *ctx, uint8_t event, uint8_t id);
+static bool MSG_prev_next_is_free(void *ctx, uint8_t event, uint8_t id);
+
+static void MSG_alive(void *ctx, uint8_t event, uint8_t id);
+static void MSG_alive_batt(void *ctx, uint8_t event, uint8_t id);
+static void MSG_top_press(void *ctx, uint8_t event, uint8_t id);
+static void MSG_top_voice(void *ctx, uint8_t event, uint8_t id);
+static void MSG_top_mynoise(void *ctx, uint8_t event, uint8_t id);
+static void MSG_power_press(void *ctx, uint8_t event, uint8_t id);
+static void MSG_power_down(void *ctx, uint8_t event, uint8_t id);
+static void MSG_power_wakeup(void *ctx, uint8_t event, uint8_t id);
+static void MSG_power_mynoise(void *ctx, uint8_t event, uint8_t id);
+static void MSG_prev_next_press(void *ctx, uint8_t event, uint8_t id);
+static void MSG_prev_next_release(void *ctx, uint8_t event, uint8_t id);
+static void MSG_volume(void *ctx, uint8_t event, uint8_t id);
+static void MSG_volume_done(void *ctx, uint8_t event, uint8_t id);
+
+static void MSG_setting_enter(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_done(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_step(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_adjust(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_dismiss(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_timeout(void *ctx, uint8_t event, uint8_t id);
+static void MSG_setting_save(void *ctx, uint8_t event, uint8_t id);
+
+static struct UI_transition_t const zone_ui[] =
+{
+    UI_ON(ZONE_UI_SETTING,          UI_EVENT_ANY,       MSG_SETTING_TIMEOUT,    MSG_setting_timeout,    ZONE_UI_IDLE),
+    UI_ON(UI_STATE_ANY,             UI_EVENT_ANY,       MSG_SETTING_TIMEOUT,    MSG_setting_save,       UI_STATE_SAME),
+    UI_ON(ZONE_UI_IDLE,             UI_EVENT_ANY,       MSG_ALIVE,              MSG_alive,              UI_STATE_SAME),
+    UI_ON(ZONE_UI_SETTING,          UI_EVENT_ANY,       MSG_ALIVE,              MSG_alive_batt,         UI_STATE_SAME),
+
+    // only power button is alive when powered down
+    UI_ON(ZONE_UI_POWER_DOWN,       BUTTON_PRESS,       MSG_POWER_BUTTON,       MSG_power_wakeup,       ZONE_UI_IDLE),
+
+    // TOP: press snoozes, long press says time, short release toggles noise
+    UI_ON(ZONE_UI_IDLE,             BUTTON_PRESS,       MSG_TOP_BUTTON,         MSG_top_press,          UI_STATE_SAME),
+    UI_ON_IF(ZONE_UI_IDLE,          BUTTON_LONG_PRESS,  MSG_TOP_BUTTON,         MSG_top_is_free,
+        MSG_top_voice,              UI_STATE_SAME),
+    UI_ON_IF(ZONE_UI_IDLE,          BUTTON_RELEASE,     MSG_TOP_BUTTON,         MSG_top_is_free,
+        MSG_top_mynoise,            UI_STATE_SAME),
+
+    // POWER: press dismisses, long press powers down, short release steps noise power off
+    UI_ON(ZONE_UI_IDLE,             BUTTON_PRESS,       MSG_POWER_BUTTON,       MSG_power_press,        UI_STATE_SAME),
+    UI_ON_IF(ZONE_UI_IDLE,          BUTTON_LONG_PRESS,  MSG_POWER_BUTTON,       MSG_power_is_free,
+        MSG_power_down,             ZONE_UI_POWER_DOWN),
+    UI_ON_IF(ZONE_UI_IDLE,          BUTTON_RELEASE,     MSG_POWER_BUTTON,       MSG_power_is_free,
+        MSG_power_mynoise,          UI_STATE_SAME),
+
+    // PREV / NEXT: both toggles alarm, long press enters setting, short release steps noise
+    UI_ON(ZONE_UI_IDLE,             BUTTON_PRESS,       MSG_PREV_BUTTON,        MSG_prev_next_press,    UI_STATE_SAME),
+    UI_ON(ZONE_UI_IDLE,             BUTTON_PRESS,       MSG_NEXT_BUTTON,        MSG_prev_next_press,    UI_STATE_SAME),
+    UI_ON_IF(ZONE_UI_IDLE,          BUTTON_LONG_PRESS,  MSG_PREV_BUTTON,        MSG_prev_next_is_free,
+        MSG_setting_enter,          ZONE_UI_SETTING),
+    UI_ON_IF(ZONE_UI_IDLE,          BUTTON_LONG_PRESS,  MSG_NEXT_BUTTON,        MSG_prev_next_is_free,
+        MSG_setting_enter,          ZONE_UI_SETTING),
+    UI_ON(ZONE_UI_IDLE,             BUTTON_RELEASE,     MSG_PREV_BUTTON,        MSG_prev_next_release,  UI_STATE_SAME),
+    UI_ON(ZONE_UI_IDLE,             BUTTON_RELEASE,     MSG_NEXT_BUTTON,        MSG_prev_next_release,  UI_STATE_SAME),
+    UI_ON(ZONE_UI_IDLE,             BUTTON_LONG_RELEASE, MSG_PREV_BUTTON,       MSG_prev_next_release,  UI_STATE_SAME),
+    UI_ON(ZONE_UI_IDLE,             BUTTON_LONG_RELEASE, MSG_NEXT_BUTTON,       MSG_prev_next_release,  UI_STATE_SAME),
+
+    // VOLUME: press & repeat adjust, release saves
+    UI_ON(ZONE_UI_IDLE,             BUTTON_RELEASE,     MSG_VOLUME_UP_BUTTON,   MSG_volume_done,        UI_STATE_SAME),
+    UI_ON(ZONE_UI_IDLE,             BUTTON_LONG_RELEASE, MSG_VOLUME_UP_BUTTON,  MSG_volume_done,        UI_STATE_SAME),
+    UI_ON(ZONE_UI_IDLE,             UI_EVENT_ANY,       MSG_VOLUME_UP_BUTTON,   MSG_volume,             UI_STATE_SAME),
+    UI_ON(ZONE_UI_IDLE,             BUTTON_RELEASE,     MSG_VOLUME_DOWN_BUTTON, MSG_volume_done,        UI_STATE_SAME),
+    UI_ON(ZONE_UI_IDLE,             BUTTON_LONG_RELEASE, MSG_VOLUME_DOWN_BUTTON, MSG_volume_done,       UI_STATE_SAME),
+    UI_ON(ZONE_UI_IDLE,             UI_EVENT_ANY,       MSG_VOLUME_DOWN_BUTTON, MSG_volume,             UI_STATE_SAME),
+
+    // setting: POWER leaves, PREV / NEXT select setting part, VOLUME adjusts it
+    UI_ON(ZONE_UI_SETTING,          BUTTON_PRESS,       MSG_POWER_BUTTON,       MSG_setting_done,       ZONE_UI_IDLE),
+    UI_ON(ZONE_UI_SETTING,          BUTTON_PRESS,       MSG_PREV_BUTTON,        MSG_setting_step,       UI_STATE_SAME),
+    UI_ON(ZONE_UI_SETTING,          BUTTON_PRESS,       MSG_NEXT_BUTTON,        MSG_setting_step,       UI_STATE_SAME),
+    UI_ON(ZONE_UI_SETTING,          BUTTON_PRESS,       MSG_VOLUME_UP_BUTTON,   MSG_setting_adjust,     UI_STATE_SAME),
+    UI_ON(ZONE_UI_SETTING,          BUTTON_PRESS,       MSG_VOLUME_DOWN_BUTTON, MSG_setting_adjust,     UI_STATE_SAME),
+    UI_ON(ZONE_UI_SETTING,          BUTTON_PRESS,       UI_ID_ANY,              MSG_setting_dismiss,    UI_STATE_SAME),
+};
+
+#endif